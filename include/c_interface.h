@@ -37,6 +37,9 @@ extern "C"
     #define OUTPUT_HEX 1
     #define OUTPUT_ASSEMBLER 2
 
+    #define REGISTER_ALLOCATOR_GRAPH_COLORING 0
+    #define REGISTER_ALLOCATOR_LINEAR_SCAN 1
+
     extern const configuration DEFAULT_CONFIG;
     
     typedef struct _data_storage
@@ -53,6 +56,17 @@ extern "C"
 
     typedef void(*CompilationErrorHandler)(const char* message, const size_t length, void* userData);
     void setErrorHandler(CompilationErrorHandler errorHandler, void* userData);
+
+    /*
+     * The following settings are not part of the configuration to keep its layout (and the ABI of #convert) stable.
+     * They apply to all further compilations.
+     */
+    /* whether to use the persistent compilation cache (non-zero) or not (zero, default) */
+    void setCompilationCache(unsigned useCache);
+    /* the register-allocator to use, one of the REGISTER_ALLOCATOR_* values. Returns zero on success, -30 (CL_INVALID_VALUE) for any other value */
+    int setRegisterAllocator(unsigned allocator);
+    /* if not NULL, the file to write the JSON report of the compilation steps into, NULL disables the report (default) */
+    void setInstrumentationReport(const char* fileName);
     
     #define SOURCE_TYPE_UNKNOWN 0
     #define SOURCE_TYPE_OPENCL_C 1
@@ -64,6 +78,15 @@ extern "C"
 
     int determineSourceType(const storage* in);
 
+    /*
+     * Starts the long-living helper process to run the pre-compiler programs in, instead of forking the calling process for every compilation.
+     * Once started, the helper is used for all further compilations.
+     *
+     * Since the helper is forked from the calling process, this needs to be called while the process is still single-threaded (e.g. on initialization).
+     * Returns zero on success
+     */
+    int startFrontendHelper(void);
+
 #ifdef __cplusplus
 }
 #endif
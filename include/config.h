@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include <cstddef>
+#include <string>
 
 namespace vc4c
 {
@@ -59,6 +60,22 @@ namespace vc4c
 		SPIR_V = 2
 	};
 
+	/*
+	 * Specifies the algorithm used to map the locals to registers
+	 */
+	enum class RegisterAllocator
+	{
+		/*
+		 * Colors the interference graph of all locals, generates the best code
+		 */
+		GRAPH_COLORING = 0,
+		/*
+		 * Assigns the registers in a single pass over the live-ranges of all locals.
+		 * This is much faster for big kernels at the cost of more register-conflicts, which fall back to graph coloring
+		 */
+		LINEAR_SCAN = 1
+	};
+
 	/*
 	 * The maximum VPM size to be used (in bytes).
 	 *
@@ -99,6 +116,36 @@ namespace vc4c
 	     * Whether to turn on auto-vectorization of loops
 	     */
 	    bool autoVectorization = false;
+	    /*
+	     * The maximum number of threads to use for optimizing and generating code for the single kernels in parallel.
+	     *
+	     * A value of zero uses as many threads as there are hardware threads available.
+	     * NOTE: This setting has no effect, if the compiler is built without multi-threading support
+	     */
+	    unsigned numThreads = 0;
+	    /*
+	     * Whether to look up and store the compilation results in the persistent on-disk compilation cache.
+	     *
+	     * If enabled, compiling the same input with the same options and configuration again directly returns the previous result.
+	     */
+	    bool useCompilationCache = false;
+	    /*
+	     * The algorithm to use for register-allocation
+	     */
+	    RegisterAllocator registerAllocator = RegisterAllocator::GRAPH_COLORING;
+	    /*
+	     * Whether the front-end maps the bodies of the functions to intermediate instructions in parallel (limited by numThreads).
+	     *
+	     * The functions are still read sequentially and added to the module in the same order, so the result does not depend on this setting
+	     */
+	    bool parallelFrontend = false;
+	    /*
+	     * If set, the duration, the number of instructions and locals and the peak memory usage of every compilation step are recorded
+	     * and written as JSON report into the file with this name after the compilation.
+	     *
+	     * NOTE: No report is written for results taken from the compilation cache
+	     */
+	    std::string instrumentationReport;
 	};
 
 	/*
@@ -126,6 +173,22 @@ namespace vc4c
 	 */
 	constexpr std::size_t REGISTER_RESOLVER_MAX_ROUNDS{6};
 
+	/*
+	 * Maximum number of times locals are spilled when the register-checker fails to resolve all conflicts
+	 */
+	constexpr std::size_t REGISTER_SPILL_MAX_ROUNDS{3};
+
+	/*
+	 * Maximum number of rounds the single-step optimizations are re-run on the instructions changed in the previous round
+	 */
+	constexpr std::size_t SINGLE_STEPS_MAX_ROUNDS{16};
+
+	/*
+	 * Maximum total size (in bytes) of all entries in the persistent compilation cache.
+	 * If the cache grows larger, the least recently used entries are removed
+	 */
+	constexpr std::size_t COMPILATION_CACHE_MAX_SIZE{64 * 1024 * 1024};
+
 	/*
 	 * Magic number to identify QPU assembler code (machine code)
 	 */
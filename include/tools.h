@@ -14,6 +14,7 @@
 #include <array>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <vector>
 
 namespace vc4c
@@ -68,6 +69,14 @@ namespace vc4c
 			 * The path to dump the results of the instrumentation
 			 */
 			std::string instrumentationDump;
+			/*
+			 * Whether to emulate every QPU on its own host thread.
+			 *
+			 * The QPUs run independently of each other and only synchronize on accesses to resources shared between the QPUs
+			 * (mutex, semaphores, VPM and memory). These accesses are executed in the same order as for the single-threaded emulation,
+			 * so the results are identical for both modes.
+			 */
+			bool parallelQPUs = false;
 
 			explicit EmulationData() { };
 
@@ -148,6 +157,62 @@ namespace vc4c
 		 */
 		EmulationResult emulate(const EmulationData& data);
 
+		/*
+		 * Data container for emulating a batch of kernel-executions of the same module
+		 */
+		struct BatchEmulationData
+		{
+			/*
+			 * The module to use, either the path to the compiled module-file (in binary format!) or the module-data itself.
+			 *
+			 * The module is only loaded once for all runs, the module-fields of the single runs are ignored
+			 */
+			std::pair<std::string, std::istream*> module;
+			/*
+			 * The kernel-executions to emulate, e.g. the same kernel with different parameters.
+			 *
+			 * The single runs are independent of each other, every run is emulated on its own copy of the memory
+			 */
+			std::vector<EmulationData> runs;
+			/*
+			 * Whether to emulate the work-groups of every run independently of each other, which allows to emulate them in parallel.
+			 *
+			 * The work-groups then do not see the memory modified by the other work-groups of the same run (which is also not guaranteed by OpenCL).
+			 * Afterwards, the memory modified by all work-groups is merged in the order of the work-group IDs.
+			 */
+			bool splitWorkGroups = false;
+			/*
+			 * The maximum number of host threads used to emulate the runs (and work-groups), zero uses all available hardware threads
+			 */
+			unsigned maxThreads = 0;
+		};
+
+		/*
+		 * The results of the emulation of a batch of kernel-executions
+		 */
+		struct BatchEmulationResult
+		{
+			/*
+			 * The results of the single runs, in the same order as the runs were given
+			 */
+			std::vector<EmulationResult> results;
+			/*
+			 * The instrumentation results summed up over all runs of the same kernel, mapped by the kernel name
+			 */
+			std::map<std::string, std::vector<InstrumentationResult>> instrumentation;
+		};
+
+		/*
+		 * Runs all emulations of the batch and returns their results.
+		 *
+		 * In contrast to running the single emulations one after the other, the module is only loaded and decoded once
+		 * and the runs are emulated in parallel on multiple host threads. The memory of the work-groups of a run is copied on write,
+		 * so only the runs (and work-groups) actually modifying memory need to copy its contents.
+		 *
+		 * NOTE: This function may throw a CompilationError if anything in any emulation goes horrible wrong
+		 */
+		BatchEmulationResult emulate(const BatchEmulationData& data);
+
 	} /* namespace tools */
 } /* namespace vc4c */
 
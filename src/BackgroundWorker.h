@@ -9,11 +9,13 @@
 
 #include "log.h"
 
+#include <algorithm>
 #include <exception>
 #include <functional>
 #include <vector>
 
 #ifdef MULTI_THREADED
+#include <atomic>
 #include <dlfcn.h>
 #include <mutex>
 #include <sys/prctl.h>
@@ -103,6 +105,39 @@ namespace threading
 			if(err)
 				std::rethrow_exception(err);
 		}
+
+		/*
+		 * Runs all given tasks on a bounded number of background-workers and waits for all of them to finish.
+		 *
+		 * Every worker takes the next not yet started task until all tasks are processed, so at most maxThreads tasks are executed at the same time.
+		 * A maxThreads of zero uses as many workers as there are hardware threads available.
+		 *
+		 * NOTE: The tasks are run in an unspecified order, so they need to be independent of each other
+		 */
+		static void scheduleAll(const std::vector<std::function<void()>>& tasks, const std::string& name, std::size_t maxThreads = 0)
+		{
+#ifdef MULTI_THREADED
+			if(maxThreads == 0)
+				maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+			const std::size_t numWorkers = std::min(maxThreads, tasks.size());
+			std::atomic<std::size_t> nextTask{0};
+			std::vector<BackgroundWorker> workers;
+			workers.reserve(numWorkers);
+			for(std::size_t i = 0; i < numWorkers; ++i)
+			{
+				auto f = [&tasks, &nextTask]() -> void
+				{
+					for(std::size_t index = nextTask++; index < tasks.size(); index = nextTask++)
+						tasks[index]();
+				};
+				workers.emplace(workers.end(), f, name)->operator ()();
+			}
+			waitForAll(workers);
+#else
+			for(const auto& task : tasks)
+				task();
+#endif
+		}
 	};
 
 } /* namespace threading */
@@ -0,0 +1,432 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#include "CompilationCache.h"
+
+#include "Profiler.h"
+#include "log.h"
+#include "performance.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
+
+using namespace vc4c;
+
+#ifndef VC4C_VERSION
+#define VC4C_VERSION ""
+#endif
+
+static const std::string CACHE_ENTRY_SUFFIX = ".bin";
+//the file tracking the total size of all entries, so the directory only needs to be scanned when entries need to be evicted
+static const std::string CACHE_SIZE_FILE = "size";
+
+static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+static void updateHashes(uint64_t& fnv1, uint64_t& fnv1a, const std::string& data)
+{
+	//FNV-1 and FNV-1a are combined to a 128-bit key to make collisions practically impossible
+	for(const char c : data)
+	{
+		fnv1 = (fnv1 * FNV_PRIME) ^ static_cast<uint8_t>(c);
+		fnv1a = (fnv1a ^ static_cast<uint8_t>(c)) * FNV_PRIME;
+	}
+	//separate the single parts of the key, so e.g. moving characters from the options to the input changes the key
+	const std::string length = std::string(" ") + std::to_string(data.size()) + ";";
+	for(const char c : length)
+	{
+		fnv1 = (fnv1 * FNV_PRIME) ^ static_cast<uint8_t>(c);
+		fnv1a = (fnv1a ^ static_cast<uint8_t>(c)) * FNV_PRIME;
+	}
+}
+
+static std::string toHexString(const uint64_t fnv1, const uint64_t fnv1a)
+{
+	std::stringstream s;
+	s << std::hex << std::setfill('0') << std::setw(16) << fnv1 << std::setw(16) << fnv1a;
+	return s.str();
+}
+
+static std::string readFile(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios_base::in | std::ios_base::binary);
+	if(!file)
+		return "";
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/*
+ * Returns a hash over the contents of the library (or executable) containing the compiler, which changes with every rebuild of any part of the compiler.
+ *
+ * Since the library does not change while it is loaded, this is only calculated once per process
+ */
+static const std::string& getCompilerBuildID()
+{
+	static const std::string buildID = []() -> std::string
+	{
+		Dl_info info;
+		if(dladdr(reinterpret_cast<const void*>(&cache::calculateKey), &info) == 0 || info.dli_fname == nullptr)
+		{
+			logging::warn() << "Failed to determine the compiler library for the compilation cache key" << logging::endl;
+			return "";
+		}
+		uint64_t fnv1 = FNV_OFFSET_BASIS;
+		uint64_t fnv1a = FNV_OFFSET_BASIS;
+		updateHashes(fnv1, fnv1a, readFile(info.dli_fname));
+		return toHexString(fnv1, fnv1a);
+	}();
+	return buildID;
+}
+
+#ifdef VC4CL_STDLIB_HEADER
+/*
+ * Returns a hash over the contents of the pre-compiled header.
+ *
+ * Since the header is large and rarely changes, the hash is only re-calculated if its modification time or size changed
+ */
+static std::string getPrecompiledHeaderID(const std::string& fileName)
+{
+	static std::string cachedID;
+	static time_t cachedModificationTime = 0;
+	static off_t cachedSize = -1;
+#ifdef MULTI_THREADED
+	static std::mutex lock;
+	std::lock_guard<std::mutex> guard(lock);
+#endif
+	struct stat fileStat;
+	if(stat(fileName.data(), &fileStat) != 0)
+		return "";
+	if(fileStat.st_mtime != cachedModificationTime || fileStat.st_size != cachedSize)
+	{
+		uint64_t fnv1 = FNV_OFFSET_BASIS;
+		uint64_t fnv1a = FNV_OFFSET_BASIS;
+		updateHashes(fnv1, fnv1a, readFile(fileName));
+		cachedID = toHexString(fnv1, fnv1a);
+		cachedModificationTime = fileStat.st_mtime;
+		cachedSize = fileStat.st_size;
+	}
+	return cachedID;
+}
+#endif
+
+/*
+ * Resolves the file included via the given include directive like the pre-compiler does:
+ * relative to the including file (only for "..." includes), then in the directories given via the -I options
+ */
+static Optional<std::string> resolveInclude(const std::string& name, const bool isQuoted, const std::string& currentDirectory, const std::vector<std::string>& includeDirectories)
+{
+	struct stat fileStat;
+	if(!name.empty() && name.front() == '/')
+		return stat(name.data(), &fileStat) == 0 ? Optional<std::string>(name) : Optional<std::string>{};
+	if(isQuoted && stat((currentDirectory + "/" + name).data(), &fileStat) == 0)
+		return currentDirectory + "/" + name;
+	for(const std::string& dir : includeDirectories)
+	{
+		if(stat((dir + "/" + name).data(), &fileStat) == 0)
+			return dir + "/" + name;
+	}
+	return {};
+}
+
+/*
+ * Adds the contents of all files included (directly or indirectly) by the given source code to the hashes.
+ *
+ * Since the source is not pre-processed, this also considers files included in disabled conditional blocks, which can only cause unnecessary cache misses.
+ * Includes which can't be resolved (e.g. the headers built into clang) are only identified by their name, which is part of the source code anyway.
+ */
+static void hashIncludedFiles(uint64_t& fnv1, uint64_t& fnv1a, const std::string& source, const std::string& currentDirectory, const std::vector<std::string>& includeDirectories,
+		FastSet<std::string>& visitedFiles)
+{
+	std::istringstream lines(source);
+	std::string line;
+	while(std::getline(lines, line))
+	{
+		std::size_t pos = line.find_first_not_of(" \t");
+		if(pos == std::string::npos || line[pos] != '#')
+			continue;
+		pos = line.find_first_not_of(" \t", pos + 1);
+		if(pos == std::string::npos || line.compare(pos, 7, "include") != 0)
+			continue;
+		pos = line.find_first_not_of(" \t", pos + 7);
+		if(pos == std::string::npos || (line[pos] != '"' && line[pos] != '<'))
+			continue;
+		const bool isQuoted = line[pos] == '"';
+		const std::size_t end = line.find(isQuoted ? '"' : '>', pos + 1);
+		if(end == std::string::npos)
+			continue;
+		const Optional<std::string> file = resolveInclude(line.substr(pos + 1, end - pos - 1), isQuoted, currentDirectory, includeDirectories);
+		if(!file || !visitedFiles.emplace(file.value()).second)
+			continue;
+		const std::string contents = readFile(file.value());
+		updateHashes(fnv1, fnv1a, file.value());
+		updateHashes(fnv1, fnv1a, contents);
+		const std::size_t separator = file->find_last_of('/');
+		hashIncludedFiles(fnv1, fnv1a, contents, separator == std::string::npos ? "." : file->substr(0, separator), includeDirectories, visitedFiles);
+	}
+}
+
+/*
+ * Returns the include directories and the files included via the command line given in the pre-compiler options
+ */
+static std::pair<std::vector<std::string>, std::vector<std::string>> getIncludeOptions(const std::string& options)
+{
+	std::vector<std::string> parts;
+	std::istringstream s(options);
+	std::string part;
+	while(s >> part)
+		parts.push_back(part);
+	std::vector<std::string> directories;
+	std::vector<std::string> files;
+	for(std::size_t i = 0; i < parts.size(); ++i)
+	{
+		if(parts[i] == "-I" && i + 1 < parts.size())
+			directories.push_back(parts[++i]);
+		else if(parts[i].compare(0, 2, "-I") == 0 && parts[i].size() > 2)
+			directories.push_back(parts[i].substr(2));
+		else if(parts[i] == "-include" && i + 1 < parts.size())
+			files.push_back(parts[++i]);
+	}
+	return std::make_pair(directories, files);
+}
+
+static std::string getCacheDirectory()
+{
+	if(const char* dir = std::getenv("VC4C_CACHE_DIR"))
+		return dir;
+	if(const char* dir = std::getenv("XDG_CACHE_HOME"))
+		return std::string(dir) + "/vc4c";
+	if(const char* dir = std::getenv("HOME"))
+		return std::string(dir) + "/.cache/vc4c";
+	return "";
+}
+
+static bool createDirectories(const std::string& path)
+{
+	std::size_t pos = 0;
+	do
+	{
+		pos = path.find('/', pos + 1);
+		const std::string part = path.substr(0, pos);
+		if(mkdir(part.data(), S_IRWXU) != 0 && errno != EEXIST)
+			return false;
+	} while(pos != std::string::npos);
+	return true;
+}
+
+std::string cache::calculateKey(const std::string& input, const Configuration& config, const std::string& options, const Optional<std::string>& inputFile)
+{
+	PROFILE_START(calculateCacheKey);
+	uint64_t fnv1 = FNV_OFFSET_BASIS;
+	uint64_t fnv1a = FNV_OFFSET_BASIS;
+
+	//the compiler version and build, any change in any part of the compiler could change the output
+	updateHashes(fnv1, fnv1a, VC4C_VERSION);
+	updateHashes(fnv1, fnv1a, getCompilerBuildID());
+#ifdef VC4CL_STDLIB_HEADER
+	//the pre-compiled standard-library is included into every compilation
+	updateHashes(fnv1, fnv1a, getPrecompiledHeaderID(VC4CL_STDLIB_HEADER));
+#endif
+	//the contents of all headers included into the compilation
+	const auto includeOptions = getIncludeOptions(options);
+	std::string includes;
+	for(const std::string& file : includeOptions.second)
+		includes.append("#include \"").append(file).append("\"\n");
+	const std::size_t separator = inputFile ? inputFile->find_last_of('/') : std::string::npos;
+	const std::string inputDirectory = separator == std::string::npos ? "." : inputFile->substr(0, separator);
+	FastSet<std::string> visitedFiles;
+	hashIncludedFiles(fnv1, fnv1a, includes, ".", includeOptions.first, visitedFiles);
+	hashIncludedFiles(fnv1, fnv1a, input, inputDirectory, includeOptions.first, visitedFiles);
+	//only the configuration fields which influence the generated code, e.g. not the number of threads
+	std::stringstream configString;
+	configString << static_cast<unsigned>(config.mathType) << ',' << static_cast<unsigned>(config.outputMode) << ',' << config.writeKernelInfo << ','
+			<< config.availableVPMSize << ',' << static_cast<unsigned>(config.frontend) << ',' << config.autoVectorization << ','
+			<< static_cast<unsigned>(config.registerAllocator);
+	updateHashes(fnv1, fnv1a, configString.str());
+	updateHashes(fnv1, fnv1a, options);
+	updateHashes(fnv1, fnv1a, input);
+
+	PROFILE_END(calculateCacheKey);
+	return toHexString(fnv1, fnv1a);
+}
+
+Optional<std::size_t> cache::lookup(const std::string& key, std::ostream& output)
+{
+	const std::string directory = getCacheDirectory();
+	if(directory.empty())
+		return {};
+	const std::string fileName = directory + "/" + key + CACHE_ENTRY_SUFFIX;
+	std::ifstream entry(fileName, std::ios_base::in | std::ios_base::binary);
+	if(!entry)
+		return {};
+	std::size_t bytesWritten = 0;
+	entry >> bytesWritten;
+	if(!entry || entry.get() != '\n')
+	{
+		logging::warn() << "Invalid compilation cache entry: " << fileName << logging::endl;
+		return {};
+	}
+	//streaming an empty buffer would set the fail-bit of the output stream
+	if(entry.peek() != std::char_traits<char>::eof())
+		output << entry.rdbuf();
+	//mark as recently used for the eviction
+	if(utimes(fileName.data(), nullptr) != 0)
+		logging::debug() << "Failed to update access time of compilation cache entry: " << strerror(errno) << logging::endl;
+	logging::info() << "Using cached compilation result: " << fileName << logging::endl;
+	return bytesWritten;
+}
+
+/*
+ * Removes the least recently used entries, until the total size is below the limit.
+ *
+ * Returns the total size of the remaining entries
+ */
+static std::size_t evictEntries(const std::string& directory)
+{
+	struct CacheEntry
+	{
+		std::string fileName;
+		off_t size;
+		time_t lastUse;
+	};
+
+	DIR* dir = opendir(directory.data());
+	if(dir == nullptr)
+		return 0;
+	std::vector<CacheEntry> entries;
+	std::size_t totalSize = 0;
+	while(const dirent* file = readdir(dir))
+	{
+		const std::string name(file->d_name);
+		if(name.size() <= CACHE_ENTRY_SUFFIX.size() || name.compare(name.size() - CACHE_ENTRY_SUFFIX.size(), CACHE_ENTRY_SUFFIX.size(), CACHE_ENTRY_SUFFIX) != 0)
+			continue;
+		struct stat fileStat;
+		const std::string fileName = directory + "/" + name;
+		//the entry could have been removed by another process in the meantime
+		if(stat(fileName.data(), &fileStat) != 0)
+			continue;
+		entries.push_back(CacheEntry{fileName, fileStat.st_size, fileStat.st_mtime});
+		totalSize += static_cast<std::size_t>(fileStat.st_size);
+	}
+	closedir(dir);
+
+	if(totalSize <= COMPILATION_CACHE_MAX_SIZE)
+		return totalSize;
+	std::sort(entries.begin(), entries.end(), [](const CacheEntry& e1, const CacheEntry& e2) -> bool { return e1.lastUse < e2.lastUse;});
+	for(const CacheEntry& entry : entries)
+	{
+		if(totalSize <= COMPILATION_CACHE_MAX_SIZE)
+			break;
+		//if another process removed this entry first, the space is freed all the same
+		if(remove(entry.fileName.data()) == 0 || errno == ENOENT)
+			totalSize -= static_cast<std::size_t>(entry.size);
+		logging::debug() << "Evicted compilation cache entry: " << entry.fileName << logging::endl;
+	}
+	return totalSize;
+}
+
+/*
+ * Applies the change in size of an entry to the tracked total size of the cache and evicts entries, if the total exceeds the limit.
+ *
+ * The size-file is locked while being updated, so concurrent processes do not lose updates
+ */
+static void updateTotalSize(const std::string& directory, std::size_t addedSize, std::size_t removedSize)
+{
+	const std::string fileName = directory + "/" + CACHE_SIZE_FILE;
+	const int fd = open(fileName.data(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if(fd < 0)
+	{
+		logging::warn() << "Failed to open compilation cache size file '" << fileName << "': " << strerror(errno) << logging::endl;
+		return;
+	}
+	if(flock(fd, LOCK_EX) != 0)
+	{
+		logging::warn() << "Failed to lock compilation cache size file '" << fileName << "': " << strerror(errno) << logging::endl;
+		close(fd);
+		return;
+	}
+	char buffer[32] = {0};
+	const ssize_t length = pread(fd, buffer, sizeof(buffer) - 1, 0);
+	std::size_t totalSize = 0;
+	if(length <= 0)
+		//the size is not tracked yet, so determine it from the existing entries once
+		totalSize = evictEntries(directory);
+	else
+	{
+		totalSize = static_cast<std::size_t>(std::strtoull(buffer, nullptr, 10)) + addedSize;
+		totalSize = totalSize < removedSize ? 0 : totalSize - removedSize;
+		if(totalSize > COMPILATION_CACHE_MAX_SIZE)
+			totalSize = evictEntries(directory);
+	}
+	const std::string content = std::to_string(totalSize);
+	if(ftruncate(fd, 0) != 0 || pwrite(fd, content.data(), content.size(), 0) != static_cast<ssize_t>(content.size()))
+		logging::warn() << "Failed to update compilation cache size file '" << fileName << "': " << strerror(errno) << logging::endl;
+	flock(fd, LOCK_UN);
+	close(fd);
+}
+
+void cache::store(const std::string& key, const std::string& output, const std::size_t bytesWritten)
+{
+	const std::string directory = getCacheDirectory();
+	if(directory.empty() || output.size() > COMPILATION_CACHE_MAX_SIZE)
+		return;
+	if(!createDirectories(directory))
+	{
+		logging::warn() << "Failed to create compilation cache directory '" << directory << "': " << strerror(errno) << logging::endl;
+		return;
+	}
+	//write into an unique temporary file and then rename it, which is atomic, so no other process can read a partially written entry
+	std::string tmpName = directory + "/" + key + ".XXXXXX";
+	const int fd = mkstemp(const_cast<char*>(tmpName.data()));
+	if(fd < 0)
+	{
+		logging::warn() << "Failed to create compilation cache entry: " << strerror(errno) << logging::endl;
+		return;
+	}
+	close(fd);
+	{
+		std::ofstream entry(tmpName, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+		entry << bytesWritten << '\n';
+		entry.write(output.data(), static_cast<std::streamsize>(output.size()));
+		if(!entry)
+		{
+			logging::warn() << "Failed to write compilation cache entry: " << tmpName << logging::endl;
+			remove(tmpName.data());
+			return;
+		}
+	}
+	const std::string fileName = directory + "/" + key + CACHE_ENTRY_SUFFIX;
+	//an existing entry for the same key is replaced, so its size is not part of the total anymore
+	struct stat oldStat;
+	const std::size_t oldSize = stat(fileName.data(), &oldStat) == 0 ? static_cast<std::size_t>(oldStat.st_size) : 0;
+	struct stat newStat;
+	const std::size_t newSize = stat(tmpName.data(), &newStat) == 0 ? static_cast<std::size_t>(newStat.st_size) : 0;
+	if(rename(tmpName.data(), fileName.data()) != 0)
+	{
+		logging::warn() << "Failed to store compilation cache entry '" << fileName << "': " << strerror(errno) << logging::endl;
+		remove(tmpName.data());
+		return;
+	}
+	logging::debug() << "Stored compilation result in cache: " << fileName << logging::endl;
+	updateTotalSize(directory, newSize, oldSize);
+}
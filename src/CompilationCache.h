@@ -0,0 +1,56 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#ifndef COMPILATION_CACHE_H
+#define COMPILATION_CACHE_H
+
+#include "Optional.h"
+#include "config.h"
+
+#include <iostream>
+#include <string>
+
+namespace vc4c
+{
+	/*
+	 * Persistent on-disk cache for compilation results, shared by all processes of the same user.
+	 *
+	 * The cache entries are addressed by a hash over the input code, the contents of all headers it includes, the compilation options,
+	 * the output-relevant configuration fields and the contents of the compiler library, so a hit can directly return the final output
+	 * without running the pre-compiler or any compilation step.
+	 *
+	 * The cache directory is taken from the environment-variable VC4C_CACHE_DIR, falling back to "$XDG_CACHE_HOME/vc4c" and "$HOME/.cache/vc4c".
+	 *
+	 * Entries are written into a temporary file and atomically renamed into place, so concurrent readers never see a partially written entry.
+	 * The total size of all entries is tracked in a file in the cache directory. Only if it exceeds COMPILATION_CACHE_MAX_SIZE,
+	 * the directory is scanned and the least recently used entries are removed.
+	 */
+	namespace cache
+	{
+		/*
+		 * Calculates the key for the given input and compilation settings.
+		 *
+		 * The input file is used to resolve the headers included relative to the input
+		 */
+		std::string calculateKey(const std::string& input, const Configuration& config, const std::string& options, const Optional<std::string>& inputFile);
+
+		/*
+		 * Looks up the entry for the given key and writes the cached output into the given stream.
+		 *
+		 * Returns the number of bytes written by the original compilation on a cache hit, an empty value otherwise
+		 */
+		Optional<std::size_t> lookup(const std::string& key, std::ostream& output);
+
+		/*
+		 * Stores the output (and the number of bytes written as returned by the compilation) for the given key.
+		 *
+		 * Errors are only logged, since a failure to write into the cache does not affect the compilation itself
+		 */
+		void store(const std::string& key, const std::string& output, std::size_t bytesWritten);
+	} // namespace cache
+} // namespace vc4c
+
+#endif /* COMPILATION_CACHE_H */
@@ -7,6 +7,8 @@
 #include "Compiler.h"
 
 #include "BackgroundWorker.h"
+#include "CompilationCache.h"
+#include "Instrumentation.h"
 #include "Parser.h"
 #include "Precompiler.h"
 #include "Profiler.h"
@@ -22,6 +24,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <fcntl.h>
+#include <fstream>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -90,6 +93,7 @@ static std::unique_ptr<Parser> getParser(std::istream& stream)
 // register/instruction mapping
 static void toMachineCode(qpu_asm::CodeGenerator& codeGen, Method& kernel)
 {
+	MemoryArena::Scope arenaScope(kernel.arena);
 	kernel.cleanLocals();
 	const auto& instructions = codeGen.generateInstructions(kernel);
 #ifdef VERIFIER_HEADER
@@ -127,29 +131,43 @@ static void toMachineCode(qpu_asm::CodeGenerator& codeGen, Method& kernel)
 std::size_t Compiler::convert()
 {
 	Module module(config);
+	std::unique_ptr<profiler::Instrumentation> instrumentation;
+	if(!config.instrumentationReport.empty())
+	{
+		instrumentation.reset(new profiler::Instrumentation());
+		module.instrumentation = instrumentation.get();
+	}
 
     std::unique_ptr<Parser> parser = getParser(input);
     PROFILE_START(Parser);
-    parser->parse(module);
+    {
+    	profiler::Instrumentation::Step step(module.instrumentation, "Parser", module);
+    	parser->parse(module);
+    }
     PROFILE_END(Parser);
 
     optimizations::Optimizer opt(config);
     qpu_asm::CodeGenerator codeGen(module, config);
     PROFILE_START(Optimizer);
-    opt.optimize(module);
+    {
+    	profiler::Instrumentation::Step step(module.instrumentation, "Optimizer", module);
+    	opt.optimize(module);
+    }
     PROFILE_END(Optimizer);
 
-    std::vector<threading::BackgroundWorker> workers;
-    workers.reserve(module.getKernels().size());
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(module.getKernels().size());
     for(Method* kernelFunc : module.getKernels())
     {
-        auto f = [&codeGen, kernelFunc]() -> void
+        tasks.emplace_back([&codeGen, kernelFunc]() -> void
 		{
         	toMachineCode(codeGen, *kernelFunc);
-		};
-		workers.emplace(workers.end(), f, "Code Generator")->operator ()();
+		});
+    }
+    {
+    	profiler::Instrumentation::Step step(module.instrumentation, "CodeGenerator", module);
+    	threading::BackgroundWorker::scheduleAll(tasks, "Code Generator", config.numThreads);
     }
-    threading::BackgroundWorker::waitForAll(workers);
     
     //TODO could discard unused globals
     //since they are exported, they are still in the intermediate code, even if not used (e.g. optimized away)
@@ -157,6 +175,14 @@ std::size_t Compiler::convert()
     //code generation
     std::size_t bytesWritten = codeGen.writeOutput(output);
     output.flush();
+
+    if(instrumentation)
+    {
+    	std::ofstream report(config.instrumentationReport, std::ios_base::out | std::ios_base::trunc);
+    	instrumentation->writeJSON(report);
+    	if(!report)
+    		logging::warn() << "Failed to write instrumentation report: " << config.instrumentationReport << logging::endl;
+    }
     
     return bytesWritten;
 }
@@ -171,8 +197,26 @@ const Configuration& Compiler::getConfiguration() const
     return config;
 }
 
-std::size_t Compiler::compile(std::istream& input, std::ostream& output, const Configuration config, const std::string& options, const Optional<std::string>& inputFile)
+std::size_t Compiler::compile(std::istream& input, std::ostream& output, Configuration config, const std::string& options, const Optional<std::string>& inputFile)
 {
+	if(config.useCompilationCache)
+	{
+		const std::string inputData((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+		const std::string key = cache::calculateKey(inputData, config, options, inputFile);
+		if(auto bytesWritten = cache::lookup(key, output))
+		{
+			output.flush();
+			return bytesWritten.value();
+		}
+		std::istringstream cacheInput(inputData);
+		std::ostringstream cacheOutput;
+		config.useCompilationCache = false;
+		const std::size_t result = compile(cacheInput, cacheOutput, config, options, inputFile);
+		cache::store(key, cacheOutput.str(), result);
+		output << cacheOutput.str();
+		output.flush();
+		return result;
+	}
 	try
 	{
 		//pre-compilation
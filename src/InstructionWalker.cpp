@@ -234,6 +234,7 @@ const intermediate::IntermediateInstruction* InstructionWalker::get() const
 intermediate::IntermediateInstruction* InstructionWalker::release()
 {
 	throwOnEnd(isEndOfMethod());
+	basicBlock->method.invalidateBlockGraph((*pos).get());
 	return (*pos).release();
 }
 
@@ -242,6 +243,8 @@ InstructionWalker& InstructionWalker::reset(intermediate::IntermediateInstructio
 	throwOnEnd(isEndOfMethod());
 	if(dynamic_cast<intermediate::BranchLabel*>(instr) != dynamic_cast<intermediate::BranchLabel*>((*pos).get()))
 			throw CompilationError(CompilationStep::GENERAL, "Can't add labels into a basic block", instr->to_string());
+	basicBlock->method.invalidateBlockGraph((*pos).get());
+	basicBlock->method.invalidateBlockGraph(instr);
 	(*pos).reset(instr);
 	return *this;
 }
@@ -249,6 +252,7 @@ InstructionWalker& InstructionWalker::reset(intermediate::IntermediateInstructio
 InstructionWalker& InstructionWalker::erase()
 {
 	throwOnEnd(isEndOfMethod());
+	basicBlock->method.invalidateBlockGraph((*pos).get());
 	pos = basicBlock->instructions.erase(pos);
 	return *this;
 }
@@ -259,6 +263,7 @@ InstructionWalker& InstructionWalker::emplace(intermediate::IntermediateInstruct
 		throw CompilationError(CompilationStep::GENERAL, "Can't emplace at the start of a basic block", instr->to_string());
 	if(dynamic_cast<intermediate::BranchLabel*>(instr) != nullptr)
 		throw CompilationError(CompilationStep::GENERAL, "Can't add labels into a basic block", instr->to_string());
+	basicBlock->method.invalidateBlockGraph(instr);
 	pos = basicBlock->instructions.emplace(pos, instr);
 	return *this;
 }
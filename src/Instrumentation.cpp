@@ -0,0 +1,141 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#include "Instrumentation.h"
+
+#include "Module.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace vc4c;
+using namespace vc4c::profiler;
+
+static std::size_t countInstructions(const Method* method, const Module* module)
+{
+	if(method != nullptr)
+		return method->countInstructions();
+	std::size_t count = 0;
+	for(const auto& m : *module)
+		count += m->countInstructions();
+	return count;
+}
+
+Instrumentation::Step::Step(Instrumentation* instrumentation, const std::string& name, Method& method) :
+		instrumentation(instrumentation), method(&method), module(nullptr), instructionsBefore(0)
+{
+	if(instrumentation == nullptr)
+		return;
+	this->name = name;
+	instructionsBefore = method.countInstructions();
+	method.arena.pushPeakMark();
+	startTime = std::chrono::steady_clock::now();
+}
+
+Instrumentation::Step::Step(Instrumentation* instrumentation, const std::string& name, const Module& module) :
+		instrumentation(instrumentation), method(nullptr), module(&module), instructionsBefore(0)
+{
+	if(instrumentation == nullptr)
+		return;
+	this->name = name;
+	instructionsBefore = countInstructions(nullptr, &module);
+	for(const auto& m : module)
+	{
+		m->arena.pushPeakMark();
+		trackedMethods.push_back(m.get());
+	}
+	startTime = std::chrono::steady_clock::now();
+}
+
+Instrumentation::Step::~Step()
+{
+	if(instrumentation == nullptr)
+		return;
+	StepRecord record;
+	record.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+	record.name = std::move(name);
+	record.instructionsBefore = instructionsBefore;
+	record.instructionsAfter = countInstructions(method, module);
+	if(method != nullptr)
+	{
+		record.method = method->name;
+		record.numLocals = method->readLocals().size();
+		record.peakAllocatedBytes = method->arena.popPeakMark();
+	}
+	else
+	{
+		//the methods are processed in parallel, so the sum of the single peaks is an upper bound for the peak of the whole module
+		record.numLocals = 0;
+		record.peakAllocatedBytes = 0;
+		for(const auto& m : *module)
+		{
+			record.numLocals += m->readLocals().size();
+			const bool isTracked = std::find(trackedMethods.begin(), trackedMethods.end(), m.get()) != trackedMethods.end();
+			record.peakAllocatedBytes += isTracked ? m->arena.popPeakMark() : m->arena.getPeakAllocatedBytes();
+		}
+	}
+	instrumentation->addStep(std::move(record));
+}
+
+void Instrumentation::addStep(StepRecord&& step)
+{
+#ifdef MULTI_THREADED
+	std::lock_guard<std::mutex> guard(lock);
+#endif
+	steps.emplace_back(std::move(step));
+}
+
+void Instrumentation::addCounter(const Method& method, const std::string& name, const std::size_t value)
+{
+#ifdef MULTI_THREADED
+	std::lock_guard<std::mutex> guard(lock);
+#endif
+	counters.emplace_back(CounterRecord{name, method.name, value});
+}
+
+static std::string escapeJSON(const std::string& text)
+{
+	std::stringstream s;
+	for(const char c : text)
+	{
+		if(c == '"' || c == '\\')
+			s << '\\' << c;
+		else if(static_cast<unsigned char>(c) < 0x20)
+			s << "\\u" << std::hex << std::setfill('0') << std::setw(4) << static_cast<unsigned>(c) << std::dec;
+		else
+			s << c;
+	}
+	return s.str();
+}
+
+void Instrumentation::writeJSON(std::ostream& stream) const
+{
+#ifdef MULTI_THREADED
+	std::lock_guard<std::mutex> guard(lock);
+#endif
+	std::chrono::microseconds totalDuration(0);
+	stream << "{\n  \"steps\": [";
+	for(std::size_t i = 0; i < steps.size(); ++i)
+	{
+		const StepRecord& step = steps[i];
+		//the durations of steps run in parallel or nested in other steps overlap, so only the module-wide steps are summed up
+		if(step.method.empty())
+			totalDuration += step.duration;
+		stream << (i == 0 ? "\n" : ",\n");
+		stream << "    {\"step\": \"" << escapeJSON(step.name) << "\", \"method\": \"" << escapeJSON(step.method) << "\", \"duration_us\": " << step.duration.count()
+				<< ", \"instructions_before\": " << step.instructionsBefore << ", \"instructions_after\": " << step.instructionsAfter << ", \"locals\": " << step.numLocals
+				<< ", \"peak_allocated_bytes\": " << step.peakAllocatedBytes << "}";
+	}
+	stream << "\n  ],\n  \"counters\": [";
+	for(std::size_t i = 0; i < counters.size(); ++i)
+	{
+		const CounterRecord& counter = counters[i];
+		stream << (i == 0 ? "\n" : ",\n");
+		stream << "    {\"counter\": \"" << escapeJSON(counter.name) << "\", \"method\": \"" << escapeJSON(counter.method) << "\", \"value\": " << counter.value << "}";
+	}
+	stream << "\n  ],\n  \"total_duration_us\": " << totalDuration.count() << "\n}" << std::endl;
+}
@@ -0,0 +1,103 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "Optional.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
+
+namespace vc4c
+{
+	class Method;
+	class Module;
+
+	namespace profiler
+	{
+		/*
+		 * Records the duration and the resource usage of the single compilation steps (front-end, optimization passes, register-allocation, ...).
+		 *
+		 * Unlike the PROFILE_XXX macros, this is also available in release builds and is enabled per compilation via Configuration#instrumentationReport.
+		 * If disabled, recording a step only costs a null-pointer check.
+		 */
+		class Instrumentation : private NonCopyable
+		{
+		public:
+			/*
+			 * Measures a single step for the lifetime of this object.
+			 *
+			 * The step is either run for a single method or for all methods of a module.
+			 * If the instrumentation is nullptr (e.g. disabled), nothing is recorded
+			 */
+			class Step : private NonCopyable
+			{
+			public:
+				Step(Instrumentation* instrumentation, const std::string& name, Method& method);
+				Step(Instrumentation* instrumentation, const std::string& name, const Module& module);
+				~Step();
+
+			private:
+				Instrumentation* instrumentation;
+				std::string name;
+				Method* method;
+				const Module* module;
+				std::chrono::steady_clock::time_point startTime;
+				std::size_t instructionsBefore;
+				//the methods whose arenas track the peak for this step, methods created within the step track it from their creation
+				std::vector<const Method*> trackedMethods;
+			};
+
+			/*
+			 * Records a single value determined by a step for the given method, e.g. the estimated number of cycles
+			 */
+			void addCounter(const Method& method, const std::string& name, std::size_t value);
+
+			/*
+			 * Writes all steps and counters recorded as JSON object into the given stream
+			 */
+			void writeJSON(std::ostream& stream) const;
+
+		private:
+			struct StepRecord
+			{
+				std::string name;
+				//empty for steps run for the whole module
+				std::string method;
+				std::chrono::microseconds duration;
+				std::size_t instructionsBefore;
+				std::size_t instructionsAfter;
+				std::size_t numLocals;
+				//the maximum number of bytes allocated in the arena of the method(s) while running the step, including any nested steps
+				std::size_t peakAllocatedBytes;
+			};
+
+			struct CounterRecord
+			{
+				std::string name;
+				std::string method;
+				std::size_t value;
+			};
+
+			std::vector<StepRecord> steps;
+			std::vector<CounterRecord> counters;
+#ifdef MULTI_THREADED
+			mutable std::mutex lock;
+#endif
+
+			void addStep(StepRecord&& step);
+		};
+	} // namespace profiler
+} // namespace vc4c
+
+#endif /* INSTRUMENTATION_H */
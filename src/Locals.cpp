@@ -129,6 +129,11 @@ const Local* Local::getBase(bool includeOffsets) const
 	return this;
 }
 
+Optional<std::size_t> Local::getLocalIndex() const
+{
+	return localIndex;
+}
+
 Parameter::Parameter(const std::string& name, const DataType& type, const ParameterDecorations decorations) : Local(type, name), decorations(decorations)
 {
 
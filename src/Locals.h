@@ -162,6 +162,14 @@ namespace vc4c
 		 */
 		const Local* getBase(bool includeOffsets) const;
 
+		/*
+		 * Returns the index of this local within the table of locals of its method.
+		 *
+		 * The indices of the locals of a method are dense (from zero to the number of locals), so they can be used e.g. for bit-sets over all locals.
+		 * Only locals owned by a method have an index (not parameters, globals or stack-allocations) and the index of a local may change when other locals are removed.
+		 */
+		Optional<std::size_t> getLocalIndex() const;
+
 		/*
 		 * The type of the data represented by this local
 		 */
@@ -181,6 +189,7 @@ namespace vc4c
 	private:
 		//FIXME unordered_map randomly throws SEGFAULT somewhere in stdlib in #removeUser called by IntermediateInstruction#erase
 		OrderedMap<const LocalUser*, LocalUse> users;
+		Optional<std::size_t> localIndex;
 
 		friend class Method;
 	};
@@ -0,0 +1,185 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#include "MemoryArena.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+using namespace vc4c;
+
+//the alignment of all blocks, enough for every type not explicitly over-aligned
+static constexpr std::size_t BLOCK_GRANULARITY = alignof(std::max_align_t) > 16 ? alignof(std::max_align_t) : 16;
+//bigger allocations are rare (e.g. vector-buffers) and directly served by the global heap
+static constexpr std::size_t MAX_BLOCK_SIZE = 512;
+static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+//the header in front of blocks allocated via allocateInCurrentArena(), storing the owning storage
+static constexpr std::size_t HEADER_SIZE = BLOCK_GRANULARITY;
+
+struct FreeBlock
+{
+	FreeBlock* next;
+};
+
+struct MemoryArena::Storage
+{
+	std::vector<std::unique_ptr<char[]>> chunks;
+	char* nextFree = nullptr;
+	std::size_t remainingSize = 0;
+	std::array<FreeBlock*, MAX_BLOCK_SIZE / BLOCK_GRANULARITY> freeLists{};
+	//statistics for the profiler
+	std::size_t numAllocations = 0;
+	std::size_t numReusedBlocks = 0;
+	//statistics for the instrumentation
+	std::size_t allocatedBytes = 0;
+	std::size_t peakBytes = 0;
+	//the peaks of the nested trackings, only the innermost one is updated directly
+	std::vector<std::size_t> peakMarks;
+
+	~Storage()
+	{
+		PROFILE_COUNTER(20, "Arena allocations", numAllocations);
+		PROFILE_COUNTER(21, "Arena re-used blocks", numReusedBlocks);
+		PROFILE_COUNTER(22, "Arena chunks", chunks.size());
+	}
+
+	void* allocate(const std::size_t size)
+	{
+		const std::size_t sizeClass = (size + BLOCK_GRANULARITY - 1) / BLOCK_GRANULARITY - 1;
+		const std::size_t blockSize = (sizeClass + 1) * BLOCK_GRANULARITY;
+		++numAllocations;
+		addBytes(blockSize);
+		if(FreeBlock* block = freeLists[sizeClass])
+		{
+			freeLists[sizeClass] = block->next;
+			++numReusedBlocks;
+			return block;
+		}
+		if(remainingSize < blockSize)
+		{
+			//the rest of the current chunk is wasted, but this is at most MAX_BLOCK_SIZE per chunk
+			chunks.emplace_back(new char[CHUNK_SIZE]);
+			nextFree = chunks.back().get();
+			remainingSize = CHUNK_SIZE;
+		}
+		void* block = nextFree;
+		nextFree += blockSize;
+		remainingSize -= blockSize;
+		return block;
+	}
+
+	void deallocate(void* ptr, const std::size_t size) noexcept
+	{
+		//the block is only re-used by the following allocations, the memory itself is released with the whole chunk
+		const std::size_t sizeClass = (size + BLOCK_GRANULARITY - 1) / BLOCK_GRANULARITY - 1;
+		FreeBlock* block = static_cast<FreeBlock*>(ptr);
+		block->next = freeLists[sizeClass];
+		freeLists[sizeClass] = block;
+		allocatedBytes -= (sizeClass + 1) * BLOCK_GRANULARITY;
+	}
+
+	void addBytes(const std::size_t numBytes)
+	{
+		allocatedBytes += numBytes;
+		peakBytes = std::max(peakBytes, allocatedBytes);
+		if(!peakMarks.empty())
+			peakMarks.back() = std::max(peakMarks.back(), allocatedBytes);
+	}
+};
+
+static thread_local MemoryArena* currentArena = nullptr;
+
+MemoryArena::Scope::Scope(MemoryArena& arena) : previousArena(currentArena)
+{
+	currentArena = &arena;
+}
+
+MemoryArena::Scope::~Scope()
+{
+	currentArena = previousArena;
+}
+
+MemoryArena::MemoryArena() : storage(new Storage())
+{
+
+}
+
+MemoryArena::~MemoryArena()
+{
+	//releases all chunks at once
+	delete storage;
+}
+
+void* MemoryArena::allocate(const std::size_t size)
+{
+	if(size > MAX_BLOCK_SIZE)
+	{
+		storage->addBytes(size);
+		return ::operator new(size);
+	}
+	return storage->allocate(size);
+}
+
+void MemoryArena::deallocate(void* ptr, const std::size_t size) noexcept
+{
+	if(ptr == nullptr)
+		return;
+	if(size > MAX_BLOCK_SIZE)
+	{
+		::operator delete(ptr);
+		storage->allocatedBytes -= size;
+	}
+	else
+		storage->deallocate(ptr, size);
+}
+
+std::size_t MemoryArena::getAllocatedBytes() const
+{
+	return storage->allocatedBytes;
+}
+
+std::size_t MemoryArena::getPeakAllocatedBytes() const
+{
+	return storage->peakBytes;
+}
+
+void MemoryArena::pushPeakMark()
+{
+	storage->peakMarks.push_back(storage->allocatedBytes);
+}
+
+std::size_t MemoryArena::popPeakMark()
+{
+	const std::size_t peak = storage->peakMarks.back();
+	storage->peakMarks.pop_back();
+	if(!storage->peakMarks.empty())
+		storage->peakMarks.back() = std::max(storage->peakMarks.back(), peak);
+	return peak;
+}
+
+void* MemoryArena::allocateInCurrentArena(const std::size_t size)
+{
+	Storage* owner = currentArena != nullptr && size + HEADER_SIZE <= MAX_BLOCK_SIZE ? currentArena->storage : nullptr;
+	char* block = static_cast<char*>(owner != nullptr ? owner->allocate(size + HEADER_SIZE) : ::operator new(size + HEADER_SIZE));
+	*reinterpret_cast<Storage**>(block) = owner;
+	return block + HEADER_SIZE;
+}
+
+void MemoryArena::deallocateFromArena(void* ptr, const std::size_t size) noexcept
+{
+	if(ptr == nullptr)
+		return;
+	char* block = static_cast<char*>(ptr) - HEADER_SIZE;
+	Storage* owner = *reinterpret_cast<Storage**>(block);
+	if(owner == nullptr)
+		::operator delete(block);
+	else
+		owner->deallocate(block, size + HEADER_SIZE);
+}
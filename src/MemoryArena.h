@@ -0,0 +1,123 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include "Optional.h"
+
+#include <cstddef>
+#include <new>
+
+namespace vc4c
+{
+	/*
+	 * Arena allocating memory for small objects (e.g. instructions, locals) in big chunks.
+	 *
+	 * Freed blocks are kept in per-size free-lists and re-used by the following allocations of the same size class,
+	 * the chunks themselves are all released at once when the arena is destroyed.
+	 *
+	 * An arena is owned by a single method and only used by the thread currently processing this method, so it does no locking.
+	 *
+	 * NOTE: All objects allocated in the arena need to be destroyed before the arena is, so instructions must not be moved to another method
+	 * (e.g. the inlining copies the instructions in the arena of the method they are inserted into).
+	 */
+	class MemoryArena : private NonCopyable
+	{
+	public:
+		/*
+		 * Sets the arena used for all allocations of the current thread via allocateInCurrentArena() for the lifetime of this object
+		 */
+		class Scope : private NonCopyable
+		{
+		public:
+			explicit Scope(MemoryArena& arena);
+			~Scope();
+
+		private:
+			MemoryArena* previousArena;
+		};
+
+		MemoryArena();
+		~MemoryArena();
+
+		void* allocate(std::size_t size);
+		void deallocate(void* ptr, std::size_t size) noexcept;
+
+		/*
+		 * Returns the number of bytes currently allocated in this arena (including allocations directly served by the global heap)
+		 */
+		std::size_t getAllocatedBytes() const;
+		/*
+		 * Returns the maximum number of bytes allocated at the same time since the creation of the arena
+		 */
+		std::size_t getPeakAllocatedBytes() const;
+		/*
+		 * Starts tracking the maximum number of bytes allocated at the same time from now on.
+		 *
+		 * The tracking can be nested, every call needs to be matched by a call to popPeakMark()
+		 */
+		void pushPeakMark();
+		/*
+		 * Ends the innermost tracking started by pushPeakMark() and returns the maximum number of bytes allocated at the same time since then.
+		 *
+		 * The peak is also raised into the enclosing tracking, since it happened within its range too
+		 */
+		std::size_t popPeakMark();
+
+		/*
+		 * Allocates the given amount of memory in the arena currently active for this thread.
+		 *
+		 * If no arena is active, the global heap is used.
+		 * The memory must be freed via deallocateFromArena(), which finds the owning arena by itself.
+		 */
+		static void* allocateInCurrentArena(std::size_t size);
+		static void deallocateFromArena(void* ptr, std::size_t size) noexcept;
+
+	private:
+		struct Storage;
+		Storage* storage;
+	};
+
+	/*
+	 * Allocator for standard containers, allocating their elements within a MemoryArena
+	 */
+	template<typename T>
+	struct ArenaAllocator
+	{
+		using value_type = T;
+
+		explicit ArenaAllocator(MemoryArena& arena) noexcept : arena(&arena) { }
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) { }
+
+		T* allocate(std::size_t n)
+		{
+			return static_cast<T*>(arena->allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T* ptr, std::size_t n) noexcept
+		{
+			arena->deallocate(ptr, n * sizeof(T));
+		}
+
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& other) const noexcept
+		{
+			return arena == other.arena;
+		}
+
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const noexcept
+		{
+			return arena != other.arena;
+		}
+
+		MemoryArena* arena;
+	};
+} // namespace vc4c
+
+#endif /* MEMORY_ARENA_H */
@@ -85,47 +85,59 @@ const intermediate::BranchLabel* BasicBlock::getLabel() const
 	return dynamic_cast<intermediate::BranchLabel*>(instructions.front().get());
 }
 
+/*
+ * The blocks are never removed from a method (only when it is destroyed), so the cached block pointers stay valid.
+ * The label of a cached block is checked on every look-up, the order of the blocks is re-calculated after inserting blocks
+ * and the branches between the blocks after inserting, removing or replacing a branch or label.
+ */
+struct Method::BlockGraph
+{
+	FastMap<const Local*, BasicBlock*> blocksByLabel;
+	//whether all labels are contained in the map, so a missing entry means there is no such block
+	bool labelsValid = false;
+
+	std::vector<BasicBlock*> blockOrder;
+	FastMap<const BasicBlock*, std::size_t> blockIndices;
+	bool orderValid = false;
+
+	//the branches jumping to a block and the blocks branched to from a block, without the implicit transitions by falling through to the next block
+	FastMap<const BasicBlock*, std::vector<InstructionWalker>> incomingBranches;
+	FastMap<const BasicBlock*, std::vector<BasicBlock*>> branchTargets;
+	bool branchesValid = false;
+};
+
 void BasicBlock::forSuccessiveBlocks(const std::function<void(BasicBlock&)>& consumer) const
 {
-	InstructionWalker it = const_cast<BasicBlock*>(this)->begin();
-	while(!it.isEndOfBlock())
+	const Method::BlockGraph& graph = method.getBlockGraph(true);
+	auto it = graph.branchTargets.find(this);
+	if(it != graph.branchTargets.end())
 	{
-		if(it.has<intermediate::Branch>())
-		{
-			BasicBlock* next = method.findBasicBlock(it.get<intermediate::Branch>()->getTarget());
-			if(next != nullptr)
-				consumer(*next);
-		}
-		it.nextInBlock();
-		if(fallsThroughToNextBlock())
-		{
-			BasicBlock* next = method.getNextBlockAfter(this);
-			if(next != nullptr)
-				consumer(*next);
-		}
+		//the consumer could modify the branches, which invalidates the cached lists
+		const std::vector<BasicBlock*> successors(it->second);
+		for(BasicBlock* next : successors)
+			consumer(*next);
+	}
+	if(fallsThroughToNextBlock())
+	{
+		BasicBlock* next = method.getNextBlockAfter(this);
+		if(next != nullptr)
+			consumer(*next);
 	}
 }
 
 void BasicBlock::forPredecessors(const std::function<void(InstructionWalker)>& consumer) const
 {
-	//TODO some more efficient way of doing this??!
-	const Local* label = getLabel()->getLabel();
-	BasicBlock* prevBlock = nullptr;
-	bool prevBlockFound = false;
-	for(BasicBlock& bb : method)
+	const Method::BlockGraph& graph = method.getBlockGraph(true);
+	auto it = graph.incomingBranches.find(this);
+	if(it != graph.incomingBranches.end())
 	{
-		for(auto it = bb.begin(); !it.isEndOfBlock(); it.nextInBlock())
-		{
-			intermediate::Branch* br = it.get<intermediate::Branch>();
-			if(br != nullptr && br->getTarget() == label)
-				consumer(it);
-		}
-		if(&bb == this)
-			prevBlockFound = true;
-		if(!prevBlockFound)
-			prevBlock = &bb;
+		//the consumer could modify the branches, which invalidates the cached lists
+		const std::vector<InstructionWalker> branches(it->second);
+		for(const InstructionWalker& branch : branches)
+			consumer(branch);
 	}
-	if(prevBlockFound && prevBlock != nullptr && prevBlock->fallsThroughToNextBlock())
+	BasicBlock* prevBlock = method.getPreviousBlock(this);
+	if(prevBlock != nullptr && prevBlock->fallsThroughToNextBlock())
 	{
 		consumer(prevBlock->end().previousInBlock());
 	}
@@ -217,7 +229,8 @@ void BasicBlock::dumpInstructions() const {
 	logging::debug() << "Block end ----" << logging::endl;
 }
 
-Method::Method(const Module& module) : isKernel(false), name(), returnType(TYPE_UNKNOWN), vpm(new periphery::VPM(module.compilationConfig.availableVPMSize)), module(module)
+Method::Method(const Module& module) : isKernel(false), name(), returnType(TYPE_UNKNOWN), vpm(new periphery::VPM(module.compilationConfig.availableVPMSize)), module(module),
+		blockGraph(new BlockGraph()), tmpIndex(0)
 {
 
 }
@@ -226,12 +239,15 @@ Method::~Method()
 {
 	//makes sure, instructions are removed before locals (so usages are all zero)
 	basicBlocks.clear();
+	for(Local* local : locals)
+		destroyLocal(local);
 }
 
 const Local* Method::findLocal(const std::string& name) const
 {
-	if(locals.find(name) != locals.end())
-		return &locals.at(name);
+	auto it = localsByName.find(name);
+	if(it != localsByName.end())
+		return it->second;
 	return nullptr;
 }
 
@@ -271,8 +287,7 @@ const Local* Method::findOrCreateLocal(const DataType& type, const std::string&
 		loc = findStackAllocation(name);
 	if(loc != nullptr)
 		return loc;
-	auto it = locals.emplace(name, Local(type, name));
-	return &(it.first->second);
+	return createLocal(type, name);
 }
 
 static bool removeUsagesInBasicBlock(Method& method, BasicBlock& bb, const Local* locale, OrderedMap<const LocalUser*, LocalUse>& remainingUsers, int& usageRangeLeft)
@@ -324,15 +339,27 @@ bool Method::isLocallyLimited(InstructionWalker curIt, const Local* locale, cons
 	return remainingUsers.empty();
 }
 
-static std::size_t tmpIndex = 0;
-
 const Value Method::addNewLocal(const DataType& type, const std::string& prefix, const std::string& postfix)
 {
 	const std::string name = createLocalName(prefix, postfix);
 	if(findLocal(name) != nullptr)
 		throw CompilationError(CompilationStep::GENERAL, "Local with this name already exists", findLocal(name)->to_string());
-	auto it = locals.emplace(name, Local(type, name));
-    return it.first->second.createReference();
+    return createLocal(type, name)->createReference();
+}
+
+Local* Method::createLocal(const DataType& type, const std::string& name)
+{
+	Local* local = new (arena.allocate(sizeof(Local))) Local(type, name);
+	local->localIndex = locals.size();
+	locals.push_back(local);
+	localsByName.emplace(name, local);
+	return local;
+}
+
+void Method::destroyLocal(Local* local)
+{
+	local->~Local();
+	arena.deallocate(local, sizeof(Local));
 }
 
 std::string Method::createLocalName(const std::string& prefix, const std::string& postfix)
@@ -412,11 +439,15 @@ std::size_t Method::cleanEmptyInstructions()
 void Method::appendToEnd(intermediate::IntermediateInstruction* instr)
 {
 	if(dynamic_cast<intermediate::BranchLabel*>(instr) != nullptr)
+	{
 		basicBlocks.emplace_back(*this, dynamic_cast<intermediate::BranchLabel*>(instr));
+		invalidateBlockOrder();
+	}
 	else
 	{
 		checkAndCreateDefaultBasicBlock();
 		basicBlocks.back().instructions.emplace_back(instr);
+		invalidateBlockGraph(instr);
 	}
 }
 InstructionWalker Method::appendToEnd()
@@ -425,11 +456,28 @@ InstructionWalker Method::appendToEnd()
 	return basicBlocks.back().end();
 }
 
-const OrderedMap<std::string, Local>& Method::readLocals() const
+const Method::LocalsTable& Method::readLocals() const
 {
 	return locals;
 }
 
+void Method::removeLocal(const std::string& name)
+{
+	auto it = localsByName.find(name);
+	if(it == localsByName.end())
+		return;
+	Local* local = it->second;
+	if(!local->getUsers().empty())
+		throw CompilationError(CompilationStep::GENERAL, "Cannot remove local which is still used", local->to_string());
+	localsByName.erase(it);
+	//move the last local into the free position, so the indices stay dense
+	const std::size_t index = local->localIndex.value();
+	locals[index] = locals.back();
+	locals[index]->localIndex = index;
+	locals.pop_back();
+	destroyLocal(local);
+}
+
 void Method::cleanLocals()
 {
 	PROFILE_COUNTER(7, "Clean locals (before)", locals.size());
@@ -447,22 +495,28 @@ void Method::cleanLocals()
 			throw CompilationError(CompilationStep::GENERAL, "Duplicate parameter for method", p.to_string());
 	}
 #endif
-	auto it = locals.begin();
-	std::size_t numCleaned = 0;
-	while(it != locals.end())
+	//the remaining locals are moved to the front, keeping their order
+	std::size_t numRemaining = 0;
+	for(Local* local : locals)
 	{
 #ifdef DEBUG_MODE
-		if(!localNames.emplace(it->first).second)
-			throw CompilationError(CompilationStep::GENERAL, "Local is already defined for method", it->second.to_string());
+		if(!localNames.emplace(local->name).second)
+			throw CompilationError(CompilationStep::GENERAL, "Local is already defined for method", local->to_string());
 #endif
-		if((*it).second.getUsers().empty())
+		if(local->getUsers().empty())
 		{
-			it = locals.erase(it);
-			++numCleaned;
+			localsByName.erase(local->name);
+			destroyLocal(local);
 		}
 		else
-			++it;
+		{
+			local->localIndex = numRemaining;
+			locals[numRemaining] = local;
+			++numRemaining;
+		}
 	}
+	const std::size_t numCleaned = locals.size() - numRemaining;
+	locals.resize(numRemaining);
 	logging::debug() << "Cleaned " << numCleaned << " unused locals from method " << name << logging::endl;
 	PROFILE_COUNTER_WITH_PREV(8, "Clean locals (after)", locals.size(), 7);
 }
@@ -480,14 +534,28 @@ RandomModificationList<BasicBlock>& Method::getBasicBlocks()
 	return basicBlocks;
 }
 
+static bool hasLabel(BasicBlock& block, const Local* label)
+{
+	return block.begin().has<intermediate::BranchLabel>() && block.begin().get<intermediate::BranchLabel>()->getLabel() == label;
+}
+
 BasicBlock* Method::findBasicBlock(const Local* label)
 {
+	auto it = blockGraph->blocksByLabel.find(label);
+	if(it != blockGraph->blocksByLabel.end() && hasLabel(*it->second, label))
+		return it->second;
+	if(it == blockGraph->blocksByLabel.end() && blockGraph->labelsValid)
+		return nullptr;
+	//the cache is outdated, e.g. new blocks were inserted or labels replaced
+	blockGraph->blocksByLabel.clear();
 	for(BasicBlock& bb : basicBlocks)
 	{
-		if(bb.begin().has<intermediate::BranchLabel>() && bb.begin().get<intermediate::BranchLabel>()->getLabel() == label)
-			return &bb;
+		if(bb.begin().has<intermediate::BranchLabel>())
+			blockGraph->blocksByLabel.emplace(bb.begin().get<intermediate::BranchLabel>()->getLabel(), &bb);
 	}
-	return nullptr;
+	blockGraph->labelsValid = true;
+	it = blockGraph->blocksByLabel.find(label);
+	return it == blockGraph->blocksByLabel.end() ? nullptr : it->second;
 }
 
 InstructionWalker Method::emplaceLabel(InstructionWalker it, intermediate::BranchLabel* label)
@@ -506,6 +574,8 @@ InstructionWalker Method::emplaceLabel(InstructionWalker it, intermediate::Branc
 	if(!isStartOfBlock)
 		++blockIt;
 	BasicBlock& newBlock = *basicBlocks.emplace(blockIt, *this, label);
+	//this also moves branches into the new block
+	invalidateBlockOrder();
 	//2. move all instructions beginning with it (inclusive) to the new basic block
 	while(!isStartOfBlock && !it.isEndOfBlock())
 	{
@@ -575,30 +645,77 @@ std::size_t Method::getStackBaseOffset() const
 
 BasicBlock* Method::getNextBlockAfter(const BasicBlock* block)
 {
-	bool returnNext = false;
-	for(BasicBlock& bb : basicBlocks)
+	const BlockGraph& graph = getBlockGraph(false);
+	auto it = graph.blockIndices.find(block);
+	if(it == graph.blockIndices.end() || it->second + 1 >= graph.blockOrder.size())
+		return nullptr;
+	return graph.blockOrder[it->second + 1];
+}
+
+BasicBlock* Method::getPreviousBlock(const BasicBlock* block)
+{
+	const BlockGraph& graph = getBlockGraph(false);
+	auto it = graph.blockIndices.find(block);
+	if(it == graph.blockIndices.end() || it->second == 0)
+		return nullptr;
+	return graph.blockOrder[it->second - 1];
+}
+
+Method::BlockGraph& Method::getBlockGraph(const bool withBranches)
+{
+	if(!blockGraph->orderValid)
 	{
-		if(returnNext)
-			return &bb;
-		if(&bb == block)
-			returnNext = true;
+		blockGraph->blockOrder.clear();
+		blockGraph->blockIndices.clear();
+		blockGraph->blockOrder.reserve(basicBlocks.size());
+		for(BasicBlock& bb : basicBlocks)
+		{
+			blockGraph->blockIndices.emplace(&bb, blockGraph->blockOrder.size());
+			blockGraph->blockOrder.push_back(&bb);
+		}
+		blockGraph->orderValid = true;
 	}
-	return nullptr;
+	if(withBranches && !blockGraph->branchesValid)
+	{
+		PROFILE_START(updateBlockGraph);
+		blockGraph->incomingBranches.clear();
+		blockGraph->branchTargets.clear();
+		for(BasicBlock& bb : basicBlocks)
+		{
+			for(auto it = bb.begin(); !it.isEndOfBlock(); it.nextInBlock())
+			{
+				const intermediate::Branch* br = it.get<const intermediate::Branch>();
+				if(br == nullptr)
+					continue;
+				BasicBlock* target = findBasicBlock(br->getTarget());
+				if(target == nullptr)
+					continue;
+				blockGraph->incomingBranches[target].push_back(it);
+				blockGraph->branchTargets[&bb].push_back(target);
+			}
+		}
+		blockGraph->branchesValid = true;
+		PROFILE_END(updateBlockGraph);
+	}
+	return *blockGraph;
 }
 
-BasicBlock* Method::getPreviousBlock(const BasicBlock* block)
+void Method::invalidateBlockGraph(const intermediate::IntermediateInstruction* changedInstruction)
 {
-	bool returnNext = false;
-	auto it = basicBlocks.rbegin();
-	while(it != basicBlocks.rend())
+	if(dynamic_cast<const intermediate::Branch*>(changedInstruction) != nullptr)
+		blockGraph->branchesValid = false;
+	else if(dynamic_cast<const intermediate::BranchLabel*>(changedInstruction) != nullptr)
 	{
-		if(returnNext)
-			return &(*it);
-		if(&(*it) == block)
-			returnNext = true;
-		--it;
+		blockGraph->labelsValid = false;
+		blockGraph->branchesValid = false;
 	}
-	return nullptr;
+}
+
+void Method::invalidateBlockOrder()
+{
+	blockGraph->labelsValid = false;
+	blockGraph->orderValid = false;
+	blockGraph->branchesValid = false;
 }
 
 void Method::checkAndCreateDefaultBasicBlock()
@@ -607,10 +724,11 @@ void Method::checkAndCreateDefaultBasicBlock()
 	{
 		// in case the input code does not always add a label to the start of a function
 		basicBlocks.emplace_back(*this, new intermediate::BranchLabel(*findOrCreateLocal(TYPE_LABEL, BasicBlock::DEFAULT_BLOCK)));
+		invalidateBlockOrder();
 	}
 }
 
-Module::Module(const Configuration& compilationConfig): compilationConfig(compilationConfig)
+Module::Module(const Configuration& compilationConfig): compilationConfig(compilationConfig), instrumentation(nullptr)
 {
 
 }
@@ -10,6 +10,7 @@
 #include "config.h"
 #include "KernelMetaData.h"
 #include "Locals.h"
+#include "MemoryArena.h"
 #include "performance.h"
 #include "Types.h"
 
@@ -26,6 +27,11 @@ namespace vc4c
 		class VPM;
 	} // namespace periphery
 
+	namespace profiler
+	{
+		class Instrumentation;
+	} // namespace profiler
+
 	class InstructionWalker;
 	class BasicBlock;
 	class Module;
@@ -129,6 +135,8 @@ namespace vc4c
 	{
 		using BasicBlockList = RandomModificationList<BasicBlock>;
 	public:
+		using LocalsTable = std::vector<Local*>;
+
 		static const std::string WORK_DIMENSIONS;
 		static const std::string LOCAL_SIZES;
 		static const std::string LOCAL_IDS;
@@ -173,6 +181,12 @@ namespace vc4c
 		 * The VPM object to manage the use of the VPM cache
 		 */
 		std::unique_ptr<periphery::VPM> vpm;
+		/*
+		 * The arena the locals of this method are allocated in.
+		 *
+		 * The instructions are allocated in this arena too, if it is activated (via MemoryArena::Scope) while processing this method
+		 */
+		MemoryArena arena;
 
 		explicit Method(const Module& module);
 		Method(const Method&) = delete;
@@ -250,9 +264,19 @@ namespace vc4c
 		 */
 		InstructionWalker appendToEnd();
 
-		const OrderedMap<std::string, Local>& readLocals() const;
 		/*
-		 * Removes all locals without any usages left
+		 * Returns the locals of this method (not including parameters, globals and stack-allocations), the position in the table is the index of the local
+		 * (see Local#getLocalIndex()).
+		 */
+		const LocalsTable& readLocals() const;
+		/*
+		 * Removes the local with the given name, which must not be used anymore.
+		 *
+		 * The last local in the table takes over the index of the removed local
+		 */
+		void removeLocal(const std::string& name);
+		/*
+		 * Removes all locals without any usages left and compacts the indices of the remaining locals
 		 */
 		void cleanLocals();
 
@@ -286,7 +310,9 @@ namespace vc4c
 		}
 
 		/*
-		 * Searches for the basic-block belonging to the given label
+		 * Searches for the basic-block belonging to the given label.
+		 *
+		 * The blocks are cached by their labels, so the look-up is in constant time as long as no new blocks are inserted
 		 */
 		BasicBlock* findBasicBlock(const Local* label);
 
@@ -330,17 +356,45 @@ namespace vc4c
 		 */
 		BasicBlockList basicBlocks;
 		/*
-		 * The list of locals
+		 * The table of locals, indexed by the local-index. The locals are allocated in the arena of this method
+		 */
+		LocalsTable locals;
+		/*
+		 * The index over the names of the locals, for looking up locals by name
 		 */
-		OrderedMap<std::string, Local> locals;
+		FastMap<std::string, Local*> localsByName;
+		/*
+		 * The cached relations between the basic blocks (label to block, order of the blocks, branches between the blocks)
+		 */
+		struct BlockGraph;
+		std::unique_ptr<BlockGraph> blockGraph;
+		/*
+		 * The index for generating unique local names. Since the names only need to be unique within the method, this makes them independent of the order the methods are processed in
+		 */
+		std::size_t tmpIndex;
 
 		std::string createLocalName(const std::string& prefix = "", const std::string& postfix = "");
+		Local* createLocal(const DataType& type, const std::string& name);
+		void destroyLocal(Local* local);
 
 		BasicBlock* getNextBlockAfter(const BasicBlock* block);
 		BasicBlock* getPreviousBlock(const BasicBlock* block);
 
 		void checkAndCreateDefaultBasicBlock();
 
+		/*
+		 * Returns the cached block relations, updating the order of the blocks and (if requested) the branches between them, if they are outdated
+		 */
+		BlockGraph& getBlockGraph(bool withBranches);
+		/*
+		 * Marks the cached block relations as outdated, if the given instruction is a branch or a label inserted, removed or replaced
+		 */
+		void invalidateBlockGraph(const intermediate::IntermediateInstruction* changedInstruction);
+		/*
+		 * Marks all cached block relations as outdated, e.g. after inserting a new block
+		 */
+		void invalidateBlockOrder();
+
 		friend class BasicBlock;
 		friend class ControlFlowGraph;
 		friend class InstructionWalker;
@@ -366,6 +420,8 @@ namespace vc4c
 
 		/*
 		 * The global data within this module
+		 *
+		 * NOTE: Since the methods are optimized in parallel, the global data must not be modified after the front-end has finished parsing
 		 */
 		ReferenceRetainingList<Global> globalData;
 		/*
@@ -413,6 +469,10 @@ namespace vc4c
 		const Global* findGlobal(const std::string& name) const;
 
 		const Configuration& compilationConfig;
+		/*
+		 * The instrumentation to record the compilation steps into, nullptr if disabled
+		 */
+		profiler::Instrumentation* instrumentation;
 	};
 } // namespace vc4c
 
@@ -307,7 +307,9 @@ static std::string buildCommand(const std::string& compiler, const std::string&
 static void runPrecompiler(const std::string& command, std::istream* inputStream, std::ostream* outputStream, const Optional<std::string>& tempFile)
 {
 	std::ostringstream stderr;
-	int status = runProcess(command, inputStream, outputStream, &stderr);
+	//only commands reading from stdin and writing to stdout are the same for all compilations with the same options
+	const bool keepResident = inputStream != nullptr && !tempFile;
+	int status = helper::isProcessHelperRunning() ? helper::runProcessInHelper(command, inputStream, outputStream, &stderr, keepResident) : runProcess(command, inputStream, outputStream, &stderr);
 	if(status == 0)	//success
 	{
 		if(!stderr.str().empty())
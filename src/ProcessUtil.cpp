@@ -7,21 +7,33 @@
 #include "ProcessUtil.h"
 
 #include "CompilationError.h"
+#include "Optional.h"
 #include "Profiler.h"
 #include "log.h"
 
 #include <array>
 #include <chrono>
+#include <csignal>
 #include <cstdio>
 #include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <sys/select.h>
+#include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 #include <thread>
 #include <unistd.h>
 #include <vector>
 
+#ifdef MULTI_THREADED
+#include <condition_variable>
+#include <mutex>
+#endif
+
 #ifdef PRECOMPILER_DROP_RIGHTS
 #include <pwd.h>
 #include <sys/types.h>
@@ -40,7 +52,8 @@ static constexpr int BUFFER_SIZE = 1024;
 
 static void initPipe(std::array<int, 2>& fds)
 {
-	if(pipe(fds.data()) != 0)
+	//the pipes are only inherited (as standard streams) by the process they are created for, not by any other process started concurrently
+	if(pipe2(fds.data(), O_CLOEXEC) != 0)
 		throw CompilationError(CompilationStep::GENERAL, "Error creating pipe", strerror(errno));
 }
 
@@ -82,7 +95,41 @@ static void dropRights(const std::string& user)
 #endif
 }
 
-static void runChild(const std::string& command, std::array<std::array<int, 2>, 3>& pipes, bool hasStdIn, bool hasStdOut, bool hasStdErr)
+/*
+ * A started child process and the pipes to its standard input/output/error streams.
+ *
+ * All remaining file descriptors are closed on destruction and a child process not yet waited for is killed.
+ */
+struct ChildProcess : private NonCopyable
+{
+	pid_t pid = -1;
+	std::array<std::array<int, 2>, 3> pipes{{{-1, -1}, {-1, -1}, {-1, -1}}};
+
+	ChildProcess() = default;
+
+	~ChildProcess()
+	{
+		for(auto& pipe : pipes)
+		{
+			closeFile(pipe[READ]);
+			closeFile(pipe[WRITE]);
+		}
+		if(pid > 0)
+		{
+			kill(pid, SIGKILL);
+			waitpid(pid, nullptr, 0);
+		}
+	}
+
+	static void closeFile(int& fd)
+	{
+		if(fd >= 0)
+			close(fd);
+		fd = -1;
+	}
+};
+
+static void runChild(const std::vector<char*>& args, std::array<std::array<int, 2>, 3>& pipes, bool hasStdIn, bool hasStdOut, bool hasStdErr)
 {
 	//map pipes into stdin/stdout/stderr
 	//close pipes not used by child
@@ -108,18 +155,7 @@ static void runChild(const std::string& command, std::array<std::array<int, 2>,
 	//drop rights, if configured
 	dropRights("pi");
 
-	//split command
-	std::vector<std::string> parts = splitString(command, ' ');
-	const std::string file = parts.at(0);
-	std::array<char*, 128> args{};
-	args.fill(nullptr);
-	//man(3) exec: "The first argument, by convention, should point to the filename associated with the file being executed"
-	for(std::size_t i = 0; i < parts.size(); ++i)
-	{
-		args.at(i) = const_cast<char*>(parts.at(i).data());
-	}
-
-	execvp(file.data(), args.data());
+	execvp(args.front(), args.data());
 }
 
 static bool isChildFinished(pid_t pid, int* exitStatus, bool wait = false)
@@ -147,34 +183,68 @@ static bool isChildFinished(pid_t pid, int* exitStatus, bool wait = false)
 	throw CompilationError(CompilationStep::GENERAL, "Unhandled case in retrieving child process information", std::to_string(result));
 }
 
-int vc4c::runProcess(const std::string& command, std::istream* stdin, std::ostream* stdout, std::ostream* stderr)
+/*
+ * Starts the command in a new child-process, which waits for its input (if any) to be written into its standard input
+ */
+static void startProcess(const std::string& command, ChildProcess& child, bool hasStdIn, bool hasStdOut, bool hasStdErr)
 {
-	/*
-	 * See:
-	 * https://jineshkj.wordpress.com/2006/12/22/how-to-capture-stdin-stdout-and-stderr-of-child-program/
-	 * https://stackoverflow.com/questions/6171552/popen-simultaneous-read-and-write
-	 * https://www.linuxquestions.org/questions/programming-9/popen-read-and-write-both-how-201083/
-	 * https://stackoverflow.com/questions/29554036/waiting-for-popen-subprocess-to-terminate-before-reading?rq=1
-	 */
-
-	std::array<std::array<int, 2>, 3> pipes{};
+	if(hasStdIn)
+		initPipe(child.pipes[STD_IN]);
+	if(hasStdOut)
+		initPipe(child.pipes[STD_OUT]);
+	if(hasStdErr)
+		initPipe(child.pipes[STD_ERR]);
 
-	if(stdin != nullptr)
-		initPipe(pipes[STD_IN]);
-	if(stdout != nullptr)
-		initPipe(pipes[STD_OUT]);
-	if(stderr != nullptr)
-		initPipe(pipes[STD_ERR]);
+	//split command before forking, so the child does not need to allocate any memory
+	std::vector<std::string> parts = splitString(command, ' ');
+	//man(3) exec: "The first argument, by convention, should point to the filename associated with the file being executed"
+	std::vector<char*> args;
+	args.reserve(parts.size() + 1);
+	for(std::string& part : parts)
+		args.push_back(&part[0]);
+	args.push_back(nullptr);
 
 	pid_t pid = fork();
+	if(pid < 0)
+		throw CompilationError(CompilationStep::GENERAL, "Error forking child process", strerror(errno));
 	if(pid == 0) //child
 	{
-		runChild(command, pipes, stdin != nullptr, stdout != nullptr, stderr != nullptr);
+		try
+		{
+			runChild(args, child.pipes, hasStdIn, hasStdOut, hasStdErr);
+		}
+		catch(...)
+		{
+			//handled below
+		}
 		/*
-		 * Nothing below this line should be executed by child process. If so, it means that the exec function wasn't successful, so lets exit:
+		 * Nothing below this line should be executed by child process. If so, it means that the exec function wasn't successful, so lets exit
+		 * without running any destructors/exit-handlers of the parent process
 		 */
-		throw CompilationError(CompilationStep::GENERAL, "Error executing the child process", strerror(errno));
+		dprintf(STDERR_FILENO, "Error executing the child process: %s\n", strerror(errno));
+		_exit(127);
 	}
+	child.pid = pid;
+	//close the pipe ends used by the child, so reading its output returns EOF when the child terminates
+	ChildProcess::closeFile(child.pipes[STD_IN][READ]);
+	ChildProcess::closeFile(child.pipes[STD_OUT][WRITE]);
+	ChildProcess::closeFile(child.pipes[STD_ERR][WRITE]);
+}
+
+/*
+ * Passes the standard input/output/error streams to the started child process, waits for the process to finish and returns it status
+ */
+static int communicate(ChildProcess& child, std::istream* stdin, std::ostream* stdout, std::ostream* stderr)
+{
+	/*
+	 * See:
+	 * https://jineshkj.wordpress.com/2006/12/22/how-to-capture-stdin-stdout-and-stderr-of-child-program/
+	 * https://stackoverflow.com/questions/6171552/popen-simultaneous-read-and-write
+	 * https://www.linuxquestions.org/questions/programming-9/popen-read-and-write-both-how-201083/
+	 * https://stackoverflow.com/questions/29554036/waiting-for-popen-subprocess-to-terminate-before-reading?rq=1
+	 */
+	const pid_t pid = child.pid;
+	auto& pipes = child.pipes;
 
 	std::array<char, BUFFER_SIZE> buffer{};
 	ssize_t numBytes;
@@ -194,13 +264,14 @@ int vc4c::runProcess(const std::string& command, std::istream* stdin, std::ostre
 			if(numBytes != buffer.size())
 				break;
 		}
-		closePipe(pipes[STD_IN][READ]);
-		closePipe(pipes[STD_IN][WRITE]);
+		ChildProcess::closeFile(pipes[STD_IN][READ]);
+		ChildProcess::closeFile(pipes[STD_IN][WRITE]);
 	}
 	PROFILE_END(WriteToChildProcess);
 
-	bool stdOutFinished = stdout != nullptr;
-	bool stdErrFinished = stderr != nullptr;
+	//an output stream is finished, if it is not read at all or its EOF was read
+	bool stdOutFinished = stdout == nullptr;
+	bool stdErrFinished = stderr == nullptr;
 
 	int highestFD = std::max(pipes[STD_OUT][READ], pipes[STD_ERR][READ]);
 	fd_set readDescriptors{};
@@ -217,9 +288,9 @@ int vc4c::runProcess(const std::string& command, std::istream* stdin, std::ostre
 	while(!(stdOutFinished && stdErrFinished) || !(childFinished = childFinished || isChildFinished(pid, &exitStatus)))
 	{
 		FD_ZERO(&readDescriptors);
-		if(stdout != nullptr)
+		if(!stdOutFinished)
 			FD_SET(pipes[STD_OUT][READ], &readDescriptors);
-		if(stderr != nullptr)
+		if(!stdErrFinished)
 			FD_SET(pipes[STD_ERR][READ], &readDescriptors);
 		/*
 		 * "Those listed in readfds will be watched to see if characters become available for reading
@@ -236,7 +307,7 @@ int vc4c::runProcess(const std::string& command, std::istream* stdin, std::ostre
 		else if(selectStatus != 0)
 		{
 			//something happened
-			if(stdout != nullptr && FD_ISSET(pipes[STD_OUT][READ], &readDescriptors))
+			if(!stdOutFinished && FD_ISSET(pipes[STD_OUT][READ], &readDescriptors))
 			{
 				numBytes = read(pipes[STD_OUT][READ], buffer.data(), buffer.size());
 				stdout->write(buffer.data(), numBytes);
@@ -244,7 +315,7 @@ int vc4c::runProcess(const std::string& command, std::istream* stdin, std::ostre
 					//EOF
 					stdOutFinished = true;
 			}
-			if(stderr != nullptr && FD_ISSET(pipes[STD_ERR][READ], &readDescriptors))
+			if(!stdErrFinished && FD_ISSET(pipes[STD_ERR][READ], &readDescriptors))
 			{
 				numBytes = read(pipes[STD_ERR][READ], buffer.data(), buffer.size());
 				stderr->write(buffer.data(), numBytes);
@@ -256,21 +327,408 @@ int vc4c::runProcess(const std::string& command, std::istream* stdin, std::ostre
 	}
 	PROFILE_END(ReadFromChildProcess);
 
-	if(stdout != nullptr)
+	if(!childFinished)
 	{
-		closePipe(pipes[STD_OUT][READ]);
-		closePipe(pipes[STD_OUT][WRITE]);
+		PROFILE(isChildFinished, pid, &exitStatus, true);
 	}
+	//the child is waited for, so it must not be killed anymore
+	child.pid = -1;
+	return exitStatus;
+}
 
-	if(stderr != nullptr)
+int vc4c::runProcess(const std::string& command, std::istream* stdin, std::ostream* stdout, std::ostream* stderr)
+{
+	ChildProcess child;
+	startProcess(command, child, stdin != nullptr, stdout != nullptr, stderr != nullptr);
+	return communicate(child, stdin, stdout, stderr);
+}
+
+/*
+ * The compiler process passes the socket for every single request via the control socket to the helper process (as SCM_RIGHTS),
+ * the request itself is then exchanged via this socket, so concurrent requests do not wait for each other:
+ * - request: <command-length><command><flags><stdin-length><stdin-data>
+ * - response: <exit-status><stdout-length><stdout-data><stderr-length><stderr-data>
+ */
+static constexpr uint8_t HELPER_HAS_STDIN = 1;
+static constexpr uint8_t HELPER_HAS_STDOUT = 2;
+static constexpr uint8_t HELPER_HAS_STDERR = 4;
+static constexpr uint8_t HELPER_KEEP_RESIDENT = 8;
+
+/*
+ * The maximum number of different commands the helper keeps a pre-started process for
+ */
+static constexpr std::size_t MAX_RESIDENT_PROCESSES = 4;
+
+struct ProcessHelper
+{
+	pid_t pid = -1;
+	int socket = -1;
+#ifdef MULTI_THREADED
+	std::mutex lock;
+#endif
+
+	~ProcessHelper()
 	{
-		closePipe(pipes[STD_ERR][READ]);
-		closePipe(pipes[STD_ERR][WRITE]);
+		stop();
 	}
 
-	if(!childFinished)
+	void stop()
 	{
-		PROFILE(isChildFinished, pid, &exitStatus, true);
+		if(socket >= 0)
+			//the helper process terminates on EOF
+			close(socket);
+		socket = -1;
+		if(pid > 0)
+			waitpid(pid, nullptr, 0);
+		pid = -1;
 	}
-	return exitStatus;
+};
+
+static ProcessHelper processHelper;
+
+static bool writeAll(int fd, const void* data, std::size_t length)
+{
+	const char* ptr = reinterpret_cast<const char*>(data);
+	while(length > 0)
+	{
+		//if the other side of the socket is closed (e.g. the helper process died), fail instead of raising SIGPIPE, which would terminate the process
+		ssize_t numBytes = send(fd, ptr, length, MSG_NOSIGNAL);
+		if(numBytes < 0 && errno == EINTR)
+			continue;
+		if(numBytes <= 0)
+			return false;
+		ptr += numBytes;
+		length -= static_cast<std::size_t>(numBytes);
+	}
+	return true;
+}
+
+static bool readAll(int fd, void* data, std::size_t length)
+{
+	char* ptr = reinterpret_cast<char*>(data);
+	while(length > 0)
+	{
+		ssize_t numBytes = read(fd, ptr, length);
+		if(numBytes < 0 && errno == EINTR)
+			continue;
+		if(numBytes <= 0)
+			return false;
+		ptr += numBytes;
+		length -= static_cast<std::size_t>(numBytes);
+	}
+	return true;
+}
+
+static bool writeString(int fd, const std::string& s)
+{
+	const uint64_t length = s.size();
+	return writeAll(fd, &length, sizeof(length)) && writeAll(fd, s.data(), s.size());
+}
+
+static bool readString(int fd, std::string& s)
+{
+	uint64_t length = 0;
+	if(!readAll(fd, &length, sizeof(length)))
+		return false;
+	s.resize(length);
+	return readAll(fd, &s[0], length);
+}
+
+static bool sendSocket(int socket, int fd)
+{
+	char dummy = 0;
+	iovec data{&dummy, sizeof(dummy)};
+	std::array<char, CMSG_SPACE(sizeof(int))> control{};
+	msghdr message{};
+	message.msg_iov = &data;
+	message.msg_iovlen = 1;
+	message.msg_control = control.data();
+	message.msg_controllen = control.size();
+	cmsghdr* header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(int));
+	std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+	ssize_t numBytes;
+	do
+	{
+		numBytes = sendmsg(socket, &message, MSG_NOSIGNAL);
+	} while(numBytes < 0 && errno == EINTR);
+	return numBytes == sizeof(dummy);
+}
+
+/*
+ * Returns the received socket or -1 on EOF or error
+ */
+static int receiveSocket(int socket)
+{
+	char dummy = 0;
+	iovec data{&dummy, sizeof(dummy)};
+	std::array<char, CMSG_SPACE(sizeof(int))> control{};
+	msghdr message{};
+	message.msg_iov = &data;
+	message.msg_iovlen = 1;
+	message.msg_control = control.data();
+	message.msg_controllen = control.size();
+	ssize_t numBytes;
+	do
+	{
+		numBytes = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+	} while(numBytes < 0 && errno == EINTR);
+	cmsghdr* header = numBytes > 0 ? CMSG_FIRSTHDR(&message) : nullptr;
+	if(header == nullptr || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+		return -1;
+	int fd = -1;
+	std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+	return fd;
+}
+
+/*
+ * The front-end processes the helper started in advance, each waiting for the input of the next request running the same command.
+ *
+ * The front-end programs (e.g. clang, llvm-spirv) provide no mode to compile several inputs, so a process can only be used for a single request.
+ * But by starting the process for the next request while the current one is handled, the next request skips the creation of the process,
+ * the loading of the program and its libraries and the initialization of the program done before the input is read.
+ */
+class ResidentProcesses : private NonCopyable
+{
+public:
+	/*
+	 * Returns the process started for the given command, if any
+	 */
+	std::unique_ptr<ChildProcess> take(const std::string& command, uint8_t flags)
+	{
+		std::unique_ptr<ChildProcess> child;
+		{
+#ifdef MULTI_THREADED
+			std::lock_guard<std::mutex> guard(lock);
+#endif
+			auto it = processes.find(toKey(command, flags));
+			if(it == processes.end())
+				return nullptr;
+			child = std::move(it->second);
+			processes.erase(it);
+		}
+		int exitStatus = 0;
+		if(isChildFinished(child->pid, &exitStatus))
+		{
+			//the process died while waiting, e.g. was killed
+			child->pid = -1;
+			return nullptr;
+		}
+		return child;
+	}
+
+	/*
+	 * Starts the process for the next request running the given command, if there is none yet
+	 */
+	void prepare(const std::string& command, uint8_t flags)
+	{
+		const std::string key = toKey(command, flags);
+		{
+#ifdef MULTI_THREADED
+			std::lock_guard<std::mutex> guard(lock);
+#endif
+			if(processes.find(key) != processes.end())
+				return;
+		}
+		std::unique_ptr<ChildProcess> child(new ChildProcess());
+		startProcess(command, *child, (flags & HELPER_HAS_STDIN) != 0, (flags & HELPER_HAS_STDOUT) != 0, (flags & HELPER_HAS_STDERR) != 0);
+#ifdef MULTI_THREADED
+		std::lock_guard<std::mutex> guard(lock);
+#endif
+		if(processes.find(key) != processes.end())
+			//a concurrent request already started a process for this command, the new one is killed
+			return;
+		if(processes.size() >= MAX_RESIDENT_PROCESSES)
+			processes.erase(processes.begin());
+		processes.emplace(key, std::move(child));
+	}
+
+private:
+#ifdef MULTI_THREADED
+	std::mutex lock;
+#endif
+	std::map<std::string, std::unique_ptr<ChildProcess>> processes;
+
+	static std::string toKey(const std::string& command, uint8_t flags)
+	{
+		return std::string(1, static_cast<char>(flags & (HELPER_HAS_STDIN | HELPER_HAS_STDOUT | HELPER_HAS_STDERR))).append(command);
+	}
+};
+
+static void handleHelperRequest(int socket, ResidentProcesses& residentProcesses)
+{
+	std::string command;
+	std::string input;
+	uint8_t flags = 0;
+	if(readString(socket, command) && readAll(socket, &flags, sizeof(flags)) && readString(socket, input))
+	{
+		std::istringstream in(input);
+		std::ostringstream out;
+		std::ostringstream err;
+		int32_t status;
+		try
+		{
+			std::unique_ptr<ChildProcess> child;
+			if(flags & HELPER_KEEP_RESIDENT)
+			{
+				child = residentProcesses.take(command, flags);
+				//start the process for the next request, before this request is handled
+				residentProcesses.prepare(command, flags);
+			}
+			if(!child)
+			{
+				child.reset(new ChildProcess());
+				startProcess(command, *child, (flags & HELPER_HAS_STDIN) != 0, (flags & HELPER_HAS_STDOUT) != 0, (flags & HELPER_HAS_STDERR) != 0);
+			}
+			status = communicate(*child, (flags & HELPER_HAS_STDIN) ? &in : nullptr, (flags & HELPER_HAS_STDOUT) ? &out : nullptr, (flags & HELPER_HAS_STDERR) ? &err : nullptr);
+		}
+		catch(const std::exception& e)
+		{
+			err << e.what();
+			status = -1;
+		}
+		if(writeAll(socket, &status, sizeof(status)) && writeString(socket, out.str()))
+			writeString(socket, err.str());
+	}
+	close(socket);
+}
+
+static void runHelperLoop(int socket)
+{
+	//writing into a pre-started process which died must not terminate the helper
+	signal(SIGPIPE, SIG_IGN);
+	ResidentProcesses residentProcesses;
+#ifdef MULTI_THREADED
+	std::mutex lock;
+	std::condition_variable requestFinished;
+	std::size_t numActiveRequests = 0;
+#endif
+	//the helper runs until the compiler process closes the socket
+	int requestSocket;
+	while((requestSocket = receiveSocket(socket)) >= 0)
+	{
+#ifdef MULTI_THREADED
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			++numActiveRequests;
+		}
+		std::thread([requestSocket, &residentProcesses, &lock, &requestFinished, &numActiveRequests]() -> void
+		{
+			handleHelperRequest(requestSocket, residentProcesses);
+			std::lock_guard<std::mutex> guard(lock);
+			--numActiveRequests;
+			requestFinished.notify_all();
+		}).detach();
+#else
+		handleHelperRequest(requestSocket, residentProcesses);
+#endif
+	}
+	close(socket);
+#ifdef MULTI_THREADED
+	std::unique_lock<std::mutex> guard(lock);
+	requestFinished.wait(guard, [&numActiveRequests]() -> bool { return numActiveRequests == 0;});
+#endif
+	//the pre-started processes are killed on destruction
+}
+
+void helper::startProcessHelper()
+{
+#ifdef MULTI_THREADED
+	std::lock_guard<std::mutex> guard(processHelper.lock);
+#endif
+	if(processHelper.socket >= 0)
+		return;
+	std::array<int, 2> sockets{};
+	if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) != 0)
+		throw CompilationError(CompilationStep::GENERAL, "Error creating socket for process helper", strerror(errno));
+	pid_t pid = fork();
+	if(pid < 0)
+	{
+		const int error = errno;
+		close(sockets[0]);
+		close(sockets[1]);
+		throw CompilationError(CompilationStep::GENERAL, "Error forking process helper", strerror(error));
+	}
+	if(pid == 0) //child
+	{
+		close(sockets[0]);
+		runHelperLoop(sockets[1]);
+		//don't run any destructors/exit-handlers of the compiler process
+		_exit(0);
+	}
+	close(sockets[1]);
+	processHelper.pid = pid;
+	processHelper.socket = sockets[0];
+	logging::debug() << "Started process helper with PID " << pid << logging::endl;
+}
+
+bool helper::isProcessHelperRunning()
+{
+#ifdef MULTI_THREADED
+	std::lock_guard<std::mutex> guard(processHelper.lock);
+#endif
+	return processHelper.socket >= 0;
+}
+
+int helper::runProcessInHelper(const std::string& command, std::istream* stdin, std::ostream* stdout, std::ostream* stderr, bool keepResident)
+{
+	PROFILE_START(RunInProcessHelper);
+	const std::string input = stdin == nullptr ? std::string() : std::string(std::istreambuf_iterator<char>(*stdin), {});
+	const uint8_t flags = static_cast<uint8_t>((stdin != nullptr ? HELPER_HAS_STDIN : 0) | (stdout != nullptr ? HELPER_HAS_STDOUT : 0) | (stderr != nullptr ? HELPER_HAS_STDERR : 0) |
+			(keepResident ? HELPER_KEEP_RESIDENT : 0));
+	int32_t status = -1;
+	std::string out;
+	std::string err;
+	int error = 0;
+
+	//every request is exchanged via its own socket, so the lock is only held to pass this socket to the helper
+	std::array<int, 2> sockets{};
+	bool success = socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) == 0;
+	if(!success)
+		error = errno;
+	else
+	{
+		{
+#ifdef MULTI_THREADED
+			std::lock_guard<std::mutex> guard(processHelper.lock);
+#endif
+			if(processHelper.socket < 0)
+			{
+				close(sockets[0]);
+				close(sockets[1]);
+				throw CompilationError(CompilationStep::GENERAL, "Process helper is not running", command);
+			}
+			success = sendSocket(processHelper.socket, sockets[1]);
+			if(!success)
+			{
+				//the helper is no longer usable, run all following processes directly
+				error = errno;
+				processHelper.stop();
+			}
+		}
+		close(sockets[1]);
+		if(success)
+		{
+			success = writeString(sockets[0], command) && writeAll(sockets[0], &flags, sizeof(flags)) && writeString(sockets[0], input) &&
+					readAll(sockets[0], &status, sizeof(status)) && readString(sockets[0], out) && readString(sockets[0], err);
+			if(!success)
+				error = errno;
+		}
+		close(sockets[0]);
+	}
+	if(!success)
+	{
+		logging::warn() << "Error communicating with process helper, running command directly: " << strerror(error) << logging::endl;
+		std::istringstream in(input);
+		PROFILE_END(RunInProcessHelper);
+		return runProcess(command, stdin == nullptr ? nullptr : &in, stdout, stderr);
+	}
+	if(stdout != nullptr)
+		stdout->write(out.data(), static_cast<std::streamsize>(out.size()));
+	if(stderr != nullptr)
+		stderr->write(err.data(), static_cast<std::streamsize>(err.size()));
+	PROFILE_END(RunInProcessHelper);
+	return status;
 }
@@ -17,6 +17,41 @@ namespace vc4c
 	 */
 	int runProcess(const std::string& command, std::istream* stdin = nullptr, std::ostream* stdout = nullptr, std::ostream* stderr = nullptr);
 
+	/*
+	 * Long-living helper process to run the front-end programs (e.g. clang, llvm-spirv) in.
+	 *
+	 * The helper is forked once (while the compiler process is still small and single-threaded) and then receives the commands and input data
+	 * over a socket, spawns the programs itself and sends back their exit status and output.
+	 * This saves the compiler process from being forked (copying its whole address space and all of its threads' state) for every pre-compilation.
+	 * Once the helper is running, all pre-compiler programs are run via the helper. Concurrent requests are handled concurrently by the helper.
+	 *
+	 * Since the front-end programs can only process a single input per process, the helper keeps a warm front-end by starting the process
+	 * for the next request with the same command in advance. This process has already been loaded and initialized and waits for its input,
+	 * when the next request arrives.
+	 */
+	namespace helper
+	{
+		/*
+		 * Starts the helper process, if it is not yet running.
+		 *
+		 * Since the helper is forked from the current process, this needs to be called while the process is still single-threaded,
+		 * e.g. at the start of the program or while initializing the library using the compiler.
+		 * The helper is never started implicitly.
+		 */
+		void startProcessHelper();
+		/*
+		 * Whether the helper process has been started and is still available
+		 */
+		bool isProcessHelperRunning();
+		/*
+		 * Runs the command within the helper process, behaves like #runProcess
+		 *
+		 * If keepResident is set, the helper starts a process for the next request running the same command in advance.
+		 * This is only useful for commands which do not contain any arguments specific to a single request (e.g. temporary files).
+		 */
+		int runProcessInHelper(const std::string& command, std::istream* stdin = nullptr, std::ostream* stdout = nullptr, std::ostream* stderr = nullptr, bool keepResident = false);
+	} // namespace helper
+
 } /* namespace vc4c */
 
 #endif /* PROCESSUTIL_H */
@@ -9,10 +9,16 @@
 #include "CompilationError.h"
 #include "helper.h"
 
+#include <atomic>
 #include <cstdlib>
+#include <deque>
 #include <limits>
 #include <stdexcept>
 
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
+
 using namespace vc4c;
 
 ComplexType::~ComplexType()
@@ -20,6 +26,134 @@ ComplexType::~ComplexType()
 
 }
 
+/*
+ * The table of interned type-names, an open-addressing hash-set of pointers to the names.
+ *
+ * Slots are only ever filled (and never cleared) and a full table is replaced by a larger copy, which is published only after it is completely filled.
+ * So looking up an already interned name reads the slots without taking the lock, only inserting a new name is synchronized.
+ */
+class TypeNameTable
+{
+public:
+	TypeNameTable() : numNames(0)
+	{
+		tables.emplace_back(new Slots(256));
+		current.store(tables.back().get(), std::memory_order_release);
+	}
+
+	const std::string* intern(const std::string& name)
+	{
+		const std::size_t hash = std::hash<std::string>()(name);
+		if(const std::string* existing = find(*current.load(std::memory_order_acquire), name, hash))
+			return existing;
+#ifdef MULTI_THREADED
+		std::lock_guard<std::mutex> guard(lock);
+#endif
+		Slots* slots = current.load(std::memory_order_relaxed);
+		//the name might have been inserted concurrently
+		if(const std::string* existing = find(*slots, name, hash))
+			return existing;
+		if((numNames + 1) * 2 > slots->size())
+			slots = grow(*slots);
+		//the elements of a deque are never moved when appending, so the pointers stay valid
+		names.emplace_back(name);
+		insert(*slots, &names.back(), hash);
+		++numNames;
+		return &names.back();
+	}
+
+private:
+	using Slots = std::vector<std::atomic<const std::string*>>;
+
+	//all tables ever used, since concurrent look-ups might still read a replaced one
+	std::vector<std::unique_ptr<Slots>> tables;
+	std::atomic<Slots*> current;
+	std::deque<std::string> names;
+	std::size_t numNames;
+#ifdef MULTI_THREADED
+	std::mutex lock;
+#endif
+
+	static const std::string* find(const Slots& slots, const std::string& name, std::size_t hash)
+	{
+		for(std::size_t index = hash & (slots.size() - 1); ; index = (index + 1) & (slots.size() - 1))
+		{
+			const std::string* entry = slots[index].load(std::memory_order_acquire);
+			if(entry == nullptr || *entry == name)
+				return entry;
+		}
+	}
+
+	static void insert(Slots& slots, const std::string* name, std::size_t hash)
+	{
+		std::size_t index = hash & (slots.size() - 1);
+		while(slots[index].load(std::memory_order_relaxed) != nullptr)
+			index = (index + 1) & (slots.size() - 1);
+		slots[index].store(name, std::memory_order_release);
+	}
+
+	Slots* grow(const Slots& slots)
+	{
+		tables.emplace_back(new Slots(slots.size() * 2));
+		Slots* newSlots = tables.back().get();
+		for(const auto& entry : slots)
+		{
+			const std::string* name = entry.load(std::memory_order_relaxed);
+			if(name != nullptr)
+				insert(*newSlots, name, std::hash<std::string>()(*name));
+		}
+		current.store(newSlots, std::memory_order_release);
+		return newSlots;
+	}
+};
+
+static const std::string* internTypeName(const std::string& name)
+{
+	//function-local static, since type-names are already created during static initialization (e.g. TYPE_INT32)
+	static TypeNameTable typeNames;
+	return typeNames.intern(name);
+}
+
+TypeName::TypeName(const std::string& name) : name(internTypeName(name))
+{
+
+}
+
+TypeName::TypeName(const char* name) : name(internTypeName(name))
+{
+
+}
+
+static const TypeName& floatName()
+{
+	static const TypeName name("float");
+	return name;
+}
+
+static const TypeName& doubleName()
+{
+	static const TypeName name("double");
+	return name;
+}
+
+static const TypeName& halfName()
+{
+	static const TypeName name("half");
+	return name;
+}
+
+static const TypeName& voidName()
+{
+	static const TypeName name("void");
+	return name;
+}
+
+static const TypeName& boolName()
+{
+	static const TypeName name("bool");
+	return name;
+}
+
 DataType::DataType(const std::string& name, const unsigned char num, const std::shared_ptr<ComplexType>& complexType) :
     typeName(name), num(num), complexType(complexType)
 {
@@ -31,8 +165,8 @@ std::string DataType::to_string() const
     const std::string braceLeft = isVectorType() ? "<" : "";
     const std::string braceRight = isVectorType() ? ">" : "";
     if(num > 1)
-        return braceLeft + (std::to_string(num) + " x ") + (typeName + braceRight);
-    return typeName;
+        return braceLeft + (std::to_string(num) + " x ") + (typeName.str() + braceRight);
+    return typeName.str();
 }
 
 static std::string toSignedTypeName(const std::string& typeName)
@@ -65,7 +199,7 @@ std::string DataType::getTypeName(bool isSigned, bool isUnsigned) const
 {
 	if(complexType != nullptr || (!isFloatingType() && !isSigned && !isUnsigned))
 		return to_string();
-	const std::string tName = isSigned ? toSignedTypeName(typeName) : isUnsigned ? toUnsignedTypeName(typeName) : typeName;
+	const std::string tName = isSigned ? toSignedTypeName(typeName) : isUnsigned ? toUnsignedTypeName(typeName) : typeName.str();
 	if(num > 1)
 		return tName + std::to_string(num);
 	return tName;
@@ -75,7 +209,9 @@ bool DataType::operator==(const DataType& right) const
 {
 	if(this == &right)
 		return true;
-    return typeName.compare(right.typeName) == 0 && num == right.num && (complexType == nullptr) == (right.complexType == nullptr) && (complexType != nullptr ? (*complexType.get()) == (*right.complexType.get()) : true);
+    //the type-names are interned, so comparing them is a simple pointer-comparison
+    return typeName == right.typeName && num == right.num && (complexType == nullptr) == (right.complexType == nullptr) &&
+    		(complexType == right.complexType || (complexType != nullptr ? (*complexType.get()) == (*right.complexType.get()) : true));
 }
 
 bool DataType::operator<(const DataType& other) const
@@ -135,14 +271,14 @@ bool DataType::isFloatingType() const
 {
 	if(complexType)
 		return false;
-    return typeName == "float" || typeName == "double" || typeName == "half";
+    return typeName == floatName() || typeName == doubleName() || typeName == halfName();
 }
 
 bool DataType::isIntegralType() const
 {
 	if(isPointerType())
 		return true;
-	return !complexType && (typeName.at(0) == 'i' || typeName == TYPE_BOOL.typeName);
+	return !complexType && (typeName.at(0) == 'i' || typeName == boolName());
 }
 
 bool DataType::isUnknown() const
@@ -179,7 +315,10 @@ const DataType DataType::toVectorType(unsigned char vectorWidth) const
 		throw CompilationError(CompilationStep::GENERAL, "Invalid width for SIMD vector", std::to_string(static_cast<unsigned>(vectorWidth)));
 	if(num == vectorWidth)
 		return *this;
-	return DataType(typeName, vectorWidth, complexType);
+	//copy the already interned type-name instead of looking it up again
+	DataType result(*this);
+	result.num = vectorWidth;
+	return result;
 }
 
 bool DataType::containsType(const DataType& other) const
@@ -208,7 +347,9 @@ const DataType DataType::getUnionType(const DataType& other) const
 		throw CompilationError(CompilationStep::GENERAL, "Can't form union type of distinct complex types!");
 	if(isFloatingType() != other.isFloatingType())
 		throw CompilationError(CompilationStep::GENERAL, "Can't form union type of floating-point and integer types!");
-	return DataType(getScalarBitCount() > other.getScalarBitCount() ? typeName : other.typeName, std::max(num, other.num));
+	DataType result(getScalarBitCount() > other.getScalarBitCount() ? *this : other);
+	result.num = std::max(num, other.num);
+	return result;
 }
 
 unsigned char DataType::getScalarBitCount() const
@@ -223,16 +364,16 @@ unsigned char DataType::getScalarBitCount() const
 		throw CompilationError(CompilationStep::GENERAL, "Can't get bit-width of complex type", to_string());
     if(typeName[0] == 'i')
     {
-        int bitCount = atoi(typeName.substr(1).data());
+        int bitCount = atoi(typeName.str().data() + 1);
         return static_cast<unsigned char>(bitCount);
     }
-    if(typeName.compare("half") == 0)
+    if(typeName == halfName())
     	//16-bit floating point type
     	return 16;
-    if(typeName.compare("double") == 0)
+    if(typeName == doubleName())
     	//64-bit floating point type
     	return 64;
-    if(typeName.compare("void") == 0)
+    if(typeName == voidName())
     	//single byte
     	return 8;
     return 32;
@@ -282,10 +423,10 @@ unsigned DataType::getAlignmentInBytes() const
 
 std::size_t vc4c::hash<DataType>::operator()(const DataType& type) const noexcept
 {
-	const std::hash<std::string> nameHash;
-	const std::hash<std::shared_ptr<ComplexType>> complexHash;
+	//the complex-type is not hashed, since it is compared by content in DataType::operator==
+	const std::hash<const std::string*> nameHash;
 	const std::hash<unsigned char> numHash;
-	return nameHash(type.typeName) ^ complexHash(type.complexType) ^ numHash(type.num);
+	return nameHash(type.typeName.get()) ^ numHash(type.num);
 }
 
 PointerType::PointerType(const DataType& elementType, const AddressSpace addressSpace, unsigned alignment) : elementType(elementType), addressSpace(addressSpace), alignment(alignment)
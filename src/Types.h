@@ -41,14 +41,88 @@ namespace vc4c
 	struct StructType;
 	struct ImageType;
 
+	/*
+	 * Handle to a type-name interned in a process-wide table.
+	 *
+	 * All type-names with the same content share the same table entry, so copying a type-name does not allocate
+	 * and comparing two type-names for equality is a single pointer comparison.
+	 * Creating a type-name which is already interned does not take a lock, only adding a new name to the table does.
+	 *
+	 * NOTE: The table is process-wide (and not per Module), since the pre-defined types (TYPE_INT32, ...) are shared by all modules.
+	 * The table never shrinks, so it grows with the distinct type-names (e.g. of structs) of all modules compiled by the process.
+	 */
+	class TypeName
+	{
+	public:
+		TypeName(const std::string& name = "");
+		TypeName(const char* name);
+
+		inline operator const std::string&() const
+		{
+			return *name;
+		}
+
+		inline const std::string& str() const
+		{
+			return *name;
+		}
+
+		inline bool operator==(const TypeName& other) const
+		{
+			return name == other.name;
+		}
+
+		inline bool operator!=(const TypeName& other) const
+		{
+			return name != other.name;
+		}
+
+		inline bool operator<(const TypeName& other) const
+		{
+			return *name < *other.name;
+		}
+
+		inline bool empty() const
+		{
+			return name->empty();
+		}
+
+		inline char operator[](std::size_t index) const
+		{
+			return (*name)[index];
+		}
+
+		inline char at(std::size_t index) const
+		{
+			return name->at(index);
+		}
+
+		inline char back() const
+		{
+			return name->back();
+		}
+
+		/*
+		 * Returns the unique interned string, can be used for hashing
+		 */
+		inline const std::string* get() const
+		{
+			return name;
+		}
+
+	private:
+		const std::string* name;
+	};
+
 	/*
 	 * Basic data-type class.
 	 *
 	 * Each value contains its own DataType object. Values of the same type share "equal" DataType objects.
+	 * Since the type-name is interned, copying and comparing DataTypes does not allocate or compare strings.
 	 */
 	struct DataType
 	{
-		std::string typeName;
+		TypeName typeName;
 		//the number of elements for vector-types
 		unsigned char num;
 		std::shared_ptr<ComplexType> complexType;
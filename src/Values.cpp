@@ -535,22 +535,21 @@ bool Value::operator==(const Value& other) const
 		return true;
     if(valueType != other.valueType)
         return false;
-    if(type != other.type)
-        return false;
+    //compare the (cheap) contents first, and only then the types, which requires string-comparisons
     switch(valueType)
     {
     case ValueType::CONTAINER:
-        return container.elements == other.container.elements;
+        return type == other.type && container.elements == other.container.elements;
     case ValueType::LITERAL:
-        return other.hasLiteral(literal);
+        return other.hasLiteral(literal) && type == other.type;
     case ValueType::LOCAL:
-        return local == other.local;
+        return local == other.local && type == other.type;
     case ValueType::REGISTER:
-        return reg == other.reg;
+        return reg == other.reg && type == other.type;
     case ValueType::UNDEFINED:
-        return true;
+        return type == other.type;
     case ValueType::SMALL_IMMEDIATE:
-    	return other.hasImmediate(immediate);
+    	return other.hasImmediate(immediate) && type == other.type;
     }
     throw CompilationError(CompilationStep::GENERAL, "Unhandled value-type!");
 }
@@ -760,5 +759,32 @@ Value Value::createZeroInitializer(const DataType& type)
 
 std::size_t vc4c::hash<vc4c::Value>::operator()(vc4c::Value const& val) const noexcept
 {
-	return std::hash<std::string>::operator()(val.to_string());
+	//structural hash, must be consistent with Value::operator==, so only the parts compared there are hashed.
+	//Especially, the complex-type of the data-type is not hashed, since it is compared by content, not pointer
+	const std::size_t typeHash = std::hash<const std::string*>{}(val.type.typeName.get()) ^ (static_cast<std::size_t>(val.type.num) << 8);
+	std::size_t contentHash = 0;
+	switch(val.valueType)
+	{
+		case ValueType::LITERAL:
+			contentHash = std::hash<uint32_t>{}(val.literal.unsignedInt());
+			break;
+		case ValueType::REGISTER:
+			contentHash = hash<Register>{}(val.reg);
+			break;
+		case ValueType::LOCAL:
+			contentHash = std::hash<const Local*>{}(val.local);
+			break;
+		case ValueType::SMALL_IMMEDIATE:
+			contentHash = std::hash<unsigned char>{}(val.immediate.value);
+			break;
+		case ValueType::CONTAINER:
+			contentHash = val.container.elements.size();
+			for(const Value& element : val.container.elements)
+				//taken from boost::hash_combine
+				contentHash ^= operator()(element) + 0x9e3779b9 + (contentHash << 6) + (contentHash >> 2);
+			break;
+		case ValueType::UNDEFINED:
+			break;
+	}
+	return (typeHash * 31 + static_cast<std::size_t>(val.valueType)) ^ contentHash;
 }
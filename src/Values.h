@@ -742,8 +742,13 @@ namespace vc4c
 	 */
 	const Value ROTATION_REGISTER(REG_ACC5, TYPE_INT8);
 
+	/*
+	 * Structural hash over the value-type, the data-type and the literal/register/local/immediate contained.
+	 *
+	 * This is allocation-free and consistent with Value::operator==
+	 */
 	template<>
-	struct hash<Value> : public std::hash<std::string>
+	struct hash<Value>
 	{
 		size_t operator()(const Value& val) const noexcept;
 	};
@@ -0,0 +1,194 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#include "LivenessAnalysis.h"
+
+#include "../Profiler.h"
+
+#include <algorithm>
+
+using namespace vc4c;
+using namespace vc4c::analysis;
+
+LocalSet::LocalSet(const std::size_t numLocals) : words((numLocals + 63) / 64, 0)
+{
+}
+
+bool LocalSet::insertAll(const LocalSet& other)
+{
+	bool changed = false;
+	for(std::size_t i = 0; i < words.size(); ++i)
+	{
+		const uint64_t tmp = words[i] | other.words[i];
+		changed = changed || tmp != words[i];
+		words[i] = tmp;
+	}
+	return changed;
+}
+
+void LocalSet::eraseAll(const LocalSet& other)
+{
+	for(std::size_t i = 0; i < words.size(); ++i)
+		words[i] &= ~other.words[i];
+}
+
+LivenessAnalysis::LivenessAnalysis(Method& method, ControlFlowGraph& cfg, const FastMap<const Local*, std::size_t>& localIndices) :
+		method(method), localIndices(&localIndices), numLocals(localIndices.size())
+{
+	analyze(method, cfg);
+}
+
+LivenessAnalysis::LivenessAnalysis(Method& method, ControlFlowGraph& cfg) :
+		method(method), localIndices(nullptr), numLocals(method.readLocals().size() + method.parameters.size())
+{
+	analyze(method, cfg);
+}
+
+Optional<std::size_t> LivenessAnalysis::getIndex(const Local* local) const
+{
+	if(localIndices != nullptr)
+	{
+		auto indexIt = localIndices->find(local);
+		if(indexIt == localIndices->end())
+			return {};
+		return indexIt->second;
+	}
+	if(local->getLocalIndex())
+		return local->getLocalIndex();
+	if(local->is<Parameter>() && !method.parameters.empty())
+	{
+		//the parameters are stored consecutively, so the position can be calculated directly
+		const Parameter* param = local->as<Parameter>();
+		if(param >= method.parameters.data() && param < method.parameters.data() + method.parameters.size())
+			return method.readLocals().size() + static_cast<std::size_t>(param - method.parameters.data());
+	}
+	return {};
+}
+
+std::size_t LivenessAnalysis::getNumLocals() const
+{
+	return numLocals;
+}
+
+void LivenessAnalysis::analyze(Method& method, ControlFlowGraph& cfg)
+{
+	PROFILE_START(LivenessAnalysis);
+	blocks.reserve(cfg.size());
+	for(BasicBlock& block : method)
+	{
+		BlockLiveness& entry = blocks.emplace(&block, BlockLiveness{LocalSet(numLocals), LocalSet(numLocals), LocalSet(numLocals), LocalSet(numLocals)}).first->second;
+		walkBlockBackwards(block, entry.uses, &entry.kills, [](std::size_t, const LocalSet&) -> void {});
+		entry.liveIn = entry.uses;
+	}
+
+	//process the blocks in reverse order, so most live-ranges are propagated in the first iteration
+	std::vector<BasicBlock*> worklist;
+	FastSet<BasicBlock*> queuedBlocks;
+	worklist.reserve(blocks.size());
+	queuedBlocks.reserve(blocks.size());
+	for(BasicBlock& block : method)
+	{
+		worklist.push_back(&block);
+		queuedBlocks.insert(&block);
+	}
+	std::size_t numIterations = 0;
+	while(!worklist.empty())
+	{
+		BasicBlock* block = worklist.back();
+		worklist.pop_back();
+		queuedBlocks.erase(block);
+		++numIterations;
+		BlockLiveness& entry = blocks.at(block);
+		const CFGNode* node = cfg.find(block) != cfg.end() ? &cfg.at(block) : nullptr;
+		if(node != nullptr)
+		{
+			node->forAllNeighbors(toFunction(&CFGRelation::isForwardRelation), [&entry, this](const CFGNode* successor, const CFGRelation& rel) -> void
+			{
+				entry.liveOut.insertAll(blocks.at(successor->key).liveIn);
+			});
+		}
+		LocalSet liveIn = entry.liveOut;
+		liveIn.eraseAll(entry.kills);
+		liveIn.insertAll(entry.uses);
+		if(!entry.liveIn.insertAll(liveIn) || node == nullptr)
+			continue;
+		node->forAllNeighbors(toFunction(&CFGRelation::isReverseRelation), [&worklist, &queuedBlocks](const CFGNode* predecessor, const CFGRelation& rel) -> void
+		{
+			if(queuedBlocks.emplace(predecessor->key).second)
+				worklist.push_back(predecessor->key);
+		});
+	}
+	PROFILE_COUNTER(1000003, "Liveness iterations", numIterations);
+	PROFILE_END(LivenessAnalysis);
+}
+
+const LocalSet& LivenessAnalysis::getLiveIn(const BasicBlock* block) const
+{
+	return blocks.at(block).liveIn;
+}
+
+const LocalSet& LivenessAnalysis::getLiveOut(const BasicBlock* block) const
+{
+	return blocks.at(block).liveOut;
+}
+
+void LivenessAnalysis::walkBlockBackwards(BasicBlock& block, LocalSet& live, const std::function<void(std::size_t, const LocalSet&)>& onWrite) const
+{
+	walkBlockBackwards(block, live, nullptr, onWrite);
+}
+
+void LivenessAnalysis::walkBlockBackwards(BasicBlock& block, LocalSet& live, LocalSet* kills, const std::function<void(std::size_t, const LocalSet&)>& onWrite) const
+{
+	FastMap<const Local*, ConditionCode> conditionalWrites;
+	InstructionWalker it = block.end();
+	while(!it.isStartOfBlock())
+	{
+		it.previousInBlock();
+		if(it.get() == nullptr || it.has<intermediate::BranchLabel>() || it.has<intermediate::Branch>())
+			continue;
+		FastSet<const Local*> killedLocals;
+		it.forAllInstructions([&](const intermediate::IntermediateInstruction* inst) -> void
+		{
+			if(inst == nullptr || !inst->hasValueType(ValueType::LOCAL))
+				return;
+			const Local* local = inst->getOutput()->local;
+			const Optional<std::size_t> index = getIndex(local);
+			if(!index)
+				return;
+			onWrite(index.value(), live);
+			if(inst->hasDecoration(intermediate::InstructionDecorations::ELEMENT_INSERTION))
+				return;
+			if(inst->conditional == COND_ALWAYS || inst->hasDecoration(intermediate::InstructionDecorations::PHI_NODE))
+				killedLocals.emplace(local);
+			else
+			{
+				auto condIt = conditionalWrites.find(local);
+				if(condIt != conditionalWrites.end() && inst->conditional.isInversionOf(condIt->second))
+					killedLocals.emplace(local);
+				else if(condIt == conditionalWrites.end())
+					conditionalWrites.emplace(local, inst->conditional);
+			}
+		});
+		for(const Local* local : killedLocals)
+		{
+			const std::size_t index = getIndex(local).value();
+			live.erase(index);
+			if(kills != nullptr)
+				kills->insert(index);
+			conditionalWrites.erase(local);
+		}
+		it->forUsedLocals([&](const Local* local, const LocalUse::Type type) -> void
+		{
+			const Optional<std::size_t> index = getIndex(local);
+			if(index && has_flag(type, LocalUse::Type::READER))
+			{
+				live.insert(index.value());
+				//any conditional write after this read does not belong to the writes before
+				conditionalWrites.erase(local);
+			}
+		});
+	}
+}
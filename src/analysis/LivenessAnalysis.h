@@ -0,0 +1,143 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#ifndef VC4C_LIVENESS_ANALYSIS_H
+#define VC4C_LIVENESS_ANALYSIS_H
+
+#include "ControlFlowGraph.h"
+
+#include <functional>
+#include <vector>
+
+namespace vc4c
+{
+	namespace analysis
+	{
+		/*
+		 * Dense set of locals, addressed by the index of the local in the list of all locals taking part in the analysis
+		 */
+		class LocalSet
+		{
+		public:
+			explicit LocalSet(std::size_t numLocals = 0);
+
+			inline void insert(const std::size_t index)
+			{
+				words[index / 64] |= uint64_t{1} << (index % 64);
+			}
+
+			inline void erase(const std::size_t index)
+			{
+				words[index / 64] &= ~(uint64_t{1} << (index % 64));
+			}
+
+			inline bool contains(const std::size_t index) const
+			{
+				return (words[index / 64] & (uint64_t{1} << (index % 64))) != 0;
+			}
+
+			/*
+			 * Returns the number of locals in this set
+			 */
+			inline std::size_t size() const
+			{
+				std::size_t numLocals = 0;
+				for(const uint64_t word : words)
+					numLocals += static_cast<std::size_t>(__builtin_popcountll(word));
+				return numLocals;
+			}
+
+			/*
+			 * Adds all locals of the other set and returns whether any local was added
+			 */
+			bool insertAll(const LocalSet& other);
+			void eraseAll(const LocalSet& other);
+
+			/*
+			 * Executes the consumer for the index of every local in this set, in ascending order
+			 */
+			template<typename Func>
+			void forEach(const Func& consumer) const
+			{
+				for(std::size_t i = 0; i < words.size(); ++i)
+				{
+					uint64_t word = words[i];
+					while(word != 0)
+					{
+						consumer(i * 64 + static_cast<std::size_t>(__builtin_ctzll(word)));
+						//clears the lowest set bit
+						word &= word - 1;
+					}
+				}
+			}
+
+		private:
+			std::vector<uint64_t> words;
+		};
+
+		/*
+		 * Iterative backward data-flow analysis calculating the locals live at the start and end of every basic block.
+		 *
+		 * The locals taking part in the analysis are either given as a map to their dense indices or are all locals and parameters of the method,
+		 * all other locals are ignored.
+		 * A local is live at a point, if there is a path from this point to a read of the local without an intermediate write.
+		 * Conditional writes only end the live-range of a local, if they are combined with a write on the inverted condition within the same block or set a phi-node.
+		 */
+		class LivenessAnalysis
+		{
+		public:
+			LivenessAnalysis(Method& method, ControlFlowGraph& cfg, const FastMap<const Local*, std::size_t>& localIndices);
+			/*
+			 * Runs the analysis for all locals and parameters of the method.
+			 *
+			 * The index of a local is its local-index (see Local#getLocalIndex()), the parameters follow after all locals in their order within the method.
+			 * No locals may be added to or removed from the method while the analysis is used.
+			 */
+			LivenessAnalysis(Method& method, ControlFlowGraph& cfg);
+
+			/*
+			 * Returns the index of the local within the sets of live locals, if the local takes part in the analysis
+			 */
+			Optional<std::size_t> getIndex(const Local* local) const;
+			/*
+			 * Returns the number of locals taking part in the analysis, i.e. the size of the sets of live locals
+			 */
+			std::size_t getNumLocals() const;
+
+			const LocalSet& getLiveIn(const BasicBlock* block) const;
+			const LocalSet& getLiveOut(const BasicBlock* block) const;
+
+			/*
+			 * Walks the basic block backwards and updates the set of live locals (the locals live at the end of the block) to the locals live at the start of the block.
+			 *
+			 * For every write of a local, the consumer is called with the index of the written local and the locals live after the writing instruction.
+			 */
+			void walkBlockBackwards(BasicBlock& block, LocalSet& live, const std::function<void(std::size_t, const LocalSet&)>& onWrite) const;
+
+		private:
+			struct BlockLiveness
+			{
+				//the locals read in the block before they are (unconditionally) written
+				LocalSet uses;
+				//the locals (unconditionally) written in the block
+				LocalSet kills;
+				LocalSet liveIn;
+				LocalSet liveOut;
+			};
+
+			const Method& method;
+			//the explicit indices of the locals, or nullptr if the local-indices and the parameter positions are used
+			const FastMap<const Local*, std::size_t>* localIndices;
+			std::size_t numLocals;
+			FastMap<const BasicBlock*, BlockLiveness> blocks;
+
+			void analyze(Method& method, ControlFlowGraph& cfg);
+			void walkBlockBackwards(BasicBlock& block, LocalSet& live, LocalSet* kills, const std::function<void(std::size_t, const LocalSet&)>& onWrite) const;
+		};
+	} /* namespace analysis */
+} /* namespace vc4c */
+
+#endif /* VC4C_LIVENESS_ANALYSIS_H */
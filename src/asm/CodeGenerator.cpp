@@ -7,9 +7,12 @@
 #include "CodeGenerator.h"
 
 #include "../InstructionWalker.h"
+#include "../Instrumentation.h"
+#include "../optimization/MemoryAccess.h"
 #include "../Profiler.h"
 #include "GraphColoring.h"
 #include "KernelInfo.h"
+#include "LinearScan.h"
 #include "log.h"
 
 #include <climits>
@@ -74,21 +77,52 @@ const FastModificationList<std::unique_ptr<qpu_asm::Instruction>>& CodeGenerator
 
     //check and fix possible errors with register-association
     PROFILE_START(initializeLocalsUses);
-	GraphColoring coloring(method, method.walkAllInstructions());
+	std::unique_ptr<GraphColoring> coloring;
+	{
+		profiler::Instrumentation::Step step(module.instrumentation, "CreateInterferenceGraph", method);
+		coloring.reset(new GraphColoring(method, method.walkAllInstructions()));
+	}
 	PROFILE_END(initializeLocalsUses);
-	PROFILE_START(colorGraph);
-	std::size_t round = 0;
-	while(round < REGISTER_RESOLVER_MAX_ROUNDS && !coloring.colorGraph())
+	std::unique_ptr<LinearScanAllocator> linearScan;
+	if(config.registerAllocator == RegisterAllocator::LINEAR_SCAN)
 	{
-		if(coloring.fixErrors())
-			break;
-		++round;
+		PROFILE_START(linearScan);
+		profiler::Instrumentation::Step step(module.instrumentation, "LinearScan", method);
+		linearScan.reset(new LinearScanAllocator(method, coloring->getLocalUses()));
+		if(!linearScan->allocate())
+		{
+			logging::debug() << "Linear-scan register allocation failed, falling back to graph coloring" << logging::endl;
+			linearScan.reset();
+		}
+		PROFILE_END(linearScan);
 	}
-	if(round >= REGISTER_RESOLVER_MAX_ROUNDS)
+	if(!linearScan)
 	{
-		logging::warn() << "Register conflict resolver has exceeded its maximum rounds, there might still be errors!" << logging::endl;
+		PROFILE_START(colorGraph);
+		profiler::Instrumentation::Step step(module.instrumentation, "ColorGraph", method);
+		std::size_t spillRound = 0;
+		while(true)
+		{
+			std::size_t round = 0;
+			while(round < REGISTER_RESOLVER_MAX_ROUNDS && !coloring->colorGraph())
+			{
+				if(coloring->fixErrors())
+					break;
+				++round;
+			}
+			if(round < REGISTER_RESOLVER_MAX_ROUNDS)
+				break;
+			//the conflicts cannot be resolved by moving locals between register-files, so spill some locals and start over
+			if(spillRound >= REGISTER_SPILL_MAX_ROUNDS || !optimizations::spillLocalsToVPM(method, coloring->selectSpillCandidates()))
+			{
+				logging::warn() << "Register conflict resolver has exceeded its maximum rounds, there might still be errors!" << logging::endl;
+				break;
+			}
+			++spillRound;
+			coloring.reset(new GraphColoring(method, method.walkAllInstructions()));
+		}
+		PROFILE_END(colorGraph);
 	}
-	PROFILE_END(colorGraph);
 
     //create label-map + remove labels
     const auto labelMap = mapLabels(method);
@@ -96,10 +130,11 @@ const FastModificationList<std::unique_ptr<qpu_asm::Instruction>>& CodeGenerator
     //IMPORTANT: DO NOT OPTIMIZE, RE-ORDER, COMBINE, INSERT OR REMOVE ANY INSTRUCTION AFTER THIS POINT!!!
     //otherwise, labels/branches will be wrong
 
+    profiler::Instrumentation::Step step(module.instrumentation, "ConvertToMachineCode", method);
     //map to registers
     PROFILE_START(toRegisterMap);
 	PROFILE_START(toRegisterMapGraph);
-	auto registerMapping = coloring.toRegisterMap();
+	auto registerMapping = linearScan ? linearScan->toRegisterMap() : coloring->toRegisterMap();
 	PROFILE_END(toRegisterMapGraph);
 	PROFILE_END(toRegisterMap);
 
@@ -158,6 +193,8 @@ const FastModificationList<std::unique_ptr<qpu_asm::Instruction>>& CodeGenerator
     logging::debug() << "Generated " << std::dec << generatedInstructions.size() << " instructions!" << logging::endl;
 
     PROFILE_COUNTER_WITH_PREV(1001000, "CodeGeneration (after)", generatedInstructions.size(), 100000);
+    if(module.instrumentation != nullptr)
+    	module.instrumentation->addCounter(method, "Generated instructions", generatedInstructions.size());
     return generatedInstructions;
 }
 
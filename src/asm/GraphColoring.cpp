@@ -9,10 +9,13 @@
 #include "RegisterAllocation.h"
 #include "../analysis/ControlFlowGraph.h"
 #include "../analysis/DebugGraph.h"
+#include "../analysis/LivenessAnalysis.h"
+#include "../optimization/MemoryAccess.h"
 #include "../Profiler.h"
 #include "log.h"
 
 #include <algorithm>
+#include <limits>
 
 using namespace vc4c;
 using namespace vc4c::qpu_asm;
@@ -432,108 +435,8 @@ GraphColoring::GraphColoring(Method& method, InstructionWalker it) : method(meth
 	}
 }
 
-static void walkUsageRange(InstructionWalker start, const Local* local, FastMap<intermediate::IntermediateInstruction*, FastSet<const Local*>>& localRanges, ControlFlowGraph* blockGraph = nullptr)
-{
-	//to prevent infinite recursions
-	//TODO is tracking labels enough or need we track all instructions (or branches, since we jump backwards?)??
-	//FIXME this check is wrong, e.g. doesn't find reads, if <label1> ... <label2> x = a ... a = y; br <label1> (e.g. ./testing/rodinia/find_ellipse_kernel.cl, ./testing/rodinia/track_ellipse_kernel.cl, ./testing/NVIDIA/BlackScholes.cl)
-	FastSet<intermediate::IntermediateInstruction*> processedLabels;
-	ConditionCode conditionalWrite = COND_NEVER;
-	const auto consumer = [start, local, &localRanges, &processedLabels, &conditionalWrite](InstructionWalker& it) -> InstructionVisitResult
-	{
-		intermediate::BranchLabel* label = it.get<intermediate::BranchLabel>();
-		if(label != nullptr)
-		{
-			if(processedLabels.find(label) != processedLabels.end())
-				return InstructionVisitResult::STOP_BRANCH;
-			processedLabels.emplace(label);
-		}
-		if(it != start)
-		{
-			//don't set usage-range for last read to not block the written local
-			localRanges[it.get()].insert(local);
-			if(it->readsLocal(local))
-				//another reading found, abort here and continue for the other reading
-				return InstructionVisitResult::STOP_BRANCH;
-		}
-		if(it->writesLocal(local))
-		{
-			//we found a write, stop this branch (and continue with others)
-			//only abort if we have found writes for all conditions (e.g. required for vector insertions, or selects)
-			const std::function<InstructionVisitResult(const intermediate::IntermediateInstruction*)> checkWritePerInstruction = [start, &conditionalWrite, local](const intermediate::IntermediateInstruction* inst) -> InstructionVisitResult
-			{
-				//if start is a combined instruction
-				ConditionCode realStartCondition = start.get()->conditional;
-				if(start.get<const intermediate::CombinedOperation>() != nullptr)
-				{
-					const intermediate::CombinedOperation* comb = start.get<const intermediate::CombinedOperation>();
-					if(comb->op1 && comb->op1->readsLocal(local) && comb->op2 && comb->op2->readsLocal(local) && comb->op1->conditional.isInversionOf(comb->op2->conditional))
-						realStartCondition = COND_ALWAYS;
-					else if(comb->op1 && comb->op1->readsLocal(local))
-						realStartCondition = comb->op1->conditional;
-					else if(comb->op2 && comb->op2->readsLocal(local))
-						realStartCondition = comb->op2->conditional;
-					else //neither part reads the local
-						throw CompilationError(CompilationStep::CODE_GENERATION, "Combined operation reads local, but none of its part do", start->to_string());
-				}
-				if(!inst->writesLocal(local) || inst->hasDecoration(intermediate::InstructionDecorations::ELEMENT_INSERTION))
-					return InstructionVisitResult::CONTINUE;
-				if(inst->conditional == COND_ALWAYS || inst->conditional == realStartCondition || inst->conditional.isInversionOf(conditionalWrite))
-					conditionalWrite = COND_ALWAYS;
-				else if(conditionalWrite == COND_NEVER)
-					conditionalWrite = inst->conditional;
-				if(conditionalWrite == COND_ALWAYS)
-					return InstructionVisitResult::STOP_BRANCH;
-				//TODO to be exact, we would need a check here, if the condition of the PHI-value setter is the same as the branch-condition jumping to the target label
-				if(inst->hasDecoration(intermediate::InstructionDecorations::PHI_NODE))
-					//we found a (conditional) instruction setting this PHI-node value
-					return InstructionVisitResult::STOP_BRANCH;
-				return InstructionVisitResult::CONTINUE;
-			};
-			if(it.has<intermediate::CombinedOperation>())
-			{
-				intermediate::CombinedOperation* combined = it.get<intermediate::CombinedOperation>();
-				if(combined->op1 != nullptr)
-				{
-					InstructionVisitResult tmp = checkWritePerInstruction(combined->op1.get());
-					if(tmp == InstructionVisitResult::STOP_ALL || tmp == InstructionVisitResult::STOP_BRANCH)
-						return tmp;
-				}
-				if(combined->op2 != nullptr)
-				{
-					InstructionVisitResult tmp = checkWritePerInstruction(combined->op2.get());
-					if(tmp == InstructionVisitResult::STOP_ALL || tmp == InstructionVisitResult::STOP_BRANCH)
-						return tmp;
-				}
-			}
-			else
-			{
-				return checkWritePerInstruction(it.get());
-			}
-		}
-		if(it.isStartOfMethod() || (it.has<intermediate::BranchLabel>() && it.get<intermediate::BranchLabel>()->getLabel()->name.compare(BasicBlock::DEFAULT_BLOCK) == 0))
-		{
-			//we arrived at the beginning of the method with no write found -> abort
-			return InstructionVisitResult::STOP_ALL;
-		}
-		return InstructionVisitResult::CONTINUE;
-	};
-
-	InstructionVisitor visitor{consumer, false, true};
-	bool allFound = visitor.visitReverse(start, blockGraph);
-
-	if(!allFound)
-	{
-		logging::error() << "Found a path for local " << local->to_string() << " for which it isn't written before, starting at: " << start->to_string() << logging::endl;
-		throw CompilationError(CompilationStep::CODE_GENERATION, "Not all path generate a valid value for local", local->to_string());
-	}
-}
-
 void GraphColoring::createGraph()
 {
-	FastMap<intermediate::IntermediateInstruction*, FastSet<const Local*>> localRanges;
-	localRanges.reserve(method.countInstructions());
-
 	// 1. iteration: set files and locals used together and map to start/end of range
 	PROFILE_START(createColoredNodes);
 	for(const auto& pair : localUses)
@@ -570,47 +473,68 @@ void GraphColoring::createGraph()
 	}
 	PROFILE_END(createColoredNodes);
 
+	//assign every local taking part in the register-allocation a dense index for the liveness bit-sets
+	std::vector<const Local*> locals;
+	FastMap<const Local*, std::size_t> localIndices;
+	locals.reserve(graph.size());
+	localIndices.reserve(graph.size());
+	for(const auto& node : graph)
+	{
+		if(node.second.initialFile == RegisterFile::NONE)
+			continue;
+		localIndices.emplace(node.first, locals.size());
+		locals.push_back(node.first);
+	}
+
 	auto blockGraph = ControlFlowGraph::createCFG(method);
 
-	PROFILE_START(createUsageRanges);
-	InstructionWalker it = method.walkAllInstructions();
-	while(!it.isEndOfMethod())
+	const analysis::LivenessAnalysis liveness(method, blockGraph, localIndices);
+
+	//a local live at the start of the method is read on a path where it is never written
+	liveness.getLiveIn(&*method.begin()).forEach([&locals, this](std::size_t index) -> void
+	{
+		const Local* local = locals[index];
+		if(std::any_of(method.parameters.begin(), method.parameters.end(), [local](const Parameter& param) -> bool { return &param == local;}))
+			return;
+		//locals which are only partially written (single elements inserted or written conditionally) intentionally leave the remaining parts undefined
+		const auto writers = local->getUsers(LocalUse::Type::WRITER);
+		if(std::any_of(writers.begin(), writers.end(), [](const LocalUser* writer) -> bool
+		{
+			return writer->conditional != COND_ALWAYS || writer->hasDecoration(intermediate::InstructionDecorations::ELEMENT_INSERTION);
+		}))
+			return;
+		logging::error() << "Found a path for local " << local->to_string() << " for which it isn't written before" << logging::endl;
+		throw CompilationError(CompilationStep::CODE_GENERATION, "Not all path generate a valid value for local", local->to_string());
+	});
+
+	//2. iteration: every written local interferes with all locals live after the write
+	PROFILE_START(addEdges);
+	std::size_t numEdges = 0;
+	for(BasicBlock& block : method)
 	{
-		//from all reading instructions, walk up to the writes of the locals and add all instructions in between to the local usage-range
-		if(!it.has<intermediate::BranchLabel>() && !it.has<intermediate::Branch>())
+		analysis::LocalSet live = liveness.getLiveOut(&block);
+		liveness.walkBlockBackwards(block, live, [&locals, &numEdges, this](std::size_t writtenIndex, const analysis::LocalSet& liveLocals) -> void
 		{
-			it->forUsedLocals([it, &localRanges, &blockGraph](const Local* local, LocalUse::Type usageType) -> void
+			ColoredNode& node = graph.at(locals[writtenIndex]);
+			liveLocals.forEach([&locals, &numEdges, &node, writtenIndex, this](std::size_t index) -> void
 			{
-				if(has_flag(usageType, LocalUse::Type::READER))
-				{
-					PROFILE(walkUsageRange, it, local, localRanges, &blockGraph);
-				}
+				if(index == writtenIndex)
+					return;
+				ColoredNode& neighbor = graph.at(locals[index]);
+				node.addNeighbor(&neighbor, LocalRelation::USED_SIMULTANEOUSLY);
+				neighbor.addNeighbor(&node, LocalRelation::USED_SIMULTANEOUSLY);
+				++numEdges;
 			});
-		}
-		it.nextInMethod();
+		});
 	}
-	PROFILE_END(createUsageRanges);
+	PROFILE_END(addEdges);
+	PROFILE_COUNTER(1000001, "Interference graph nodes", locals.size());
+	PROFILE_COUNTER(1000002, "Interference graph edges", numEdges);
 	//TODO if this method works, could here spill all locals with more than XX (64) neighbors!?!
 	for(const auto& node : graph)
 	{
 		PROFILE_COUNTER(1000005, "SpillCandidates", node.second.getNeighbors().size() >= 64);
 	}
-	//2. iteration: associate locals used together
-	PROFILE_START(addEdges);
-	for(const auto& range : localRanges)
-	{
-		for(const Local* loc1 : range.second)
-		{
-			ColoredNode& node = graph.at(loc1);
-			for(const Local* loc2 : range.second)
-			{
-				if(loc1 == loc2)
-					continue;
-				node.addNeighbor(&graph.at(loc2), LocalRelation::USED_SIMULTANEOUSLY);
-			}
-		}
-	}
-	PROFILE_END(addEdges);
 
 	logging::debug() << "Colored graph with " << graph.size() << " nodes created!" << logging::endl;
 #ifdef DEBUG_MODE
@@ -800,7 +724,7 @@ static bool moveLocalToRegisterFile(Method& method, ColoredGraph& graph, Colored
 		const Value tmp = method.addNewLocal(node.key->type, "%register_fix");
 		logging::debug() << "Fixing register-conflict by using temporary as input for: " << it->to_string() << logging::endl;
 		it.emplace(new intermediate::MoveOperation(tmp, node.key->createReference()));
-		auto tmpUse = localUses.emplace(tmp.local, LocalUsage(it, it)).first->second;
+		auto& tmpUse = localUses.emplace(tmp.local, LocalUsage(it, it)).first->second;
 		it.nextInBlock();
 		it->replaceLocal(node.key, tmp.local, LocalUse::Type::READER);
 		//4) add temporary to graph (and local usage) with same blocked registers as local, but accumulator as file (since it is read in the next instruction)
@@ -991,9 +915,9 @@ static bool fixSingleError(Method& method, ColoredGraph& graph, ColoredNode& nod
 		else if(!moveToFileA && !moveToFileB)
 		{
 			//there are no more free register AT ALL
-			//since we do not spill, we can only about
-			logging::error() << "Local " << node.key->to_string() << " cannot be assigned to ANY register, aborting!" << logging::endl;
-			throw CompilationError(CompilationStep::LABEL_REGISTER_MAPPING, "Failed to assign local to ANY register", node.key->to_string());
+			//this can't be fixed by moving locals between register-files, so some locals need to be spilled (see CodeGenerator)
+			logging::debug() << "Local " << node.key->to_string() << " cannot be assigned to ANY register, requires spilling" << logging::endl;
+			return false;
 		}
 
 		logging::debug() << "Trying to fix local to register-file " << toString(add_flag(moveToFileA ? RegisterFile::PHYSICAL_A : RegisterFile::NONE, moveToFileB ? RegisterFile::PHYSICAL_B : RegisterFile::NONE)) << logging::endl;
@@ -1060,6 +984,66 @@ FastMap<const Local*, Register> GraphColoring::toRegisterMap() const
 	return result;
 }
 
+const FastMap<const Local*, LocalUsage>& GraphColoring::getLocalUses() const
+{
+	return localUses;
+}
+
+FastSet<const Local*> GraphColoring::selectSpillCandidates() const
+{
+	PROFILE_START(selectSpillCandidates);
+	auto blockGraph = ControlFlowGraph::createCFG(method);
+	const optimizations::SpillCosts spillCosts(method, blockGraph);
+
+	const auto calculateSpillCosts = [&](const ColoredNode& node) -> Optional<double>
+	{
+		const Local* local = node.key;
+		auto useIt = localUses.find(local);
+		if(useIt == localUses.end() || node.initialFile == RegisterFile::NONE || useIt->second.possibleFiles == RegisterFile::ACCUMULATOR || !spillCosts.isSpillable(local))
+			//locals fixed to accumulators are only used for a few instructions anyway
+			return {};
+		return spillCosts.getAccessCosts(local) / static_cast<double>(1 + node.getNeighbors().size());
+	};
+
+	FastMap<const Local*, double> candidates;
+	for(const Local* local : errorSet)
+	{
+		const ColoredNode& node = graph.at(local);
+		const Local* bestCandidate = nullptr;
+		double bestCosts = std::numeric_limits<double>::max();
+		//spilling a local frees a single register only, so a different local needs to be selected for every conflicting local
+		const auto checkCandidate = [&](const ColoredNode& candidate) -> void
+		{
+			if(candidates.find(candidate.key) != candidates.end())
+				return;
+			auto costs = calculateSpillCosts(candidate);
+			if(costs && costs.value() < bestCosts)
+			{
+				bestCandidate = candidate.key;
+				bestCosts = costs.value();
+			}
+		};
+		checkCandidate(node);
+		for(const auto& pair : node.getNeighbors())
+		{
+			if(pair.second == LocalRelation::USED_SIMULTANEOUSLY)
+				checkCandidate(*reinterpret_cast<const ColoredNode*>(pair.first));
+		}
+		if(bestCandidate != nullptr)
+			candidates.emplace(bestCandidate, bestCosts);
+	}
+
+	FastSet<const Local*> result;
+	for(const auto& pair : spillCosts.selectCheapest(std::vector<std::pair<const Local*, double>>(candidates.begin(), candidates.end()), candidates.size()))
+	{
+		logging::debug() << "Selected local for spilling: " << pair.first->to_string() << " with costs " << pair.second << logging::endl;
+		result.insert(pair.first);
+	}
+	PROFILE_END(selectSpillCandidates);
+	PROFILE_COUNTER(1000060, "Spilled locals", result.size());
+	return result;
+}
+
 void GraphColoring::resetGraph()
 {
 	//reset the graph and the closed- and open sets
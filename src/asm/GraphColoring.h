@@ -128,6 +128,19 @@ namespace vc4c
 			bool fixErrors();
 
 			FastMap<const Local*, Register> toRegisterMap() const;
+
+			/*
+			 * \return The usages of all locals, including the register-files they can be assigned to
+			 */
+			const FastMap<const Local*, LocalUsage>& getLocalUses() const;
+
+			/*
+			 * Selects the locals to be spilled to resolve the errors which could not be fixed.
+			 *
+			 * For every local which could not be assigned, the cheapest to spill of itself and its neighbors is selected.
+			 * The costs of spilling a local are its access costs (see optimizations::SpillCosts) divided by its number of neighbors.
+			 */
+			FastSet<const Local*> selectSpillCandidates() const;
 		private:
 			Method& method;
 			FastSet<const Local*> closedSet;
@@ -0,0 +1,216 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#include "LinearScan.h"
+
+#include "RegisterAllocation.h"
+#include "../analysis/LivenessAnalysis.h"
+#include "../Profiler.h"
+#include "log.h"
+
+#include <algorithm>
+
+using namespace vc4c;
+using namespace vc4c::qpu_asm;
+
+LinearScanAllocator::LinearScanAllocator(Method& method, const FastMap<const Local*, LocalUsage>& localUses) : method(method), localUses(localUses)
+{
+}
+
+static void addUsedTogether(const FastSet<const Local*>& locals, FastMap<const Local*, FastSet<const Local*>>& usedTogether)
+{
+	for(const Local* local : locals)
+	{
+		for(const Local* other : locals)
+		{
+			if(local != other)
+				usedTogether[local].insert(other);
+		}
+	}
+}
+
+std::vector<LinearScanAllocator::LiveRange> LinearScanAllocator::createLiveRanges(FastMap<const Local*, FastSet<const Local*>>& usedTogether)
+{
+	std::vector<LiveRange> ranges;
+	FastMap<const Local*, std::size_t> localIndices;
+	ranges.reserve(localUses.size());
+	localIndices.reserve(localUses.size());
+	for(const auto& pair : localUses)
+	{
+		if(pair.second.firstOccurrence.get() == pair.second.lastOccurrence.get())
+		{
+			//same as for the graph coloring, locals which are never read are not assigned to any register
+			registerMapping.emplace(pair.first, REG_NOP);
+			continue;
+		}
+		localIndices.emplace(pair.first, ranges.size());
+		ranges.push_back(LiveRange{pair.first, SIZE_MAX, 0});
+	}
+	const auto extendRange = [&ranges, &localIndices](const Local* local, const std::size_t position) -> void
+	{
+		auto it = localIndices.find(local);
+		if(it == localIndices.end())
+			return;
+		ranges[it->second].start = std::min(ranges[it->second].start, position);
+		ranges[it->second].end = std::max(ranges[it->second].end, position);
+	};
+
+	//parameters are live from the beginning
+	for(const Parameter& param : method.parameters)
+		extendRange(&param, 0);
+
+	auto cfg = ControlFlowGraph::createCFG(method);
+	const analysis::LivenessAnalysis liveness(method, cfg, localIndices);
+
+	std::size_t position = 0;
+	FastSet<const Local*> readLocals;
+	FastSet<const Local*> writtenLocals;
+	for(BasicBlock& block : method)
+	{
+		const std::size_t blockStart = position;
+		InstructionWalker it = block.begin();
+		while(!it.isEndOfBlock())
+		{
+			if(it.get() != nullptr && !it.has<intermediate::BranchLabel>() && !it.has<intermediate::Branch>())
+			{
+				//all locals read by the same instruction (and the outputs of combined instructions) block each other's physical register-file
+				readLocals.clear();
+				writtenLocals.clear();
+				it->forUsedLocals([&readLocals, &writtenLocals, &extendRange, position](const Local* local, const LocalUse::Type type) -> void
+				{
+					extendRange(local, position);
+					if(has_flag(type, LocalUse::Type::READER))
+						readLocals.insert(local);
+					if(has_flag(type, LocalUse::Type::WRITER))
+						writtenLocals.insert(local);
+				});
+				addUsedTogether(readLocals, usedTogether);
+				addUsedTogether(writtenLocals, usedTogether);
+			}
+			++position;
+			it.nextInBlock();
+		}
+		const std::size_t blockEnd = position == blockStart ? position : position - 1;
+		liveness.getLiveIn(&block).forEach([&ranges, blockStart](std::size_t index) -> void
+		{
+			ranges[index].start = std::min(ranges[index].start, blockStart);
+			ranges[index].end = std::max(ranges[index].end, blockStart);
+		});
+		liveness.getLiveOut(&block).forEach([&ranges, blockEnd](std::size_t index) -> void
+		{
+			ranges[index].start = std::min(ranges[index].start, blockEnd);
+			ranges[index].end = std::max(ranges[index].end, blockEnd);
+		});
+	}
+	return ranges;
+}
+
+template<std::size_t size>
+static Optional<std::size_t> findFreeRegister(const std::bitset<size>& freeRegisters)
+{
+	for(std::size_t i = 0; i < freeRegisters.size(); ++i)
+	{
+		if(freeRegisters.test(i))
+			return i;
+	}
+	return {};
+}
+
+bool LinearScanAllocator::allocate()
+{
+	FastMap<const Local*, FastSet<const Local*>> usedTogether;
+	PROFILE_START(createLiveRanges);
+	std::vector<LiveRange> ranges = createLiveRanges(usedTogether);
+	PROFILE_END(createLiveRanges);
+
+	PROFILE_START(assignRegisters);
+	std::sort(ranges.begin(), ranges.end(), [](const LiveRange& r1, const LiveRange& r2) -> bool { return r1.start < r2.start || (r1.start == r2.start && r1.end < r2.end);});
+
+	std::bitset<4> freeAccumulators(0xFUL);
+	std::bitset<32> freeA(0xFFFFFFFFUL);
+	std::bitset<32> freeB(0xFFFFFFFFUL);
+	const auto releaseRegister = [&freeAccumulators, &freeA, &freeB](const Register& reg) -> void
+	{
+		if(reg.file == RegisterFile::ACCUMULATOR)
+			freeAccumulators.set(reg.num - ACCUMULATORS.front().num);
+		else if(reg.file == RegisterFile::PHYSICAL_A)
+			freeA.set(reg.num);
+		else if(reg.file == RegisterFile::PHYSICAL_B)
+			freeB.set(reg.num);
+	};
+
+	//the live-ranges currently assigned to a register, sorted by the end of their ranges
+	std::vector<const LiveRange*> active;
+	for(const LiveRange& range : ranges)
+	{
+		while(!active.empty() && active.front()->end < range.start)
+		{
+			releaseRegister(registerMapping.at(active.front()->local));
+			active.erase(active.begin());
+		}
+
+		RegisterFile possibleFiles = localUses.at(range.local).possibleFiles;
+		auto partnerIt = usedTogether.find(range.local);
+		if(partnerIt != usedTogether.end())
+		{
+			for(const Local* partner : partnerIt->second)
+			{
+				auto regIt = registerMapping.find(partner);
+				if(regIt != registerMapping.end() && (regIt->second.file == RegisterFile::PHYSICAL_A || regIt->second.file == RegisterFile::PHYSICAL_B))
+					possibleFiles = remove_flag(possibleFiles, regIt->second.file);
+			}
+		}
+
+		//to make it easier for the following locals to find a free register, use the physical file with more free registers left
+		const bool preferA = freeA.count() >= freeB.count();
+		const RegisterFile firstPhysical = preferA ? RegisterFile::PHYSICAL_A : RegisterFile::PHYSICAL_B;
+		const RegisterFile secondPhysical = preferA ? RegisterFile::PHYSICAL_B : RegisterFile::PHYSICAL_A;
+		const bool preferAccumulator = range.end - range.start <= ACCUMULATOR_THRESHOLD_HINT;
+		const std::array<RegisterFile, 3> candidates = preferAccumulator ?
+				std::array<RegisterFile, 3>{RegisterFile::ACCUMULATOR, firstPhysical, secondPhysical} :
+				std::array<RegisterFile, 3>{firstPhysical, secondPhysical, RegisterFile::ACCUMULATOR};
+
+		Optional<Register> reg;
+		for(const RegisterFile file : candidates)
+		{
+			if(!has_flag(possibleFiles, file))
+				continue;
+			if(file == RegisterFile::ACCUMULATOR)
+			{
+				if(auto index = findFreeRegister(freeAccumulators))
+				{
+					freeAccumulators.reset(index.value());
+					reg = ACCUMULATORS.at(index.value());
+				}
+			}
+			else if(auto index = findFreeRegister(file == RegisterFile::PHYSICAL_A ? freeA : freeB))
+			{
+				(file == RegisterFile::PHYSICAL_A ? freeA : freeB).reset(index.value());
+				reg = Register{file, static_cast<unsigned char>(index.value())};
+			}
+			if(reg)
+				break;
+		}
+		if(!reg)
+		{
+			logging::debug() << "Linear-scan failed to assign a register to local: " << range.local->to_string() << " with possible files: " << toString(possibleFiles) << logging::endl;
+			PROFILE_END(assignRegisters);
+			return false;
+		}
+		registerMapping.emplace(range.local, reg.value());
+		active.insert(std::upper_bound(active.begin(), active.end(), &range, [](const LiveRange* r1, const LiveRange* r2) -> bool { return r1->end < r2->end;}), &range);
+	}
+	PROFILE_END(assignRegisters);
+	PROFILE_COUNTER(1000050, "Linear-scan live-ranges", ranges.size());
+	return true;
+}
+
+FastMap<const Local*, Register> LinearScanAllocator::toRegisterMap() const
+{
+	for(const auto& pair : registerMapping)
+		logging::debug() << "Assigned local " << pair.first->name << " to register " << pair.second.to_string(true, false) << logging::endl;
+	return registerMapping;
+}
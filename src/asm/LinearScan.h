@@ -0,0 +1,63 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#ifndef LINEAR_SCAN_H
+#define LINEAR_SCAN_H
+
+#include "GraphColoring.h"
+
+#include <vector>
+
+namespace vc4c
+{
+	namespace qpu_asm
+	{
+		/*
+		 * Linear-scan register allocation as a fast alternative to the graph coloring.
+		 *
+		 * The live-ranges of all locals are approximated by the first and last instruction they are live at (ignoring any holes)
+		 * and the locals are assigned to the registers in order of the start of their live-ranges.
+		 *
+		 * The restrictions of the VC4 register-files (see RegisterAllocation.h) are respected:
+		 * - the register-files a local can be assigned to are taken from the analysis done for the graph coloring (e.g. accumulators only for locals read directly after being written, file A for (un)packing)
+		 * - locals read (or written) by the same instruction are not assigned to the same physical register-file
+		 * - only the accumulators r0 to r3 are used, since r4 and r5 have special meanings
+		 *
+		 * Short-lived locals preferably are assigned to accumulators, all other locals to the physical file with the most free registers.
+		 * No instructions are inserted to resolve conflicts, so if any local cannot be assigned to a register, the allocation fails
+		 * and the graph coloring needs to be used instead.
+		 */
+		class LinearScanAllocator
+		{
+		public:
+			LinearScanAllocator(Method& method, const FastMap<const Local*, LocalUsage>& localUses);
+
+			/*!
+			 * \return Whether all locals could be assigned to a valid register
+			 */
+			bool allocate();
+
+			FastMap<const Local*, Register> toRegisterMap() const;
+
+		private:
+			struct LiveRange
+			{
+				const Local* local;
+				//the positions of the first and last instruction the local is live at
+				std::size_t start;
+				std::size_t end;
+			};
+
+			Method& method;
+			const FastMap<const Local*, LocalUsage>& localUses;
+			FastMap<const Local*, Register> registerMapping;
+
+			std::vector<LiveRange> createLiveRanges(FastMap<const Local*, FastSet<const Local*>>& usedTogether);
+		};
+	} // namespace qpu_asm
+} // namespace vc4c
+
+#endif /* LINEAR_SCAN_H */
@@ -6,16 +6,21 @@
 
 #include "../include/c_interface.h"
 
+#include <atomic>
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <string.h>
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
 
 #include "Compiler.h"
 #include "../lib/cpplog/include/logger.h"
 #include "log.h"
 #include "CompilationError.h"
 #include "Precompiler.h"
+#include "ProcessUtil.h"
 
 using namespace vc4c;
 
@@ -25,6 +30,13 @@ const configuration DEFAULT_CONFIG = {
 
 static CompilationErrorHandler errorCallback = NULL;
 static void* callbackData = NULL;
+//the settings can be changed while other threads are compiling
+static std::atomic<bool> useCompilationCache{false};
+static std::atomic<RegisterAllocator> registerAllocator{RegisterAllocator::GRAPH_COLORING};
+static std::string instrumentationReport;
+#ifdef MULTI_THREADED
+static std::mutex instrumentationReportLock;
+#endif
 
 int convert(const storage* in, storage* out, const configuration config, const char* options)
 {
@@ -34,6 +46,15 @@ int convert(const storage* in, storage* out, const configuration config, const c
     realConfig.mathType = static_cast<MathType>(config.math_type);
     realConfig.outputMode = static_cast<OutputMode>(config.output_mode);
     realConfig.writeKernelInfo = true;
+    realConfig.useCompilationCache = useCompilationCache.load();
+    realConfig.registerAllocator = registerAllocator.load();
+    {
+#ifdef MULTI_THREADED
+    	std::lock_guard<std::mutex> guard(instrumentationReportLock);
+#endif
+    	if(!instrumentationReport.empty())
+    		realConfig.instrumentationReport = instrumentationReport;
+    }
         
     std::unique_ptr<std::istream> is;
     if(in->is_file)
@@ -102,6 +123,27 @@ void setErrorHandler(CompilationErrorHandler errorHandler, void* userData)
     callbackData = userData;
 }
 
+void setCompilationCache(unsigned useCache)
+{
+    useCompilationCache = useCache != 0;
+}
+
+int setRegisterAllocator(unsigned allocator)
+{
+    if(allocator != REGISTER_ALLOCATOR_GRAPH_COLORING && allocator != REGISTER_ALLOCATOR_LINEAR_SCAN)
+    	return -30 /* CL_INVALID_VALUE */;
+    registerAllocator = static_cast<RegisterAllocator>(allocator);
+    return 0 /* CL_SUCCESS */;
+}
+
+void setInstrumentationReport(const char* fileName)
+{
+#ifdef MULTI_THREADED
+    std::lock_guard<std::mutex> guard(instrumentationReportLock);
+#endif
+    instrumentationReport = fileName == NULL ? "" : fileName;
+}
+
 int determineSourceType(const storage* in)
 {
     std::unique_ptr<std::istream> is;
@@ -117,3 +159,17 @@ int determineSourceType(const storage* in)
     
     return static_cast<int>(Precompiler::getSourceType(*is.get()));
 }
+
+int startFrontendHelper(void)
+{
+    try
+    {
+        helper::startProcessHelper();
+    }
+    catch(CompilationError& err)
+    {
+        logging::severe() << err.what() << logging::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -79,6 +79,17 @@ signal(SIGNAL_NONE), unpackMode(UNPACK_NOP),  packMode(packMode), conditional(co
 {
 	if(output)
 		addAsUserToValue(output.value(), LocalUse::Type::WRITER);
+	InstructionChangeTracker::recordChange(this);
+}
+
+void* IntermediateInstruction::operator new(const std::size_t size)
+{
+	return MemoryArena::allocateInCurrentArena(size);
+}
+
+void IntermediateInstruction::operator delete(void* ptr, const std::size_t size) noexcept
+{
+	MemoryArena::deallocateFromArena(ptr, size);
 }
 
 IntermediateInstruction::~IntermediateInstruction()
@@ -87,6 +98,7 @@ IntermediateInstruction::~IntermediateInstruction()
 	//since at the time, the ~LocalUser() is called, the IntermediateInstruction "part" is already destroyed
 	for(const auto& pair : getUsedLocals())
 		const_cast<Local*>(pair.first)->removeUser(*this, LocalUse::Type::BOTH);
+	InstructionChangeTracker::recordRemoval(this);
 }
 
 bool IntermediateInstruction::mapsToASMInstruction() const
@@ -119,6 +131,8 @@ const std::vector<Value>& IntermediateInstruction::getArguments() const
 
 void IntermediateInstruction::setArgument(const std::size_t index, const Value& arg)
 {
+	if(index < arguments.size() && arguments[index] == arg)
+		return;
 	if(index < arguments.size())
 	{
 		removeAsUserFromValue(arguments[index], LocalUse::Type::READER);
@@ -129,12 +143,15 @@ void IntermediateInstruction::setArgument(const std::size_t index, const Value&
 		arguments.insert(arguments.begin() + index, arg);
 
 	addAsUserToValue(arg, LocalUse::Type::READER);
+	InstructionChangeTracker::recordChange(this);
 }
 
 IntermediateInstruction* IntermediateInstruction::setOutput(const Optional<Value>& output)
 {
 	if(this->output)
 		removeAsUserFromValue(this->output.value(), LocalUse::Type::WRITER);
+	if(this->output != output)
+		InstructionChangeTracker::recordChange(this);
 	this->output = output;
 	if(output)
 		addAsUserToValue(output.value(), LocalUse::Type::WRITER);
@@ -143,36 +160,48 @@ IntermediateInstruction* IntermediateInstruction::setOutput(const Optional<Value
 
 IntermediateInstruction* IntermediateInstruction::setSignaling(const Signaling signal)
 {
+    if(this->signal != signal)
+    	InstructionChangeTracker::recordChange(this);
     this->signal = signal;
     return this;
 }
 
 IntermediateInstruction* IntermediateInstruction::setPackMode(const Pack packMode)
 {
+    if(this->packMode != packMode)
+    	InstructionChangeTracker::recordChange(this);
     this->packMode = packMode;
     return this;
 }
 
 IntermediateInstruction* IntermediateInstruction::setCondition(const ConditionCode condition)
 {
+    if(this->conditional != condition)
+    	InstructionChangeTracker::recordChange(this);
     this->conditional = condition;
     return this;
 }
 
 IntermediateInstruction* IntermediateInstruction::setSetFlags(const SetFlag setFlags)
 {
+    if(this->setFlags != setFlags)
+    	InstructionChangeTracker::recordChange(this);
     this->setFlags = setFlags;
     return this;
 }
 
 IntermediateInstruction* IntermediateInstruction::setUnpackMode(const Unpack unpackMode)
 {
+    if(this->unpackMode != unpackMode)
+    	InstructionChangeTracker::recordChange(this);
     this->unpackMode = unpackMode;
     return this;
 }
 
 IntermediateInstruction* IntermediateInstruction::addDecorations(const InstructionDecorations decorations)
 {
+	if(add_flag(this->decoration, decorations) != this->decoration)
+		InstructionChangeTracker::recordChange(this);
 	this->decoration = add_flag(this->decoration, decorations);
     return this;
 }
@@ -375,6 +404,7 @@ void IntermediateInstruction::replaceLocal(const Local* oldLocal, const Local* n
 		removeAsUserFromValue(output.value(), LocalUse::Type::WRITER);
 		output->local = const_cast<Local*>(newLocal);
 		addAsUserToValue(output.value(), LocalUse::Type::WRITER);
+		InstructionChangeTracker::recordChange(this);
 	}
 	if(has_flag(type, LocalUse::Type::READER))
 	{
@@ -385,6 +415,7 @@ void IntermediateInstruction::replaceLocal(const Local* oldLocal, const Local* n
 				removeAsUserFromValue(arg,  LocalUse::Type::READER);
 				arg.local = const_cast<Local*>(newLocal);
 				addAsUserToValue(arg, LocalUse::Type::READER);
+				InstructionChangeTracker::recordChange(this);
 			}
 		}
 	}
@@ -427,3 +458,37 @@ void IntermediateInstruction::addAsUserToValue(const Value& value, LocalUse::Typ
 	if(value.hasType(ValueType::LOCAL))
 		const_cast<Local*>(value.local)->addUser(*this, type);
 }
+
+static thread_local InstructionChangeTracker* currentTracker = nullptr;
+
+InstructionChangeTracker::InstructionChangeTracker() : previousTracker(currentTracker)
+{
+	currentTracker = this;
+}
+
+InstructionChangeTracker::~InstructionChangeTracker()
+{
+	currentTracker = previousTracker;
+}
+
+const FastSet<const IntermediateInstruction*>& InstructionChangeTracker::getChangedInstructions() const
+{
+	return changedInstructions;
+}
+
+void InstructionChangeTracker::clear()
+{
+	changedInstructions.clear();
+}
+
+void InstructionChangeTracker::recordChange(const IntermediateInstruction* inst)
+{
+	if(currentTracker != nullptr)
+		currentTracker->changedInstructions.insert(inst);
+}
+
+void InstructionChangeTracker::recordRemoval(const IntermediateInstruction* inst)
+{
+	if(currentTracker != nullptr)
+		currentTracker->changedInstructions.erase(inst);
+}
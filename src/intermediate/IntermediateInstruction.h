@@ -89,6 +89,12 @@ namespace vc4c
 			IntermediateInstruction& operator=(const IntermediateInstruction&) = delete;
 			IntermediateInstruction& operator=(IntermediateInstruction&&) = delete;
 
+			/*
+			 * Instructions are allocated in the memory arena of the method currently processed by this thread (see MemoryArena::Scope)
+			 */
+			static void* operator new(std::size_t size);
+			static void operator delete(void* ptr, std::size_t size) noexcept;
+
 			virtual FastMap<const Local*, LocalUse::Type> getUsedLocals() const;
 			virtual void forUsedLocals(const std::function<void(const Local*, LocalUse::Type)>& consumer) const;
 			virtual bool readsLocal(const Local* local) const;
@@ -214,6 +220,31 @@ namespace vc4c
 			void addAsUserToValue(const Value& value, LocalUse::Type type);
 		};
 
+		/*
+		 * Records all instructions created or modified (via the setters and #replaceLocal) by the current thread for the lifetime of this object.
+		 *
+		 * This allows to determine the instructions changed by an optimization, including instructions modified in-place
+		 * or instructions other than the one the optimization was run on. Instructions deleted while the tracker is active are removed from the record again.
+		 *
+		 * If no tracker is active, recording a change only costs a null-pointer check.
+		 */
+		class InstructionChangeTracker : private NonCopyable
+		{
+		public:
+			InstructionChangeTracker();
+			~InstructionChangeTracker();
+
+			const FastSet<const IntermediateInstruction*>& getChangedInstructions() const;
+			void clear();
+
+			static void recordChange(const IntermediateInstruction* inst);
+			static void recordRemoval(const IntermediateInstruction* inst);
+
+		private:
+			InstructionChangeTracker* previousTracker;
+			FastSet<const IntermediateInstruction*> changedInstructions;
+		};
+
 		struct CombinedOperation;
 
 		struct Operation: public IntermediateInstruction
@@ -256,6 +287,10 @@ namespace vc4c
 			bool matchesSignature(const Method& method) const;
 
 			std::string methodName;
+			/*
+			 * The intrinsic this call was resolved to, cached by the intrinsics-lookup so the method-name is only matched once
+			 */
+			Optional<std::size_t> intrinsicIndex;
 		};
 
 		struct Return: public IntermediateInstruction
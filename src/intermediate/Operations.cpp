@@ -301,6 +301,8 @@ Optional<Value> Operation::precalculate(const std::size_t numIterations) const
 
 void Operation::setOpCode(const OpCode& op)
 {
+	if(this->op != op)
+		InstructionChangeTracker::recordChange(this);
 	const_cast<OpCode&>(this->op) = op;
 	const_cast<std::string&>(this->opCode) = op.name;
 }
@@ -17,8 +17,10 @@
 #include "Operators.h"
 #include "log.h"
 
+#include <array>
 #include <cmath>
 #include <cstdbool>
+#include <limits>
 #include <map>
 #include <vector>
 
@@ -303,6 +305,147 @@ const static std::map<std::string, std::pair<Intrinsic, Optional<Value>>, std::g
     {"vc4cl_bitcast_float", {Intrinsic{intrinsifyBinaryALUInstruction("mov"), [](const Value& val){return Value(Literal(val.literal), TYPE_INT32);}}, NO_VALUE}}
 };
 
+//the work-item functions are handled separately and only match the exact method-name
+const static std::vector<std::string> workItemFunctions = {
+	"vc4cl_work_dimensions", "vc4cl_num_groups", "vc4cl_group_id", "vc4cl_global_offset", "vc4cl_local_size", "vc4cl_local_id", "vc4cl_global_size", "vc4cl_global_id"
+};
+
+enum class IntrinsicKind : unsigned char
+{
+	NONARY,
+	UNARY,
+	TYPE_CAST,
+	BINARY,
+	TERNARY,
+	WORK_ITEM
+};
+
+struct IntrinsicEntry
+{
+	IntrinsicKind kind;
+	const Intrinsic* intrinsic;
+	//the constant to apply, only set for type-casts
+	const Optional<Value>* castValue;
+};
+
+static const std::string INTRINSIC_PREFIX = "vc4cl_";
+static constexpr std::size_t NO_INTRINSIC = std::numeric_limits<std::size_t>::max();
+
+/*
+ * Trie over the names of all intrinsics (without the common prefix "vc4cl_"), built once from the mappings above.
+ *
+ * Since the intrinsic names can be contained anywhere in the method-name (e.g. in mangled names), the lookup starts at every occurrence of the prefix
+ * and returns the longest name matched, e.g. "vc4cl_fmaxabs" and not "vc4cl_fmax".
+ */
+class IntrinsicTrie
+{
+public:
+	IntrinsicTrie()
+	{
+		nodes.emplace_back();
+		for(const auto& pair : nonaryInstrinsics)
+			insert(pair.first, IntrinsicEntry{IntrinsicKind::NONARY, &pair.second, nullptr});
+		for(const auto& pair : unaryIntrinsicMapping)
+			insert(pair.first, IntrinsicEntry{IntrinsicKind::UNARY, &pair.second, nullptr});
+		for(const auto& pair : typeCastIntrinsics)
+			insert(pair.first, IntrinsicEntry{IntrinsicKind::TYPE_CAST, &pair.second.first, &pair.second.second});
+		for(const auto& pair : binaryIntrinsicMapping)
+			insert(pair.first, IntrinsicEntry{IntrinsicKind::BINARY, &pair.second, nullptr});
+		for(const auto& pair : ternaryIntrinsicMapping)
+			insert(pair.first, IntrinsicEntry{IntrinsicKind::TERNARY, &pair.second, nullptr});
+		for(const std::string& name : workItemFunctions)
+			insert(name, IntrinsicEntry{IntrinsicKind::WORK_ITEM, nullptr, nullptr});
+	}
+
+	std::size_t lookup(const std::string& methodName) const
+	{
+		std::size_t start = methodName.find(INTRINSIC_PREFIX);
+		while(start != std::string::npos)
+		{
+			std::size_t node = 0;
+			std::size_t match = NO_INTRINSIC;
+			for(std::size_t pos = start + INTRINSIC_PREFIX.size(); pos < methodName.size(); ++pos)
+			{
+				const int index = toIndex(methodName[pos]);
+				if(index < 0 || nodes[node].children[static_cast<std::size_t>(index)] == 0)
+					break;
+				node = nodes[node].children[static_cast<std::size_t>(index)];
+				const std::size_t entry = nodes[node].entry;
+				//work-item functions need to match the whole name
+				if(entry != NO_INTRINSIC && (entries[entry].kind != IntrinsicKind::WORK_ITEM || (start == 0 && pos + 1 == methodName.size())))
+					match = entry;
+			}
+			if(match != NO_INTRINSIC)
+				return match;
+			start = methodName.find(INTRINSIC_PREFIX, start + 1);
+		}
+		return NO_INTRINSIC;
+	}
+
+	const IntrinsicEntry& operator[](const std::size_t index) const
+	{
+		return entries.at(index);
+	}
+
+private:
+	//lower-case letters, digits and the underscore
+	static constexpr std::size_t NUM_CHARACTERS = 26 + 10 + 1;
+
+	struct Node
+	{
+		std::array<uint16_t, NUM_CHARACTERS> children{};
+		std::size_t entry = NO_INTRINSIC;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<IntrinsicEntry> entries;
+
+	static int toIndex(const char c)
+	{
+		if(c >= 'a' && c <= 'z')
+			return c - 'a';
+		if(c >= '0' && c <= '9')
+			return 26 + (c - '0');
+		if(c == '_')
+			return 36;
+		return -1;
+	}
+
+	void insert(const std::string& name, const IntrinsicEntry& entry)
+	{
+		if(name.compare(0, INTRINSIC_PREFIX.size(), INTRINSIC_PREFIX) != 0)
+			throw CompilationError(CompilationStep::OPTIMIZER, "Intrinsic name does not start with the common prefix", name);
+		std::size_t node = 0;
+		for(std::size_t pos = INTRINSIC_PREFIX.size(); pos < name.size(); ++pos)
+		{
+			const int index = toIndex(name[pos]);
+			if(index < 0)
+				throw CompilationError(CompilationStep::OPTIMIZER, "Invalid character in intrinsic name", name);
+			if(nodes[node].children[static_cast<std::size_t>(index)] == 0)
+			{
+				nodes[node].children[static_cast<std::size_t>(index)] = static_cast<uint16_t>(nodes.size());
+				nodes.emplace_back();
+			}
+			node = nodes[node].children[static_cast<std::size_t>(index)];
+		}
+		nodes[node].entry = entries.size();
+		entries.push_back(entry);
+	}
+};
+
+/*
+ * Returns the intrinsic the given call is mapped to, or nullptr if it is no intrinsic.
+ *
+ * The result is cached in the call-site, so the method-name is only looked up once
+ */
+static const IntrinsicEntry* lookupIntrinsic(MethodCall* callSite)
+{
+	static const IntrinsicTrie trie;
+	if(!callSite->intrinsicIndex)
+		callSite->intrinsicIndex = trie.lookup(callSite->methodName);
+	return callSite->intrinsicIndex.value() == NO_INTRINSIC ? nullptr : &trie[callSite->intrinsicIndex.value()];
+}
+
 static InstructionWalker intrinsifyNoArgs(Method& method, InstructionWalker it)
 {
     MethodCall* callSite = it.get<MethodCall>();
@@ -314,12 +457,10 @@ static InstructionWalker intrinsifyNoArgs(Method& method, InstructionWalker it)
     {
         return it;
     }
-    for(const auto& pair : nonaryInstrinsics)
+    const IntrinsicEntry* entry = lookupIntrinsic(callSite);
+    if(entry != nullptr && entry->kind == IntrinsicKind::NONARY)
     {
-        if(callSite->methodName.find(pair.first) != std::string::npos)
-        {
-        	return pair.second.func(method, it, callSite);
-        }
+    	return entry->intrinsic->func(method, it, callSite);
     }
     return it;
 }
@@ -335,45 +476,43 @@ static InstructionWalker intrinsifyUnary(Method& method, InstructionWalker it)
     {
         return it;
     }
-    for(const auto& pair : unaryIntrinsicMapping)
+    const IntrinsicEntry* entry = lookupIntrinsic(callSite);
+    if(entry != nullptr && entry->kind == IntrinsicKind::UNARY)
     {
-        if(callSite->methodName.find(pair.first) != std::string::npos)
-        {
-        	if(callSite->getArgument(0)->hasType(ValueType::LITERAL) && pair.second.unaryInstr && pair.second.unaryInstr.value()(callSite->getArgument(0).value()))
-        	{
-        		logging::debug() << "Intrinsifying unary '" << callSite->to_string() << "' to pre-calculated value" << logging::endl;
-        		it.reset(new MoveOperation(callSite->getOutput().value(), pair.second.unaryInstr.value()(callSite->getArgument(0).value()).value(), callSite->conditional, callSite->setFlags));
-        	}
-        	else
-        	{
-        		return pair.second.func(method, it, callSite);
-        	}
-            return it;
-        }
+    	const Intrinsic& intrinsic = *entry->intrinsic;
+    	if(callSite->getArgument(0)->hasType(ValueType::LITERAL) && intrinsic.unaryInstr && intrinsic.unaryInstr.value()(callSite->getArgument(0).value()))
+    	{
+    		logging::debug() << "Intrinsifying unary '" << callSite->to_string() << "' to pre-calculated value" << logging::endl;
+    		it.reset(new MoveOperation(callSite->getOutput().value(), intrinsic.unaryInstr.value()(callSite->getArgument(0).value()).value(), callSite->conditional, callSite->setFlags));
+    	}
+    	else
+    	{
+    		return intrinsic.func(method, it, callSite);
+    	}
+        return it;
     }
-    for(const auto& pair : typeCastIntrinsics)
+    if(entry != nullptr && entry->kind == IntrinsicKind::TYPE_CAST)
     {
-        if(callSite->methodName.find(pair.first) != std::string::npos)
+    	const Intrinsic& intrinsic = *entry->intrinsic;
+    	const Optional<Value>& castValue = *entry->castValue;
+    	if(callSite->getArgument(0)->hasType(ValueType::LITERAL) && intrinsic.unaryInstr && intrinsic.unaryInstr.value()(callSite->getArgument(0).value()))
+		{
+			logging::debug() << "Intrinsifying type-cast '" << callSite->to_string() << "' to pre-calculated value" << logging::endl;
+			it.reset(new MoveOperation(callSite->getOutput().value(), intrinsic.unaryInstr.value()(callSite->getArgument(0).value()).value(), callSite->conditional, callSite->setFlags));
+		}
+    	else if(!castValue)	//there is no value to apply -> simple move
+    	{
+    		logging::debug() << "Intrinsifying '" << callSite->to_string() << "' to simple move" << logging::endl;
+			it.reset(new MoveOperation(callSite->getOutput().value(), callSite->getArgument(0).value()));
+    	}
+    	else
         {
-        	if(callSite->getArgument(0)->hasType(ValueType::LITERAL) && pair.second.first.unaryInstr && pair.second.first.unaryInstr.value()(callSite->getArgument(0).value()))
-			{
-				logging::debug() << "Intrinsifying type-cast '" << callSite->to_string() << "' to pre-calculated value" << logging::endl;
-				it.reset(new MoveOperation(callSite->getOutput().value(), pair.second.first.unaryInstr.value()(callSite->getArgument(0).value()).value(), callSite->conditional, callSite->setFlags));
-			}
-        	else if(!pair.second.second)	//there is no value to apply -> simple move
-        	{
-        		logging::debug() << "Intrinsifying '" << callSite->to_string() << "' to simple move" << logging::endl;
-				it.reset(new MoveOperation(callSite->getOutput().value(), callSite->getArgument(0).value()));
-        	}
-        	else
-            {
-        		//TODO could use pack-mode here, but only for UNSIGNED values!!
-				logging::debug() << "Intrinsifying '" << callSite->to_string() << "' to operation with constant " << pair.second.second.to_string() << logging::endl;
-				callSite->setArgument(1, pair.second.second.value());
-				return pair.second.first.func(method, it, callSite);
-            }
-            return it;
+    		//TODO could use pack-mode here, but only for UNSIGNED values!!
+			logging::debug() << "Intrinsifying '" << callSite->to_string() << "' to operation with constant " << castValue.to_string() << logging::endl;
+			callSite->setArgument(1, castValue.value());
+			return intrinsic.func(method, it, callSite);
         }
+        return it;
     }
     return it;
 }
@@ -389,21 +528,20 @@ static InstructionWalker intrinsifyBinary(Method& method, InstructionWalker it)
     {
         return it;
     }
-    for(const auto& pair : binaryIntrinsicMapping)
+    const IntrinsicEntry* entry = lookupIntrinsic(callSite);
+    if(entry != nullptr && entry->kind == IntrinsicKind::BINARY)
     {
-        if(callSite->methodName.find(pair.first) != std::string::npos)
-        {
-        	if(callSite->getArgument(0)->hasType(ValueType::LITERAL) && callSite->getArgument(1)->hasType(ValueType::LITERAL) && pair.second.binaryInstr && pair.second.binaryInstr.value()(callSite->getArgument(0).value(), callSite->getArgument(1).value()))
-			{
-				logging::debug() << "Intrinsifying binary '" << callSite->to_string() << "' to pre-calculated value" << logging::endl;
-				it.reset(new MoveOperation(callSite->getOutput().value(), pair.second.binaryInstr.value()(callSite->getArgument(0).value(), callSite->getArgument(1).value()).value(), callSite->conditional, callSite->setFlags));
-			}
-        	else
-        	{
-        		return pair.second.func(method, it, callSite);
-        	}
-            return it;
-        }
+    	const Intrinsic& intrinsic = *entry->intrinsic;
+    	if(callSite->getArgument(0)->hasType(ValueType::LITERAL) && callSite->getArgument(1)->hasType(ValueType::LITERAL) && intrinsic.binaryInstr && intrinsic.binaryInstr.value()(callSite->getArgument(0).value(), callSite->getArgument(1).value()))
+		{
+			logging::debug() << "Intrinsifying binary '" << callSite->to_string() << "' to pre-calculated value" << logging::endl;
+			it.reset(new MoveOperation(callSite->getOutput().value(), intrinsic.binaryInstr.value()(callSite->getArgument(0).value(), callSite->getArgument(1).value()).value(), callSite->conditional, callSite->setFlags));
+		}
+    	else
+    	{
+    		return intrinsic.func(method, it, callSite);
+    	}
+        return it;
     }
     return it;
 }
@@ -419,12 +557,10 @@ static InstructionWalker intrinsifyTernary(Method& method, InstructionWalker it)
     {
         return it;
     }
-    for(const auto& pair : ternaryIntrinsicMapping)
+    const IntrinsicEntry* entry = lookupIntrinsic(callSite);
+    if(entry != nullptr && entry->kind == IntrinsicKind::TERNARY)
     {
-        if(callSite->methodName.find(pair.first) != std::string::npos)
-        {
-        	return pair.second.func(method, it, callSite);
-        }
+    	return entry->intrinsic->func(method, it, callSite);
     }
     return it;
 }
@@ -825,6 +961,9 @@ static InstructionWalker intrinsifyWorkItemFunctions(Method& method, Instruction
 		return it;
 	if(callSite->getArguments().size() > 1)
 		return it;
+	const IntrinsicEntry* entry = lookupIntrinsic(callSite);
+	if(entry == nullptr || entry->kind != IntrinsicKind::WORK_ITEM)
+		return it;
 
 	if(callSite->methodName.compare("vc4cl_work_dimensions") == 0 && callSite->getArguments().size() == 0)
 	{
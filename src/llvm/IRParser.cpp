@@ -6,6 +6,8 @@
 
 #include "IRParser.h"
 
+#include "../BackgroundWorker.h"
+#include "../Profiler.h"
 #include "../intermediate/IntermediateInstruction.h"
 #include "Token.h"
 #include "log.h"
@@ -24,7 +26,7 @@ IRParser::IRParser(Scanner& scanner) : scanner(scanner), module(nullptr), curren
 
 }
 
-IRParser::IRParser(std::istream& stream) : scanner(stream), module(nullptr), currentMethod(nullptr)
+IRParser::IRParser(std::istream& stream) : scanner(stream, true), module(nullptr), currentMethod(nullptr)
 {
 
 }
@@ -169,6 +171,24 @@ void IRParser::parse(Module& module)
     }
     //map meta-data to kernels
     extractKernelInfo();
+    //functions not called by any kernel are never used, so there is no need to map them
+    dropUnreachableMethods();
+
+    //the function bodies are independent of each other, so they can be mapped in parallel
+    if(module.compilationConfig.parallelFrontend)
+    {
+    	std::vector<std::function<void()>> tasks;
+    	tasks.reserve(methods.size());
+    	for(LLVMMethod& method : methods)
+    		tasks.emplace_back([this, &method]() -> void { mapInstructions(method); });
+    	threading::BackgroundWorker::scheduleAll(tasks, "Front-end", module.compilationConfig.numThreads);
+    }
+    else
+    {
+    	for(LLVMMethod& method : methods)
+    		mapInstructions(method);
+    }
+    logging::debug() << "-----" << logging::endl;
 
     module.methods.reserve(methods.size());
     for(LLVMMethod& method: methods)
@@ -362,8 +382,7 @@ std::vector<std::pair<Value, ParameterDecorations>> IRParser::parseParameters()
             	//as of CLang 3.9, parameters seem to not (always) have explicit names anymore
 				//if this is the case, assign the number of the parameter
 				if (nextToken.type == TokenType::STRING && !nextToken.hasValue('%')) {
-					nextToken.type = TokenType::STRING;
-					strncpy(nextToken.text.data(), (std::string("%") + std::to_string(res.size())).data(), TOKEN_BUFFER_SIZE);
+					nextToken = scanner.createToken(std::string("%") + std::to_string(res.size()));
 				}
 				logging::debug() << "Parameter " << type.to_string() << ' ' << nextToken.to_string() << logging::endl;
 				res.push_back(std::make_pair(toValue(nextToken, type), decorations));
@@ -561,7 +580,7 @@ bool IRParser::parseMethod()
     for (const auto& param : params) {
     	method.method->parameters.emplace_back(param.first.local->name, param.first.type, param.second);
     	//since with creating the Value for the parameter, a new local is allocated, we need to remove it
-    	const_cast<OrderedMap<std::string, Local>&>(method.method->readLocals()).erase(param.first.local->name);
+    	method.method->removeLocal(param.first.local->name);
     }
     if (!scanner.hasInput()) {
         return false;
@@ -622,8 +641,6 @@ bool IRParser::parseMethod()
     logging::debug() << "-----" << logging::endl;
     parseMethodBody(method);
     logging::debug() << "-----" << logging::endl;
-    mapInstructions(method);
-    logging::debug() << "-----" << logging::endl;
 
     return true;
 }
@@ -1710,9 +1727,68 @@ void IRParser::extractKernelInfo()
 	}
 }
 
+void IRParser::dropUnreachableMethods()
+{
+	//without any kernel, nothing is compiled anyway
+	if(std::none_of(methods.begin(), methods.end(), [](const LLVMMethod& m) -> bool { return m.method->isKernel; }))
+		return;
+	//only the kernels and the functions they (transitively) call are inlined and compiled.
+	//The inliner looks up the called functions by their exact name, so the same is done here
+	FastMap<std::string, std::vector<std::size_t>> methodsByName;
+	for(std::size_t i = 0; i < methods.size(); ++i)
+		methodsByName[methods[i].method->name].push_back(i);
+	std::vector<bool> isReachable(methods.size(), false);
+	std::vector<std::size_t> openMethods;
+	for(std::size_t i = 0; i < methods.size(); ++i)
+	{
+		if(methods[i].method->isKernel)
+		{
+			isReachable[i] = true;
+			openMethods.push_back(i);
+		}
+	}
+	while(!openMethods.empty())
+	{
+		const LLVMMethod& method = methods[openMethods.back()];
+		openMethods.pop_back();
+		for(const std::unique_ptr<LLVMInstruction>& instr : method.instructions)
+		{
+			const CallSite* call = dynamic_cast<const CallSite*>(instr.get());
+			if(call == nullptr)
+				continue;
+			auto it = methodsByName.find(call->getMethodName());
+			if(it == methodsByName.end())
+				continue;
+			for(const std::size_t index : it->second)
+			{
+				if(!isReachable[index])
+				{
+					isReachable[index] = true;
+					openMethods.push_back(index);
+				}
+			}
+		}
+	}
+
+	std::vector<LLVMMethod> reachableMethods;
+	reachableMethods.reserve(methods.size());
+	for(std::size_t i = 0; i < methods.size(); ++i)
+	{
+		if(isReachable[i])
+			reachableMethods.emplace_back(std::move(methods[i]));
+		else
+			logging::debug() << "Skipping function not called by any kernel: " << methods[i].method->name << logging::endl;
+	}
+	const std::size_t numSkipped = methods.size() - reachableMethods.size();
+	PROFILE_COUNTER(30, "Skipped unreachable functions", numSkipped);
+	logging::info() << "Skipped " << numSkipped << " of " << methods.size() << " functions not reachable from any kernel" << logging::endl;
+	methods = std::move(reachableMethods);
+}
+
 void IRParser::mapInstructions(LLVMMethod& method) const
 {
     logging::debug() << "Mapping LLVM instructions to immediates: " << logging::endl;
+    MemoryArena::Scope arenaScope(method.method->arena);
     for (const auto& instr : method.instructions) {
         instr->mapInstruction(*method.method);
     }
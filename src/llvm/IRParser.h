@@ -73,6 +73,7 @@ namespace vc4c
 
 			void parseMetaData();
 			void extractKernelInfo();
+			void dropUnreachableMethods();
 			IndexOf* parseGetElementPtr(LLVMMethod& method, const std::string& destination);
 
 			void mapInstructions(LLVMMethod& method) const;
@@ -8,14 +8,22 @@
 #include "Scanner.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstring>
+#include <iterator>
+#include <strings.h>
 
 using namespace vc4c;
 using namespace vc4c::llvm2qasm;
 
-Scanner::Scanner(std::istream& input) : lineNumber(0), rowNumber(0), input(input), lookAhead(false,{})
+static constexpr std::istream::traits_type::int_type END_OF_INPUT = std::istream::traits_type::eof();
+
+Scanner::Scanner(std::istream& input, bool bufferWholeInput) : lineNumber(0), rowNumber(0), input(input), lookAhead(false,{}), position(0), textStart(0),
+		internedStrings(new std::unordered_set<std::string>())
 {
+	if(bufferWholeInput)
+		buffer.reset(new std::string((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>()));
 }
 
 const Token Scanner::peek()
@@ -42,7 +50,7 @@ const Token Scanner::pop()
 
 bool Scanner::hasInput()
 {
-    return lookAhead.first || (input.peek() != std::istream::traits_type::eof() && input.peek() != '\0');
+    return lookAhead.first || (peekChar() != END_OF_INPUT && peekChar() != '\0');
 }
 
 std::string Scanner::getErrorPosition() const
@@ -58,10 +66,70 @@ unsigned int Scanner::getLineNumber() const
     return lineNumber;
 }
 
+Token Scanner::createToken(const std::string& text)
+{
+	Token token{};
+	token.type = TokenType::STRING;
+	const std::string& interned = *internedStrings->insert(text).first;
+	token.text = interned.data();
+	token.textLength = interned.size();
+	return token;
+}
+
+int Scanner::peekChar()
+{
+	if(buffer)
+		return position < buffer->size() ? static_cast<unsigned char>((*buffer)[position]) : END_OF_INPUT;
+	return input.peek();
+}
+
 int Scanner::skipChar()
 {
     ++rowNumber;
-    return input.get();
+    if(buffer)
+    	return position < buffer->size() ? static_cast<unsigned char>((*buffer)[position++]) : END_OF_INPUT;
+    const int c = input.get();
+    if(c != END_OF_INPUT)
+    	currentText.push_back(static_cast<char>(c));
+    return c;
+}
+
+void Scanner::putBackChar(const char c)
+{
+	--rowNumber;
+	if(buffer)
+		--position;
+	else
+	{
+		input.putback(c);
+		if(!currentText.empty())
+			currentText.pop_back();
+	}
+}
+
+void Scanner::startText()
+{
+	if(buffer)
+		textStart = position;
+	else
+		currentText.clear();
+}
+
+void Scanner::finishText(Token& token)
+{
+	token.type = TokenType::STRING;
+	if(buffer)
+	{
+		//no copy required, the token directly references the input
+		token.text = buffer->data() + textStart;
+		token.textLength = position - textStart;
+	}
+	else
+	{
+		const std::string& interned = *internedStrings->insert(currentText).first;
+		token.text = interned.data();
+		token.textLength = interned.size();
+	}
 }
 
 inline bool isStringCharacter(int c)
@@ -74,7 +142,7 @@ const Token Scanner::readToken()
     Token result{};
     //skip all leading white-spaces
     std::iostream::traits_type::int_type c;
-    while (std::isspace(c = input.peek())) {
+    while (std::isspace(c = peekChar())) {
         skipChar();
         if(c == '\n')   //end statement on line break
         {
@@ -85,7 +153,7 @@ const Token Scanner::readToken()
         }
     }
 
-    if(c == std::iostream::traits_type::eof() || c == '\0')
+    if(c == END_OF_INPUT || c == '\0')
     {
         result.type = TokenType::EMPTY;
         return result;
@@ -107,13 +175,15 @@ const Token Scanner::readToken()
     else if (isStringCharacter(c))   //text -> text or bool
     {
         bool inStringLiteral = c == '"';
-        std::array<char, TOKEN_BUFFER_SIZE> buffer{};
-        buffer.fill(0);
-        unsigned i = 0;
-        for(; i < TOKEN_BUFFER_SIZE; ++i)
+        startText();
+        char first = '\0';
+        std::size_t i = 0;
+        while(true)
         {
-            c = input.peek();
-            if(!inStringLiteral && i == 1 && (buffer[0] == '!' || buffer[0] == 'c') && c == '"')
+            c = peekChar();
+            if(c == END_OF_INPUT)
+                break;
+            if(!inStringLiteral && i == 1 && (first == '!' || first == 'c') && c == '"')
                 //some strings in LLVM start with '!"', others (string-constants) with 'c"'
                 inStringLiteral = true;
             if(inStringLiteral)
@@ -121,11 +191,10 @@ const Token Scanner::readToken()
                 //end string literal only after next '"'
                 //XXX improve by testing for \"
                 //test to not read string '!"' for a string starting with '!"'
-                if((buffer[0] == '"' ? i > 0 : i > 1) && c =='"')
+                if((first == '"' ? i > 0 : i > 1) && c =='"')
                 {
                     //include closing '"'
-                    buffer.at(i) = static_cast<char>(skipChar());
-                    ++i;
+                    skipChar();
                     break;
                 }
             }
@@ -133,78 +202,89 @@ const Token Scanner::readToken()
             {
                 break;
             }
-            buffer.at(i) = static_cast<char>(skipChar());
+            skipChar();
+            if(i == 0)
+                first = static_cast<char>(c);
+            ++i;
         }
-        if (strcasecmp("true", buffer.data()) == 0) // boolean true
+        finishText(result);
+        if (result.textLength == 4 && strncasecmp("true", result.text, 4) == 0) // boolean true
         {
             result.type = TokenType::BOOLEAN;
             result.flag = true;
         }
-        else if (strcasecmp("false", buffer.data()) == 0) // boolean false
+        else if (result.textLength == 5 && strncasecmp("false", result.text, 5) == 0) // boolean false
         {
             result.type = TokenType::BOOLEAN;
             result.flag = false;
         }
-        else // some other text
-        {
-            result.type = TokenType::STRING;
-            memcpy(result.text.data(), buffer.data(), i);
-        }
         return result;
     }
         //special character
     else {
-        result.type = TokenType::STRING;
+        startText();
         //special treatment for '+' and '-' -> could start number
         if (c == '+' || c == '-') {
             skipChar();
-            auto d = input.peek();
+            auto d = peekChar();
             if (std::isdigit(d)) {
                 //start of number
-                input.putback(static_cast<char>(c));
+                putBackChar(static_cast<char>(c));
                 return readNumber();
             }
             else if(d == c)     //++ or --
             {
                 skipChar();
-                result.text[0] = static_cast<char>(c);
-                result.text[1] = static_cast<char>(c);
-            }
-            else //operator
-            {
-                result.text[0] = static_cast<char>(c);
             }
         }
             //other single character tokens
         else if (c == '(' || c == ')' || c == '*' || c == ':' || c == ',' || c == '[' || c == ']' 
                  || c == '=' || c == '{' || c == '}' || c == '<' || c == '>') {
             skipChar();
-            result.text[0] = static_cast<char>(c);
         }
+        finishText(result);
         return result;
     }
     throw CompilationError(CompilationStep::SCANNER, lineNumber, std::string("Invalid character:") + static_cast<char>(c));
 }
 
+static bool isNumberCharacter(int c)
+{
+	return std::isalnum(c) || c == '.' || c == '-' || c == '+';
+}
+
 const Token Scanner::readNumber()
 {
     Token result{};
     std::string numberToken;
-    while(std::isalnum(input.peek()) || input.peek() == '.' || input.peek() == '-' || input.peek() == '+')
+    const char* number = nullptr;
+    if(buffer)
     {
-        ++rowNumber;
-        numberToken.push_back(static_cast<char>(input.get()));
+    	//the buffer is null-terminated and the number is followed by a character the conversion functions do not accept
+    	number = buffer->data() + position;
+    	while(isNumberCharacter(peekChar()))
+    		skipChar();
     }
+    else
+    {
+		while(isNumberCharacter(input.peek()))
+		{
+			++rowNumber;
+			numberToken.push_back(static_cast<char>(input.get()));
+		}
+		number = numberToken.data();
+    }
+    const std::size_t length = buffer ? static_cast<std::size_t>(buffer->data() + position - number) : numberToken.size();
     result.type = TokenType::NUMBER;
-    if(numberToken.find_first_of("e.p") != std::string::npos)
+    if(std::find_if(number, number + length, [](char c) -> bool { return c == 'e' || c == '.' || c == 'p';}) != number + length)
     {
         //floating literal
-        result.real = std::strtod(numberToken.data(), nullptr);
+        result.real = std::strtod(number, nullptr);
     }
     else
     {
         //integer literal
-        result.integer = std::strtoll(numberToken.data(), nullptr, 0 /* let method decide */);
+        result.integer = std::strtoll(number, nullptr, 0 /* let method decide */);
     }
     //so our index is correct again
     result.type = TokenType::NUMBER;
@@ -215,10 +295,8 @@ const Token Scanner::readLine()
 {
     std::iostream::traits_type::int_type c;
     Token line{};
-    line.type = TokenType::STRING;
-    memset(line.text.data(), '\0', TOKEN_BUFFER_SIZE);
-    std::size_t i = 0;
-    while ((c = input.peek()) != std::iostream::traits_type::eof() && c != '\0')
+    startText();
+    while ((c = peekChar()) != END_OF_INPUT && c != '\0')
     {
         if(c == '\n')   //end statement on line break
         {
@@ -226,7 +304,8 @@ const Token Scanner::readLine()
             rowNumber = 0;
             break;
         }
-        line.text.at(i++) = static_cast<char>(skipChar());
+        skipChar();
     }
+    finishText(line);
     return line;
 }
@@ -10,7 +10,9 @@
 #include "Token.h"
 
 #include <iostream>
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 
 namespace vc4c
@@ -19,11 +21,18 @@ namespace vc4c
 	namespace llvm2qasm
 	{
 
+		/*
+		 * Splits LLVM IR code into tokens.
+		 *
+		 * By default, the input is read from the stream character by character and the texts of the tokens are interned.
+		 * If the whole input is buffered, it is read at once and the tokens directly reference their text within the buffered input,
+		 * which is a lot faster for big inputs. In this mode, any input written to the stream after the construction of the scanner is ignored.
+		 */
 		class Scanner
 		{
 		public:
 
-			explicit Scanner(std::istream& input = std::cin);
+			explicit Scanner(std::istream& input = std::cin, bool bufferWholeInput = false);
 			Scanner(const Scanner& orig) = default;
 			~Scanner()= default;
 
@@ -37,6 +46,11 @@ namespace vc4c
 
 			unsigned int getLineNumber() const;
 
+			/*
+			 * Creates a STRING token with the given text, which is not part of the input
+			 */
+			Token createToken(const std::string& text);
+
 		private:
 			unsigned int lineNumber;
 			unsigned int rowNumber;
@@ -44,13 +58,26 @@ namespace vc4c
 			std::istream& input;
 			std::pair<bool, Token> lookAhead;
 
+			//the whole input, if buffered. This is shared with all copies of this scanner, since the tokens reference it
+			std::shared_ptr<const std::string> buffer;
+			std::size_t position;
+			//the characters read from the stream for the current token, if not buffered
+			std::string currentText;
+			std::size_t textStart;
+			//the texts of all tokens read from the stream. Shared with all copies for the same reason as above
+			std::shared_ptr<std::unordered_set<std::string>> internedStrings;
+
 			const Token readToken();
 
 			const Token readNumber();
 
+			int peekChar();
 			int skipChar();
+			void putBackChar(char c);
+
+			void startText();
+			void finishText(Token& token);
 		};
 	} // namespace llvm2qasm
 } // namespace vc4c
 #endif /* SCANNER_H */
-
@@ -10,15 +10,14 @@
 #include "CompilationError.h"
 #include "Optional.h"
 
-#include <array>
+#include <cstring>
+#include <string>
 
 namespace vc4c
 {
 
 	namespace llvm2qasm
 	{
-		static constexpr unsigned int TOKEN_BUFFER_SIZE { 2048 };
-
 		enum class TokenType
 			: unsigned char
 			{
@@ -56,7 +55,7 @@ namespace vc4c
 					case TokenType::NUMBER:
 						return std::to_string(integer);
 					case TokenType::STRING:
-						return text.data();
+						return std::string(text, textLength);
 					case TokenType::EMPTY:
 						return "(empty)";
 					case TokenType::END:
@@ -68,22 +67,29 @@ namespace vc4c
 
 			bool hasValue(const std::string& val) const
 			{
-				return type == TokenType::STRING && val.compare(text.data()) == 0;
+				return type == TokenType::STRING && val.size() == textLength && (textLength == 0 || memcmp(val.data(), text, textLength) == 0);
 			}
 
 			bool hasValue(char val) const
 			{
-				return type == TokenType::STRING && text[0] == val;
+				return type == TokenType::STRING && textLength > 0 && text[0] == val;
 			}
 
 			Optional<std::string> getText() const
 			{
 				if (type == TokenType::STRING)
-					return std::string(text.data());
+					return std::string(text, textLength);
 				return {};
 			}
 		private:
-			std::array<char, TOKEN_BUFFER_SIZE> text;
+			/*
+			 * The text of STRING tokens (not null-terminated).
+			 *
+			 * This points either directly into the input buffered by the scanner or into the strings interned by the scanner,
+			 * so the token stays valid as long as the scanner (or any copy of it) exists
+			 */
+			const char* text;
+			std::size_t textLength;
 
 			friend class Scanner;
 			friend class IRParser;
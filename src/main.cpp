@@ -6,6 +6,7 @@
 
 #include "Compiler.h"
 #include "Precompiler.h"
+#include "ProcessUtil.h"
 #include "Profiler.h"
 #include "concepts.h"
 #include "config.h"
@@ -40,6 +41,12 @@ static void printHelp()
 	std::cout << "\t--no-kernel-info\tDont write the kernel-info meta-data" << std::endl;
 	std::cout << "\t--spirv\t\t\tExplicitely use the SPIR-V front-end" << std::endl;
 	std::cout << "\t--llvm\t\t\tExplicitely use the LLVM-IR front-end" << std::endl;
+	std::cout << "\t--threads=<n>\t\tUses at most n threads to optimize the kernels in parallel, 0 for one thread per core (default)" << std::endl;
+	std::cout << "\t--cache\t\t\tLooks up and stores the compilation result in the persistent compilation cache" << std::endl;
+	std::cout << "\t--frontend-helper\tRuns the pre-compiler programs via a long-living helper process" << std::endl;
+	std::cout << "\t--linear-scan\t\tUses the faster linear-scan register-allocator instead of graph coloring" << std::endl;
+	std::cout << "\t--parallel-frontend\tMaps the functions of the input to intermediate code in parallel" << std::endl;
+	std::cout << "\t--instrumentation=<file>\tWrites the duration and resource usage of all compilation steps as JSON into the given file" << std::endl;
 	std::cout << "\t--disassemble\t\tDisassembles the binary input to either hex or assembler output" << std::endl;
 	std::cout << "\tany other option is passed to the pre-compiler" << std::endl;
 }
@@ -170,6 +177,19 @@ int main(int argc, char** argv)
         	config.frontend = Frontend::SPIR_V;
         else if(strcmp("--llvm", argv[i]) == 0)
         	config.frontend = Frontend::LLVM_IR;
+        else if(strncmp("--threads=", argv[i], strlen("--threads=")) == 0)
+        	config.numThreads = static_cast<unsigned>(std::strtoul(argv[i] + strlen("--threads="), nullptr, 10));
+        else if(strcmp("--cache", argv[i]) == 0)
+        	config.useCompilationCache = true;
+        else if(strcmp("--frontend-helper", argv[i]) == 0)
+        	//the helper needs to be forked before any other thread is started
+        	helper::startProcessHelper();
+        else if(strcmp("--linear-scan", argv[i]) == 0)
+        	config.registerAllocator = RegisterAllocator::LINEAR_SCAN;
+        else if(strcmp("--parallel-frontend", argv[i]) == 0)
+        	config.parallelFrontend = true;
+        else if(strncmp("--instrumentation=", argv[i], strlen("--instrumentation=")) == 0)
+        	config.instrumentationReport = argv[i] + strlen("--instrumentation=");
         else if(strcmp("--disassemble", argv[i]) == 0)
         	runDisassembler = true;
         else if(strcmp("-o", argv[i]) == 0)
@@ -12,6 +12,8 @@
 #include "../intermediate/TypeConversions.h"
 #include "log.h"
 
+#include <algorithm>
+
 using namespace vc4c;
 using namespace vc4c::optimizations;
 
@@ -28,8 +30,102 @@ static const Method* matchSignatures(const std::vector<std::unique_ptr<Method>>&
     return nullptr;
 }
 
-static Method& inlineMethod(const std::string& localPrefix, const std::vector<std::unique_ptr<Method>>& methods, Method& currentMethod)
+/*
+ * The cached body of a function to be inlined.
+ *
+ * The template is created when the function is inlined for the first time, after all calls within the function itself have been inlined
+ * and all instructions whose results are never used have been removed.
+ * So for every further call-site, the body is copied as-is without walking the function for calls or dead instructions again.
+ */
+struct InlineTemplate
+{
+	//the instructions to copy into every call-site, the label is omitted for straight-line bodies
+	std::vector<const intermediate::IntermediateInstruction*> body;
+	//whether the body is a single basic block without branches ending with the only return
+	bool isStraightLine;
+	//the number of instructions removed from the body, which are therefore not copied into any call-site
+	std::size_t numRemovedInstructions;
+};
+
+struct InliningContext
 {
+	const std::vector<std::unique_ptr<Method>>& methods;
+	FastMap<const Method*, InlineTemplate> templates;
+
+	//statistics
+	std::size_t numCallSites = 0;
+	std::size_t numStraightLineCallSites = 0;
+	std::size_t numTemplateHits = 0;
+	std::size_t numInlinedInstructions = 0;
+	std::size_t numOmittedInstructions = 0;
+
+	explicit InliningContext(const std::vector<std::unique_ptr<Method>>& methods) : methods(methods) { }
+};
+
+static Method& inlineMethod(const std::string& localPrefix, InliningContext& context, Method& currentMethod);
+
+/*
+ * Removes all instructions without side-effects whose output is never read.
+ *
+ * The kernel is cleaned up the same way by the dead-store elimination, but doing it once for the function to be inlined
+ * avoids copying these instructions into every call-site.
+ */
+static std::size_t removeUnusedInstructions(Method& method)
+{
+	std::size_t numRemoved = 0;
+	auto it = method.walkAllInstructions();
+	while(!it.isEndOfMethod())
+	{
+		if((it.has<intermediate::Operation>() || it.has<intermediate::MoveOperation>() || it.has<intermediate::LoadImmediate>()) && it->hasValueType(ValueType::LOCAL) &&
+				!it->hasSideEffects() && !it->getOutput()->local->is<Parameter>() && it->getOutput()->local->getUsers(LocalUse::Type::READER).empty())
+		{
+			logging::debug() << "Removing instruction " << it->to_string() << " from function to be inlined, since its output is never read" << logging::endl;
+			it.erase();
+			++numRemoved;
+			//the removed instruction might have been the only reader of the previous instruction's output
+			it.previousInBlock();
+			continue;
+		}
+		it.nextInMethod();
+	}
+	return numRemoved;
+}
+
+static const InlineTemplate& getInlineTemplate(const std::string& localPrefix, InliningContext& context, Method& callee)
+{
+	auto it = context.templates.find(&callee);
+	if(it != context.templates.end())
+	{
+		++context.numTemplateHits;
+		return it->second;
+	}
+	//recursively search for used methods
+	inlineMethod(localPrefix, context, callee);
+	//at this point, the called method has already inlined all other methods
+
+	InlineTemplate calleeTemplate{{}, callee.getBasicBlocks().size() == 1, removeUnusedInstructions(callee)};
+	std::size_t numReturns = 0;
+	callee.forAllInstructions([&calleeTemplate, &numReturns](const intermediate::IntermediateInstruction* instr) -> void
+	{
+		if(dynamic_cast<const intermediate::Return*>(instr) != nullptr)
+			++numReturns;
+		if(dynamic_cast<const intermediate::Branch*>(instr) != nullptr)
+			calleeTemplate.isStraightLine = false;
+		calleeTemplate.body.push_back(instr);
+	});
+	calleeTemplate.isStraightLine = calleeTemplate.isStraightLine && numReturns == 1 && !calleeTemplate.body.empty() && dynamic_cast<const intermediate::Return*>(calleeTemplate.body.back()) != nullptr;
+	if(calleeTemplate.isStraightLine && dynamic_cast<const intermediate::BranchLabel*>(calleeTemplate.body.front()) != nullptr)
+		//the label of the single block of a straight-line body is not required
+		calleeTemplate.body.erase(calleeTemplate.body.begin());
+	logging::debug() << "Created inline template for " << callee.name << " with " << calleeTemplate.body.size() << " instructions" << (calleeTemplate.isStraightLine ? " (straight-line)" : "")
+			<< ", removed " << calleeTemplate.numRemovedInstructions << " unused instructions" << logging::endl;
+	return context.templates.emplace(&callee, std::move(calleeTemplate)).first->second;
+}
+
+static Method& inlineMethod(const std::string& localPrefix, InliningContext& context, Method& currentMethod)
+{
+	//the inlined instructions belong to this method, also if it is itself a function called by the kernel
+	MemoryArena::Scope arenaScope(currentMethod.arena);
 	auto it = currentMethod.walkAllInstructions();
     while(!it.isEndOfMethod())
     {
@@ -38,15 +134,26 @@ static Method& inlineMethod(const std::string& localPrefix, const std::vector<st
         if(call != nullptr)
         {
             //search for method with matching signature
-            const Method* calledMethod = matchSignatures(methods, call);
+            const Method* calledMethod = matchSignatures(context.methods, call);
             if(calledMethod != nullptr)
             {
                 const std::size_t numInstructions = currentMethod.countInstructions();
-                //recursively search for used methods
                 const std::string newLocalPrefix = localPrefix + (!(call->getReturnType() == TYPE_VOID) ? call->getOutput()->local->name : std::string("%") + (calledMethod->name + ".") + std::to_string(rand())) + '.';
-                const Local* methodEndLabel = currentMethod.findOrCreateLocal(TYPE_LABEL, newLocalPrefix + "after");
-                inlineMethod(newLocalPrefix, methods, const_cast<Method&>(*calledMethod));
-                //at this point, the called method has already inlined all other methods
+                const InlineTemplate& calleeTemplate = getInlineTemplate(newLocalPrefix, context, const_cast<Method&>(*calledMethod));
+
+                //since the VideoCore IV has no call instructions, every call needs to be inlined
+                const bool isStraightLine = calleeTemplate.isStraightLine;
+                ++context.numCallSites;
+                //the instructions removed from the template are not copied into this call-site
+                context.numOmittedInstructions += calleeTemplate.numRemovedInstructions;
+                if(isStraightLine)
+                {
+                	//no labels and no branches are required, which also keeps the basic block of the caller intact for the following optimizations
+                	++context.numStraightLineCallSites;
+                	//the label of the body and the label after the call-site
+                	context.numOmittedInstructions += 2;
+                }
+                const Local* methodEndLabel = isStraightLine ? nullptr : currentMethod.findOrCreateLocal(TYPE_LABEL, newLocalPrefix + "after");
             
                 //Starting at lowest level (here), insert in parent
                 //map parameters to arguments
@@ -76,7 +183,7 @@ static Method& inlineMethod(const std::string& localPrefix, const std::vector<st
                 	currentMethod.findOrCreateLocal(arg.type, newLocalPrefix + arg.name);
                 }
                 //insert instructions
-                calledMethod->forAllInstructions([&it, &currentMethod, &methodEndLabel, &newLocalPrefix, &call](const intermediate::IntermediateInstruction* instr) -> void
+                for(const intermediate::IntermediateInstruction* instr : calleeTemplate.body)
                 {
                     const intermediate::Return* ret = dynamic_cast<const intermediate::Return*>(instr);
                     if(ret != nullptr)
@@ -93,28 +200,43 @@ static Method& inlineMethod(const std::string& localPrefix, const std::vector<st
                             it.emplace(new intermediate::MoveOperation(call->getOutput().value(), retVal));
                             it.nextInMethod();
                         }
-                        //after each return, jump to label after call-site (since there may be several return statements in a method)
-                        it.emplace(new intermediate::Branch(methodEndLabel, COND_ALWAYS, BOOL_TRUE));
+                        if(isStraightLine)
+                        	//the branch to the label after the call-site is not required
+                        	++context.numOmittedInstructions;
+                        else
+                        {
+                        	//after each return, jump to label after call-site (since there may be several return statements in a method)
+                        	it.emplace(new intermediate::Branch(methodEndLabel, COND_ALWAYS, BOOL_TRUE));
+                        	it.nextInMethod();
+                        }
+                    }
+                    else if(dynamic_cast<const intermediate::BranchLabel*>(instr) != nullptr)
+                    {
+                    	it = currentMethod.emplaceLabel(it, dynamic_cast<intermediate::BranchLabel*>(instr->copyFor(currentMethod, newLocalPrefix)));
+                    	it.nextInMethod();
                     }
                     else
                     {
                         //prefix locals with destination of call
                         //copy instructions
-                    	if(dynamic_cast<const intermediate::BranchLabel*>(instr) != nullptr)
-                    		it = currentMethod.emplaceLabel(it, dynamic_cast<intermediate::BranchLabel*>(instr->copyFor(currentMethod, newLocalPrefix)));
-                    	else
-                    		it.emplace(instr->copyFor(currentMethod, newLocalPrefix));
+                    	it.emplace(instr->copyFor(currentMethod, newLocalPrefix));
+                    	it.nextInMethod();
                     }
-                    it.nextInMethod();
-                });
+                }
                 if(it.get() != call)
                 {
                     throw CompilationError(CompilationStep::OPTIMIZER, "Method call expected, got", it->to_string());
                 }
-                logging::debug() << "Function body for " << call->to_string() << " inlined, added " << (currentMethod.countInstructions() - 1 - numInstructions) << " instructions" << logging::endl;
-                //replace method-call from parent with label to jump to (for returns)
+                const std::size_t numInlinedInstructions = currentMethod.countInstructions() - 1 - numInstructions;
+                context.numInlinedInstructions += numInlinedInstructions;
+                logging::debug() << "Function body for " << call->to_string() << " inlined, added " << numInlinedInstructions << " instructions" << logging::endl;
                 it = it.erase();
-                it = currentMethod.emplaceLabel(it, new intermediate::BranchLabel(*methodEndLabel));
+                if(isStraightLine)
+                	//continue with the instruction following the call-site, the inlined instructions contain no more calls to be inlined
+                	it.previousInBlock();
+                else
+                	//replace method-call from parent with label to jump to (for returns)
+                	it = currentMethod.emplaceLabel(it, new intermediate::BranchLabel(*methodEndLabel));
             }
         }
         it.nextInMethod();
@@ -127,7 +249,17 @@ void optimizations::inlineMethods(const Module& module, Method& kernel, const Co
 {
     logging::info() << "-----" << logging::endl;
     logging::info() << "Inlining functions for kernel: " << kernel.name << logging::endl;
+    PROFILE_START(inlineMethods);
+    InliningContext context(module.methods);
     //Starting at kernel
-    inlineMethod("", module.methods, kernel);
+    inlineMethod("", context, kernel);
+    PROFILE_END(inlineMethods);
+    PROFILE_COUNTER(120, "Inlined call-sites", context.numCallSites);
+    PROFILE_COUNTER(121, "Inlined straight-line call-sites", context.numStraightLineCallSites);
+    PROFILE_COUNTER(122, "Inlined instructions", context.numInlinedInstructions);
+    PROFILE_COUNTER(123, "Inline omitted instructions", context.numOmittedInstructions);
+    logging::info() << "Inlined " << context.numCallSites << " call-sites (" << context.numStraightLineCallSites << " without branches) of " << context.templates.size()
+    		<< " functions (" << context.numTemplateHits << " re-used), adding " << context.numInlinedInstructions << " and omitting " << context.numOmittedInstructions
+    		<< " instructions" << logging::endl;
     logging::info() << "-----" << logging::endl;
 }
@@ -6,6 +6,8 @@
 
 #include "MemoryAccess.h"
 
+#include "../analysis/ControlFlowGraph.h"
+#include "../analysis/LivenessAnalysis.h"
 #include "../intermediate/IntermediateInstruction.h"
 #include "../periphery/TMU.h"
 #include "../periphery/VPM.h"
@@ -445,7 +447,7 @@ InstructionWalker optimizations::accessGlobalData(const Module& module, Method&
 	 */
 	for(std::size_t i = 0; i < it->getArguments().size(); ++i)
 	{
-		const auto& arg = it->getArgument(i).value();
+		const Value arg = it->getArgument(i).value();
 		if(arg.hasType(ValueType::LOCAL) && arg.local->is<Global>())
 		{
 			const Optional<unsigned int> globalOffset = module.getGlobalDataOffset(arg.local);
@@ -471,72 +473,311 @@ InstructionWalker optimizations::accessGlobalData(const Module& module, Method&
 	return it;
 }
 
+//the physical registers of both register-files and the general purpose accumulators r0 to r3
+static constexpr std::size_t NUM_AVAILABLE_REGISTERS = 2 * 32 + 4;
+//leave some registers free for the temporaries introduced by the following optimizations and the code generation
+static constexpr std::size_t MAX_REGISTER_PRESSURE = NUM_AVAILABLE_REGISTERS - 8;
+//accesses within loops are executed several times and therefore weigh more
+static constexpr double LOOP_USE_WEIGHT = 8.0;
+//the local holding the VPM setup-value, shared by all accesses to spilled locals
+static const std::string SPILL_SETUP_NAME = "%spill_setup";
+
+/*
+ * The number of QPUs running the method in parallel, each requiring its own copy of the stack and spilled locals
+ */
+static unsigned getNumQPUs(const Method& method)
+{
+	return method.metaData.isWorkGroupSizeSet() ? std::accumulate(method.metaData.workGroupSizes.begin(), method.metaData.workGroupSizes.end(), 1u, std::multiplies<uint32_t>()) : 12;
+}
+
+/*
+ * Returns whether the instruction or any of the operations combined into it matches the predicate
+ */
+static bool anyOperation(const IntermediateInstruction* inst, const std::function<bool(const IntermediateInstruction*)>& predicate)
+{
+	if(const CombinedOperation* comp = dynamic_cast<const CombinedOperation*>(inst))
+		return (comp->op1 && predicate(comp->op1.get())) || (comp->op2 && predicate(comp->op2.get()));
+	return predicate(inst);
+}
+
+SpillCosts::SpillCosts(Method& method, ControlFlowGraph& cfg) : accessCosts(method.readLocals().size(), 0.0), spillable(method.readLocals().size(), true),
+		maxSpilledLocals(method.vpm->getMaxSpillingRegisters(getNumQPUs(method)))
+{
+	//the loops found are the strongly connected components, so the weight does not depend on the nesting depth
+	FastSet<const BasicBlock*> loopBlocks;
+	for(const auto& loop : cfg.findLoops())
+	{
+		for(const CFGNode* node : loop)
+			loopBlocks.insert(node->key);
+	}
+
+	for(BasicBlock& block : method)
+	{
+		const double weight = loopBlocks.find(&block) != loopBlocks.end() ? LOOP_USE_WEIGHT : 1.0;
+		/*
+		 * The reload of a spilled local overwrites the generic VPM read setup and the store overwrites the generic VPM write setup.
+		 * So a local can't be spilled, if it is reloaded between a generic read setup and a following VPM read (or stored between a generic write setup
+		 * and a following VPM write) of the same VPM access. Since the spilled rows are separate for every QPU, the hardware mutex is of no concern.
+		 * Similarly, all spill accesses share the local holding the setup-value, which must not be overwritten between its load and its use.
+		 */
+		FastSet<const Local*> reloadedInReadAccess;
+		FastSet<const Local*> storedInWriteAccess;
+		FastSet<const Local*> usedWithSpillSetup;
+		bool spillSetupLoaded = false;
+		for(InstructionWalker it = block.begin(); !it.isEndOfBlock(); it.nextInBlock())
+		{
+			if(it.get() == nullptr)
+				continue;
+			const bool isRotationOrBranch = it.has<VectorRotation>() || it.has<Branch>();
+			const bool isPartialWrite = it->conditional != COND_ALWAYS || it->hasDecoration(InstructionDecorations::ELEMENT_INSERTION);
+			bool readsSpillSetup = false;
+			it->forUsedLocals([&](const Local* local, const LocalUse::Type type) -> void
+			{
+				if(local->name == SPILL_SETUP_NAME)
+				{
+					if(has_flag(type, LocalUse::Type::WRITER))
+					{
+						spillSetupLoaded = true;
+						usedWithSpillSetup.clear();
+					}
+					readsSpillSetup = readsSpillSetup || has_flag(type, LocalUse::Type::READER);
+					return;
+				}
+				//parameters, globals and stack-allocations have no local-index and can't be spilled anyway
+				const Optional<std::size_t> index = local->getLocalIndex();
+				if(!index)
+					return;
+				accessCosts[index.value()] += weight;
+				if(isRotationOrBranch && has_flag(type, LocalUse::Type::READER))
+					spillable[index.value()] = false;
+				if(has_flag(type, LocalUse::Type::READER) || isPartialWrite)
+					reloadedInReadAccess.insert(local);
+				if(has_flag(type, LocalUse::Type::WRITER))
+					storedInWriteAccess.insert(local);
+				if(spillSetupLoaded)
+					usedWithSpillSetup.insert(local);
+			});
+			if(readsSpillSetup)
+			{
+				markUnspillable(usedWithSpillSetup);
+				spillSetupLoaded = false;
+			}
+			if(anyOperation(it.get(), [](const IntermediateInstruction* inst) -> bool { return inst->readsRegister(REG_VPM_IO);}))
+				markUnspillable(reloadedInReadAccess);
+			if(anyOperation(it.get(), [](const IntermediateInstruction* inst) -> bool { return inst->writesRegister(REG_VPM_IO);}))
+				markUnspillable(storedInWriteAccess);
+			//a new generic setup starts a new VPM access, DMA and stride setups do not affect the generic setups
+			if(anyOperation(it.get(), [](const IntermediateInstruction* inst) -> bool
+			{
+				return inst->writesRegister(REG_VPM_IN_SETUP) && (!dynamic_cast<const LoadImmediate*>(inst) ||
+						VPRSetup::fromLiteral(dynamic_cast<const LoadImmediate*>(inst)->getImmediate().unsignedInt()).isGenericSetup());
+			}))
+				reloadedInReadAccess.clear();
+			if(anyOperation(it.get(), [](const IntermediateInstruction* inst) -> bool
+			{
+				return inst->writesRegister(REG_VPM_OUT_SETUP) && (!dynamic_cast<const LoadImmediate*>(inst) ||
+						VPWSetup::fromLiteral(dynamic_cast<const LoadImmediate*>(inst)->getImmediate().unsignedInt()).isGenericSetup());
+			}))
+				storedInWriteAccess.clear();
+		}
+	}
+}
+
+void SpillCosts::markUnspillable(const FastSet<const Local*>& locals)
+{
+	for(const Local* local : locals)
+	{
+		const Optional<std::size_t> index = local->getLocalIndex();
+		if(index)
+			spillable[index.value()] = false;
+	}
+}
+
+bool SpillCosts::isSpillable(const Local* local) const
+{
+	const Optional<std::size_t> index = local->getLocalIndex();
+	return index && index.value() < spillable.size() && spillable[index.value()] && local->type != TYPE_LABEL && local->name.find("%spill") != 0;
+}
+
+double SpillCosts::getAccessCosts(const Local* local) const
+{
+	const Optional<std::size_t> index = local->getLocalIndex();
+	return index && index.value() < accessCosts.size() ? accessCosts[index.value()] : 0.0;
+}
+
+std::vector<std::pair<const Local*, double>> SpillCosts::selectCheapest(std::vector<std::pair<const Local*, double>> candidates, const std::size_t maxNumLocals) const
+{
+	std::sort(candidates.begin(), candidates.end(), [](const std::pair<const Local*, double>& p1, const std::pair<const Local*, double>& p2) -> bool { return p1.second < p2.second;});
+	candidates.resize(std::min(std::min(maxNumLocals, maxSpilledLocals), candidates.size()));
+	return candidates;
+}
+
 void optimizations::spillLocals(const Module& module, Method& method, const Configuration& config)
 {
-	static const std::size_t MINIMUM_THRESHOLD = 128; /* TODO some better limit */
-	//TODO need to know how much of the VPM is still free (need per-kernel VPM object)
-	//also need to heed not to write/read into/from VPM from within a block of DMA reads/writes
-	//XXX or revert: run this before #combineVPMAccess and reserve as much VPM as required (dynamically, how? or first determine size, then spill)
-	//and use the remainder for #combineVPMAccess
-	//also need to regard writing into VPM (without DMA) for #combineVPMAccess, so the VPM configurations do not conflict
+	PROFILE_START(spillLocals);
+	auto blockGraph = ControlFlowGraph::createCFG(method);
+
+	/*
+	 * 1. calculate the spilling costs of all locals
+	 */
+	const SpillCosts costs(method, blockGraph);
 
 	/*
-	 * 1. find all candidate locals for spilling:
-	 * - no labels (since they are never mapped to registers)
-	 * - only one write (for now, for easier handling)
-	 * - not used only locally within a minimum range, since those locals are more likely to be mapped to registers
+	 * 2. estimate the register pressure at every program point as the number of locals live after every write.
+	 * For every local, count the number of points with too high pressure it is live at.
+	 * Parameters are live too, but can't be spilled, since they are only written by the start-segment added later
 	 */
-	//tracks the locals and their writing instructions
-	FastMap<const Local*, InstructionWalker> spillingCandidates;
-	for(const auto& pair : method.readLocals())
+	const analysis::LivenessAnalysis liveness(method, blockGraph);
+	std::vector<std::size_t> numConflictingPoints(liveness.getNumLocals(), 0);
+	std::size_t maxPressure = 0;
+	for(BasicBlock& block : method)
 	{
-		if(pair.second.type == TYPE_LABEL)
-			continue;
-		//XXX for now, only select locals which are written just once
-		//or maybe never (not yet), e.g. for hidden parameter
-		//or written several times but read only once
-		//TODO also include explicit parameters
-		auto numWrites = pair.second.getUsers(LocalUse::Type::WRITER).size();
-		auto numReads = pair.second.getUsers(LocalUse::Type::READER).size();
-		if((numWrites <= 1 && numReads > 0) || (numWrites >= 1 && numReads == 1))
+		analysis::LocalSet live = liveness.getLiveOut(&block);
+		liveness.walkBlockBackwards(block, live, [&numConflictingPoints, &maxPressure](std::size_t writtenIndex, const analysis::LocalSet& liveLocals) -> void
 		{
-			spillingCandidates.emplace(&pair.second, InstructionWalker{});
-		}
+			//the written local occupies a register, even if it is never read afterwards
+			const std::size_t pressure = liveLocals.size() + (liveLocals.contains(writtenIndex) ? 0 : 1);
+			maxPressure = std::max(maxPressure, pressure);
+			if(pressure <= MAX_REGISTER_PRESSURE)
+				return;
+			liveLocals.forEach([&numConflictingPoints](std::size_t index) -> void
+			{
+				++numConflictingPoints[index];
+			});
+		});
+	}
+	PROFILE_COUNTER(8020, "Maximum register pressure", maxPressure);
+	logging::debug() << "Maximum register pressure for method '" << method.name << "' is " << maxPressure << logging::endl;
+	if(maxPressure <= MAX_REGISTER_PRESSURE)
+	{
+		PROFILE_END(spillLocals);
+		return;
 	}
 
-	InstructionWalker it = method.walkAllInstructions();
-	//skip all leading empty basic blocks
-	while(!it.isEndOfMethod() && it.has<intermediate::BranchLabel>())
-		it.nextInMethod();
-	auto candIt = spillingCandidates.begin();
-	while(!it.isEndOfMethod() && candIt != spillingCandidates.end())
+	/*
+	 * 3. select the cheapest locals live at the points with too high pressure.
+	 * The costs are the accesses to the local relative to the number of conflicting points it is live at, so locals living long without being accessed are preferred
+	 */
+	std::vector<std::pair<const Local*, double>> candidates;
+	for(const Local* local : method.readLocals())
 	{
-		//check if only read the first X instructions (from the start of the kernel), e.g. for (hidden) parameter, where the next check fails,
-		//since they are not yet written anywhere
-		if(method.isLocallyLimited(it, candIt->first, MINIMUM_THRESHOLD))
-			candIt = spillingCandidates.erase(candIt);
-		else
-			++candIt;
+		const std::size_t numPoints = numConflictingPoints[liveness.getIndex(local).value()];
+		if(numPoints == 0 || !costs.isSpillable(local))
+			continue;
+		candidates.emplace_back(local, costs.getAccessCosts(local) / static_cast<double>(numPoints));
 	}
-	while(!it.isEndOfMethod() && !spillingCandidates.empty())
+	candidates = costs.selectCheapest(std::move(candidates), maxPressure - MAX_REGISTER_PRESSURE);
+
+	/*
+	 * 4. spill the selected locals into the VPM, the number of locals selected already fits into the free VPM space
+	 */
+	FastSet<const Local*> spilledLocals;
+	for(const auto& pair : candidates)
+		spilledLocals.insert(pair.first);
+	if(spillLocalsToVPM(method, spilledLocals))
 	{
-		//TODO if at some point all Basic block have references to their used locals, remove all locals which are used just in one basic block instead of this logic??
-		if(it->hasValueType(ValueType::LOCAL) && spillingCandidates.find(it->getOutput()->local) != spillingCandidates.end())
-		{
-			if(method.isLocallyLimited(it, it->getOutput()->local, MINIMUM_THRESHOLD))
-				spillingCandidates.erase(it->getOutput()->local);
-			else
-				spillingCandidates.at(it->getOutput()->local) = it;
-		}
-		it.nextInMethod();
+		for(const auto& pair : candidates)
+			logging::debug() << "Spilled local: " << pair.first->to_string() << " with costs " << pair.second << logging::endl;
 	}
+	else
+		candidates.clear();
+	PROFILE_END(spillLocals);
+	PROFILE_COUNTER(8030, "Preemptively spilled locals", candidates.size());
+}
 
-	for(const auto& pair : spillingCandidates)
+/*
+ * Inserts the access of a spilled local at the given position and returns the position after the inserted instructions
+ */
+static InstructionWalker insertSpillAccess(Method& method, InstructionWalker it, const Value& setupRegister, const uint32_t setupValue, const Value& dest, const Value& src)
+{
+	//the VPM address is the lower part of the setup-value and the copies for the single QPUs are stored in consecutive rows,
+	//so adding the QPU number directly selects the row to access without keeping any offset in a register.
+	//All accesses share the same local for the setup-value, so the instruction scheduling can't move the loads away from their uses
+	//and increase the register pressure
+	const Value setup(method.findOrCreateLocal(TYPE_INT32, SPILL_SETUP_NAME), TYPE_INT32);
+	it.emplace(new LoadImmediate(setup, Literal(setupValue)));
+	it.nextInBlock();
+	it.emplace(new Operation(OP_ADD, setupRegister, setup, Value(REG_QPU_NUMBER, TYPE_INT8)));
+	it.nextInBlock();
+	it.emplace(new MoveOperation(dest, src));
+	it.nextInBlock();
+	return it;
+}
+
+bool optimizations::spillLocalsToVPM(Method& method, const FastSet<const Local*>& locals)
+{
+	if(locals.empty())
+		return false;
+	const periphery::VPMArea* area = method.vpm->addSpillingArea(static_cast<unsigned>(locals.size()), getNumQPUs(method));
+	if(area == nullptr)
 	{
-		logging::debug() << "Spilling candidate: " << pair.first->to_string() << " (" << pair.first->getUsers(LocalUse::Type::WRITER).size() << " writes, " << pair.first->getUsers(LocalUse::Type::READER).size() << " reads)" << logging::endl;
+		logging::debug() << "Not enough VPM space left to spill " << locals.size() << " locals" << logging::endl;
+		return false;
 	}
+	PROFILE_START(spillLocalsToVPM);
+
+	//every spilled local is stored in the rows starting at (slot * number of QPUs) within the area, the QPU number selects the row of the QPU
+	const uint32_t numQPUs = area->numRows / static_cast<uint32_t>(locals.size());
+	FastMap<const Local*, uint32_t> slots;
+	for(const Local* local : locals)
+		slots.emplace(local, static_cast<uint32_t>(slots.size()) * numQPUs);
+	const uint32_t readSetup = periphery::VPRSetup(area->toReadSetup(TYPE_UNKNOWN)).value;
+	const uint32_t writeSetup = periphery::VPWSetup(area->toWriteSetup(TYPE_UNKNOWN)).value;
+	InstructionWalker it = method.walkAllInstructions();
 
-	//TODO do not preemptively spill, only on register conflicts. Which case??
+	while(!it.isEndOfMethod())
+	{
+		if(it.get() == nullptr || it.has<BranchLabel>() || it.has<Branch>())
+		{
+			it.nextInMethod();
+			continue;
+		}
+		FastMap<const Local*, LocalUse::Type> spilledUses;
+		it->forUsedLocals([&spilledUses, &slots](const Local* local, const LocalUse::Type type) -> void
+		{
+			if(slots.find(local) != slots.end())
+				spilledUses[local] = add_flag(spilledUses[local], type);
+		});
+		if(spilledUses.empty())
+		{
+			it.nextInMethod();
+			continue;
+		}
+		FastMap<const Local*, Value> temporaries;
+		for(const auto& pair : spilledUses)
+		{
+			const Local* local = pair.first;
+			const Value tmp = method.addNewLocal(local->type, "%spill");
+			//partial writes (conditional or element insertion) need the previous value to be loaded too
+			const bool needsLoad = has_flag(pair.second, LocalUse::Type::READER) || !it.allInstructionMatches([local](const IntermediateInstruction* inst) -> bool
+			{
+				return inst == nullptr || !inst->writesLocal(local) || (inst->conditional == COND_ALWAYS && !inst->hasDecoration(InstructionDecorations::ELEMENT_INSERTION));
+			});
+			if(needsLoad)
+			{
+				//the walker still points to the current instruction afterwards
+				insertSpillAccess(method, it, VPM_IN_SETUP_REGISTER, readSetup + slots.at(local), tmp, VPM_IO_REGISTER);
+				//the reloaded value is read in the next instruction, which requires it to be on an accumulator (see GraphColoring).
+				//An unpacking instruction reads from register-file A, so a delay is required in between
+				if(anyOperation(it.get(), [](const IntermediateInstruction* inst) -> bool { return inst->hasUnpackMode();}))
+					it.emplace(new Nop(DelayType::WAIT_REGISTER)).nextInBlock();
+			}
+			it->replaceLocal(local, tmp.local, LocalUse::Type::BOTH);
+			temporaries.emplace(local, tmp);
+		}
+		InstructionWalker next = it;
+		next.nextInBlock();
+		for(const auto& pair : spilledUses)
+		{
+			if(has_flag(pair.second, LocalUse::Type::WRITER))
+				next = insertSpillAccess(method, next, VPM_OUT_SETUP_REGISTER, writeSetup + slots.at(pair.first), VPM_IO_REGISTER, temporaries.at(pair.first));
+		}
+		//continue with the instruction after the inserted stores
+		it = next.previousInBlock();
+		it.nextInMethod();
+	}
+	PROFILE_END(spillLocalsToVPM);
+	return true;
 }
 
 static InstructionWalker accessStackAllocations(const Module& module, Method& method, InstructionWalker it)
@@ -745,7 +986,7 @@ static void generateStandardMemoryAccessInstructions(Method& method, FastSet<Ins
 
 static void lowerStackIntoVPM(Method& method, FastSet<InstructionWalker>& memoryInstructions, FastMap<const Local*, const VPMArea*>& vpmMappedLocals)
 {
-	const unsigned stackSize = method.metaData.isWorkGroupSizeSet() ? std::accumulate(method.metaData.workGroupSizes.begin(), method.metaData.workGroupSizes.end(), 1u, std::multiplies<uint32_t>()) : 12;
+	const unsigned stackSize = getNumQPUs(method);
 	auto walkerIt = memoryInstructions.begin();
 	while(walkerIt != memoryInstructions.end())
 	{
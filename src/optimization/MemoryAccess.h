@@ -8,12 +8,15 @@
 #define OPTIMIZATION_MEMORYACCESS_H
 
 #include "config.h"
+#include "../performance.h"
 
 namespace vc4c
 {
 	class Method;
 	class Module;
 	class InstructionWalker;
+	class Local;
+	class ControlFlowGraph;
 
 	namespace optimizations
 	{
@@ -23,13 +26,71 @@ namespace vc4c
 		InstructionWalker accessGlobalData(const Module& module, Method& method, InstructionWalker it, const Configuration& config);
 
 		/*
-		 * Spills long-living locals which are rarely read into the VPM to be cached there.
-		 * Also splits the uses before and after being spilled into several locals
+		 * Spills long-living locals which are rarely accessed into the VPM to be cached there, if the register pressure is too high.
 		 *
-		 * NOTE: This step currently only runs the analysis of spill-candidates, no actual spilling is performed
+		 * The register pressure is estimated from the liveness of all locals at every write.
+		 * Where more locals are live than registers are available, the locals with the least accesses relative to the number of such points are
+		 * selected and spilled via #spillLocalsToVPM, so the register-allocation does not need to run several rounds to resolve the conflicts.
 		 */
 		void spillLocals(const Module& module, Method& method, const Configuration& config);
 
+		/*
+		 * The costs of spilling the locals of a method into the VPM, used by the SpillLocals pass as well as by the register-allocation.
+		 *
+		 * The costs of a local are the number of its accesses, since every access requires an additional VPM access after spilling.
+		 * Accesses within loops are weighted higher, since they are executed several times.
+		 */
+		class SpillCosts
+		{
+		public:
+			SpillCosts(Method& method, ControlFlowGraph& cfg);
+
+			/*
+			 * Returns whether the local can be spilled at all.
+			 *
+			 * Parameters, temporaries introduced by spilling and locals accessed within a VPM access (between the VPM setup and the VPM access,
+			 * which would be overwritten by the spill accesses) can never be spilled.
+			 * Neither can locals read by vector rotations (the rotated value must not be written in the previous instruction, which a reload directly
+			 * before the rotation would do), by branches (which are not rewritten by the spilling) or between loading and using the setup-value of
+			 * an already spilled local.
+			 */
+			bool isSpillable(const Local* local) const;
+			/*
+			 * Returns the (weighted) number of accesses to the local
+			 */
+			double getAccessCosts(const Local* local) const;
+
+			/*
+			 * Returns the cheapest of the given candidates (with their costs) in ascending order of their costs,
+			 * but not more than the given number and not more than fit into the free space left in the VPM,
+			 * since every spilled local occupies a row of the VPM for every QPU running the method
+			 */
+			std::vector<std::pair<const Local*, double>> selectCheapest(std::vector<std::pair<const Local*, double>> candidates, std::size_t maxNumLocals) const;
+
+		private:
+			//the costs and whether the local can be spilled, indexed by the local-index
+			std::vector<double> accessCosts;
+			std::vector<bool> spillable;
+			//the number of locals which still fit into the VPM
+			std::size_t maxSpilledLocals;
+
+			void markUnspillable(const FastSet<const Local*>& locals);
+		};
+
+		/*
+		 * Spills the given locals into a VPM area reserved for register spilling, with separate rows per QPU running the method
+		 * (the fixed work-group size, if set).
+		 *
+		 * Every read of a spilled local is replaced with a temporary loaded from the VPM directly before the reading instruction,
+		 * every write is replaced with a temporary stored into the VPM directly afterwards.
+		 * Since the generated instructions can be mapped directly to machine code, this can also be called during register-allocation.
+		 *
+		 * NOTE: The locals must not be accessed within a VPM access (between configuring and accessing the VPM), see SpillCosts#isSpillable
+		 *
+		 * Returns whether the locals were spilled, which fails if there is not enough space left in the VPM.
+		 */
+		bool spillLocalsToVPM(Method& method, const FastSet<const Local*>& locals);
+
 		/*
 		 * Handles stack allocations:
 		 * - calculates the offsets from the start of one QPU's "stack"
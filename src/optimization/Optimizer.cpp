@@ -7,6 +7,7 @@
 #include "Optimizer.h"
 
 #include "../BackgroundWorker.h"
+#include "../Instrumentation.h"
 #include "../intrinsics/Intrinsics.h"
 #include "../Profiler.h"
 #include "Combiner.h"
@@ -103,6 +104,35 @@ static const std::set<OptimizationStep> SINGLE_STEPS = {
 		OptimizationStep("CombineSettingSameFlags", combineSameFlags, 130)
 };
 
+static void addWithReaders(const LocalUser* inst, FastSet<const LocalUser*>& worklist)
+{
+	worklist.insert(inst);
+	if(inst->hasValueType(ValueType::LOCAL))
+		inst->getOutput()->local->forUsers(LocalUse::Type::READER, [&worklist](const LocalUser* user) -> void { worklist.insert(user); });
+}
+
+/*
+ * Adds the instructions created or modified by an optimization-step as well as all instructions reading the locals written by them to the work-list for the next round.
+ *
+ * These are all instructions recorded by the change-tracker (including in-place modifications) and,
+ * if the step moved the iterator (e.g. by removing instructions), all instructions after the previous position up to the returned position
+ */
+static void addChangedInstructions(InstructionWalker prevIt, const InstructionWalker& newIt, const bool iteratorMoved, const intermediate::InstructionChangeTracker& changes, FastSet<const LocalUser*>& worklist)
+{
+	for(const LocalUser* inst : changes.getChangedInstructions())
+		addWithReaders(inst, worklist);
+	if(!iteratorMoved)
+		return;
+	//the instructions are inserted into the same block, so we do not need to look any further
+	for(auto it = prevIt.nextInMethod(); !it.isEndOfBlock(); it.nextInBlock())
+	{
+		if(it.has())
+			addWithReaders(it.get(), worklist);
+		if(it == newIt)
+			break;
+	}
+}
+
 static void runSingleSteps(const Module& module, Method& method, const Configuration& config)
 {
 	auto& s = (logging::debug() << "Running steps: ");
@@ -110,38 +140,89 @@ static void runSingleSteps(const Module& module, Method& method, const Configura
 		s << step.name << ", ";
 	s << logging::endl;
 
-	//since an optimization-step can be run on the result of the previous step,
-	//we can't just pass the resulting iterator (pointing behind the optimization result) into the next optimization-step
-	//but since lists do not reallocate elements at inserting/removing, we can re-use the previous iterator
-	auto it = method.walkAllInstructions();
-	//this construct with previous iterator is required, because the iterator could be invalidated (if the underlying node is removed)
-	auto prevIt = it;
-	while(!it.isEndOfMethod())
+	//the number of instructions each step was run on, over all rounds
+	std::vector<std::size_t> numVisited(SINGLE_STEPS.size(), 0);
+	//the number of instructions visited in the first round, to compare against re-running full sweeps until the fix-point
+	std::size_t numInstructions = 0;
+	//the first round visits all instructions, every following round only the instructions changed by the previous round and their users,
+	//until no more changes are made
+	FastSet<const LocalUser*> worklist;
+	FastSet<const LocalUser*> nextWorklist;
+	//records the instructions created or modified in-place (e.g. via InstructionWalker#reset or the setters) by a single step
+	intermediate::InstructionChangeTracker changes;
+	std::size_t round = 0;
+	for(; round < SINGLE_STEPS_MAX_ROUNDS; ++round)
 	{
-		for(const OptimizationStep& step : SINGLE_STEPS)
+		//since an optimization-step can be run on the result of the previous step,
+		//we can't just pass the resulting iterator (pointing behind the optimization result) into the next optimization-step
+		//but since lists do not reallocate elements at inserting/removing, we can re-use the previous iterator
+		auto it = method.walkAllInstructions();
+		//this construct with previous iterator is required, because the iterator could be invalidated (if the underlying node is removed)
+		auto prevIt = it;
+		while(!it.isEndOfMethod())
 		{
-			PROFILE_START_DYNAMIC(step.name);
-			auto newIt = step(module, method, it, config);
-			//we can't just test newIt == it here, since if we replace the content of the iterator instead of deleting it, the iterators are still the same, even if we emplace instructions before
-			if(newIt.copy().previousInMethod() != prevIt || newIt != it)
-				it = prevIt;
-			PROFILE_END_DYNAMIC(step.name);
+			//the work-list is never dereferenced, so it does not matter that it can contain already deleted instructions
+			if(round == 0 || worklist.find(it.get()) != worklist.end())
+			{
+				if(round == 0)
+					++numInstructions;
+				std::size_t stepIndex = 0;
+				for(const OptimizationStep& step : SINGLE_STEPS)
+				{
+					PROFILE_START_DYNAMIC(step.name);
+					++numVisited[stepIndex];
+					changes.clear();
+					auto newIt = step(module, method, it, config);
+					//we can't just test newIt == it here, since if we replace the content of the iterator instead of deleting it, the iterators are still the same, even if we emplace instructions before
+					const bool iteratorMoved = newIt.copy().previousInMethod() != prevIt || newIt != it;
+					if(iteratorMoved || !changes.getChangedInstructions().empty())
+						addChangedInstructions(prevIt, newIt, iteratorMoved, changes, nextWorklist);
+					//an instruction changed in-place is still valid and is revisited by all steps in the next round
+					if(iteratorMoved)
+						it = prevIt;
+					PROFILE_END_DYNAMIC(step.name);
+					++stepIndex;
+				}
+			}
+			it.nextInMethod();
+			prevIt = it.copy().previousInMethod();
 		}
-		it.nextInMethod();
-		prevIt = it.copy().previousInMethod();
+		if(nextWorklist.empty())
+			break;
+		logging::debug() << "Re-running steps for " << nextWorklist.size() << " changed instructions" << logging::endl;
+		worklist.clear();
+		std::swap(worklist, nextWorklist);
+	}
+	if(round >= SINGLE_STEPS_MAX_ROUNDS)
+	{
+		logging::warn() << "Single-step optimizations have exceeded their maximum rounds without reaching a fix-point" << logging::endl;
 	}
+	const std::size_t numRounds = std::min(round + 1, SINGLE_STEPS_MAX_ROUNDS);
+	//re-running full sweeps until no more changes are made would visit every instruction in every round
+	logging::debug() << "Single-steps finished after " << numRounds << " rounds, visited " << (numVisited.empty() ? 0 : numVisited.front())
+			<< " instructions instead of " << (numRounds * numInstructions) << " for full sweeps" << logging::endl;
+
+	PROFILE_COUNTER(29000, "SingleSteps rounds", numRounds);
+	std::size_t stepIndex = 0;
+	for(const OptimizationStep& step : SINGLE_STEPS)
+	{
+		PROFILE_COUNTER(29001 + step.index, step.name + " (visited instructions)", numVisited[stepIndex]);
+		++stepIndex;
+	}
+	PROFILE_COUNTER(29200, "SingleSteps (instructions visited by full sweeps)", numRounds * numInstructions);
 }
 
 //need to run before mapping literals
 const OptimizationPass optimizations::MAP_MEMORY_ACCESS = OptimizationPass("MapMemoryAccess", mapMemoryAccess, 10);
 const OptimizationPass optimizations::RESOLVE_STACK_ALLOCATIONS = OptimizationPass("ResolveStackAllocations", resolveStackAllocations, 20);
 const OptimizationPass optimizations::RUN_SINGLE_STEPS = OptimizationPass("SingleSteps", runSingleSteps, 30);
-const OptimizationPass optimizations::SPILL_LOCALS = OptimizationPass("SpillLocals", spillLocals, 80);
 const OptimizationPass optimizations::COMBINE_LITERAL_LOADS = OptimizationPass("CombineLiteralLoads", combineLoadingLiterals, 90);
 const OptimizationPass optimizations::COMBINE_ROTATIONS = OptimizationPass("CombineRotations", combineVectorRotations, 100);
 const OptimizationPass optimizations::REMOVE_REDUNDANT_MOVES = OptimizationPass("RemoveRedundantMoves", eliminateRedundantMoves, 110);
 const OptimizationPass optimizations::ELIMINATE = OptimizationPass("EliminateDeadStores", eliminateDeadStore, 120);
 const OptimizationPass optimizations::VECTORIZE = OptimizationPass("VectorizeLoops", vectorizeLoops, 130);
+//needs to run after all instructions are eliminated and loops are vectorized, so only locals actually living that long are spilled
+const OptimizationPass optimizations::SPILL_LOCALS = OptimizationPass("SpillLocals", spillLocals, 135);
 const OptimizationPass optimizations::SPLIT_READ_WRITES = OptimizationPass("SplitReadAfterWrites", splitReadAfterWrites, 140);
 const OptimizationPass optimizations::REORDER = OptimizationPass("ReorderInstructions", reorderWithinBasicBlocks, 150);
 const OptimizationPass optimizations::COMBINE = OptimizationPass("CombineALUIinstructions", combineOperations, 160);
@@ -150,7 +231,7 @@ const OptimizationPass optimizations::ADD_START_STOP_SEGMENT = OptimizationPass(
 const OptimizationPass optimizations::EXTEND_BRANCHES = OptimizationPass("ExtendBranches", extendBranches, 190);
 
 const std::set<OptimizationPass> optimizations::DEFAULT_PASSES = {
-		MAP_MEMORY_ACCESS, RUN_SINGLE_STEPS, /* SPILL_LOCALS, */ COMBINE_LITERAL_LOADS, RESOLVE_STACK_ALLOCATIONS, COMBINE_ROTATIONS, REMOVE_REDUNDANT_MOVES, ELIMINATE, VECTORIZE, SPLIT_READ_WRITES, REORDER, COMBINE, UNROLL_WORK_GROUPS, ADD_START_STOP_SEGMENT, EXTEND_BRANCHES
+		MAP_MEMORY_ACCESS, RUN_SINGLE_STEPS, COMBINE_LITERAL_LOADS, RESOLVE_STACK_ALLOCATIONS, COMBINE_ROTATIONS, REMOVE_REDUNDANT_MOVES, ELIMINATE, VECTORIZE, SPILL_LOCALS, SPLIT_READ_WRITES, REORDER, COMBINE, UNROLL_WORK_GROUPS, ADD_START_STOP_SEGMENT, EXTEND_BRANCHES
 };
 
 Optimizer::Optimizer(const Configuration& config, const std::set<OptimizationPass>& passes) : config(config), passes(passes)
@@ -169,7 +250,10 @@ static void runOptimizationPasses(const Module& module, Method& method, const Co
         logging::debug() << "Running pass: " << pass.name << logging::endl;
         PROFILE_COUNTER(pass.index * 100, pass.name + " (before)", method.countInstructions());
         PROFILE_START_DYNAMIC(pass.name);
-        pass(module, method, config);
+        {
+        	profiler::Instrumentation::Step step(module.instrumentation, pass.name, method);
+        	pass(module, method, config);
+        }
         PROFILE_END_DYNAMIC(pass.name);
         PROFILE_COUNTER_WITH_PREV((pass.index + 1) * 100, pass.name + " (after)", method.countInstructions(), pass.index * 100);
     }
@@ -186,32 +270,44 @@ static void runOptimizationPasses(const Module& module, Method& method, const Co
 
 void Optimizer::optimize(Module& module) const
 {
-	std::vector<threading::BackgroundWorker> workers;
-	workers.reserve(module.getKernels().size());
+	std::vector<std::function<void()>> tasks;
+	tasks.reserve(module.methods.size());
 	for(auto& method : module)
 	{
 		//PHI-nodes need to be eliminated before inlining functions
 		//since otherwise the phi-node is mapped to the initial label, not to the last label added by the functions (the real end of the original, but split up block)
-		PROFILE_COUNTER(90, "Eliminate Phi-nodes (before)", method->countInstructions());
-		eliminatePhiNodes(module, *method.get(), config);
-		PROFILE_COUNTER_WITH_PREV(95, "Eliminate Phi-nodes (after)", method->countInstructions(), 90);
+		Method* func = method.get();
+		tasks.emplace_back([func, &module, this]() -> void {
+			MemoryArena::Scope arenaScope(func->arena);
+			PROFILE_COUNTER(90, "Eliminate Phi-nodes (before)", func->countInstructions());
+			profiler::Instrumentation::Step step(module.instrumentation, "EliminatePhiNodes", *func);
+			eliminatePhiNodes(module, *func, config);
+			PROFILE_COUNTER_WITH_PREV(95, "Eliminate Phi-nodes (after)", func->countInstructions(), 90);
+		});
 	}
+	threading::BackgroundWorker::scheduleAll(tasks, "Phi-Elimination", config.numThreads);
+
+	//inlining needs to run sequentially, since the callee methods are modified (inlining their own calls) while being inlined into the kernels
 	for(Method* kernelFunc : module.getKernels())
 	{
 		Method& kernel = *kernelFunc;
+		MemoryArena::Scope arenaScope(kernel.arena);
 
 		PROFILE_COUNTER(100, "Inline (before)", kernel.countInstructions());
+		profiler::Instrumentation::Step step(module.instrumentation, "InlineMethods", kernel);
 		inlineMethods(module, kernel, config);
 		PROFILE_COUNTER_WITH_PREV(110, "Inline (after)", kernel.countInstructions(), 100);
 	}
+
+	tasks.clear();
 	for(Method* kernelFunc : module.getKernels())
 	{
-		auto f = [kernelFunc, &module, this]() -> void {
+		tasks.emplace_back([kernelFunc, &module, this]() -> void {
+			MemoryArena::Scope arenaScope(kernelFunc->arena);
 			runOptimizationPasses(module, *kernelFunc, config, passes);
-		};
-		workers.emplace(workers.end(), f, "Optimizer")->operator ()();
+		});
 	}
-	threading::BackgroundWorker::waitForAll(workers);
+	threading::BackgroundWorker::scheduleAll(tasks, "Optimizer", config.numThreads);
 }
 
 void Optimizer::addPass(const OptimizationPass& pass)
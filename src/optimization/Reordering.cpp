@@ -6,198 +6,807 @@
 
 #include "Reordering.h"
 
+#include "../Instrumentation.h"
 #include "../intermediate/Helper.h"
+#include "../periphery/Timing.h"
 #include "../Profiler.h"
 #include "log.h"
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
 using namespace vc4c;
 using namespace vc4c::optimizations;
 using namespace vc4c::intermediate;
 
+//the number of instructions between writing an SFU register and reading the result from r4, including the writing instruction
+static constexpr unsigned SFU_LATENCY = periphery::timing::SFU_RESULT_DELAY + 1;
+//the number of instructions between changing the UNIFORM address and reading the next UNIFORM, including the writing instruction
+static constexpr unsigned UNIFORM_ADDRESS_LATENCY = periphery::timing::UNIFORM_ADDRESS_DELAY + 1;
+//reading r4 stalls at least until the TMU load is finished (for a TMU cache hit)
+static constexpr unsigned TMU_LATENCY = periphery::timing::TMU_CACHE_HIT_CYCLES;
+
+//the number of locals live within a basic block, above which the scheduler prefers instructions ending live ranges.
+//This leaves some of the 64 physical registers for the locals living across the block
+static constexpr std::size_t MAX_SCHEDULING_REGISTER_PRESSURE = 48;
+
+static constexpr unsigned RUNS_ON_ADD_ALU = 1;
+static constexpr unsigned RUNS_ON_MUL_ALU = 2;
+
+/*
+ * Returns the ALUs the instruction could be executed on, if it can be combined with an instruction on the other ALU, zero otherwise
+ */
+static unsigned getPairableALUs(const IntermediateInstruction* inst)
+{
+	if(inst == nullptr || !inst->canBeCombined || !inst->mapsToASMInstruction() || inst->hasSideEffects() || inst->hasValueType(ValueType::REGISTER))
+		return 0;
+	if(std::any_of(inst->getArguments().begin(), inst->getArguments().end(), [](const Value& arg) -> bool { return arg.hasType(ValueType::REGISTER);}))
+		return 0;
+	if(const Operation* op = dynamic_cast<const Operation*>(inst))
+		return (op->op.runsOnAddALU() ? RUNS_ON_ADD_ALU : 0) | (op->op.runsOnMulALU() ? RUNS_ON_MUL_ALU : 0);
+	if(dynamic_cast<const MoveOperation*>(inst) != nullptr && dynamic_cast<const VectorRotation*>(inst) == nullptr)
+		//moves can be executed on both ALUs
+		return RUNS_ON_ADD_ALU | RUNS_ON_MUL_ALU;
+	return 0;
+}
+
+/*
+ * Whether the second instruction can be executed in the same cycle as the first one by the ADD and MUL ALU, as done by #combineOperations
+ */
+static bool canBePaired(const IntermediateInstruction* first, const IntermediateInstruction* second)
+{
+	const unsigned firstALUs = getPairableALUs(first);
+	const unsigned secondALUs = getPairableALUs(second);
+	if(((firstALUs & RUNS_ON_ADD_ALU) == 0 || (secondALUs & RUNS_ON_MUL_ALU) == 0) && ((firstALUs & RUNS_ON_MUL_ALU) == 0 || (secondALUs & RUNS_ON_ADD_ALU) == 0))
+		return false;
+	//the second instruction must not depend on the result of the first and both need to write different locals
+	if(first->hasValueType(ValueType::LOCAL) && (second->readsLocal(first->getOutput()->local) || second->writesLocal(first->getOutput()->local)))
+		return false;
+	return true;
+}
+
+static bool readsR4(const IntermediateInstruction* inst)
+{
+	return inst->readsRegister(REG_SFU_OUT);
+}
+
+static bool triggersTMULoad(const IntermediateInstruction* inst)
+{
+	return inst->signal == SIGNAL_LOAD_TMU0 || inst->signal == SIGNAL_LOAD_TMU1;
+}
+
 /*
- * Finds the last instruction before the (list of) NOP(s) that is not a NOP -> the reason for the insertion of NOPs
+ * Tracks the VPM DMA setups written within a block to determine the duration of the DMA loads and stores started afterwards.
+ *
+ * Only setups written as literal values are known, all other values written to the setup registers are generic (VPM read/write) setups.
  */
-static InstructionWalker findPreviousInstruction(BasicBlock& basicBlock, const InstructionWalker pos)
+struct DMASetupTracker
 {
-	PROFILE_START(findPreviousInstruction);
-	auto it = pos;
-	while(!it.isStartOfBlock())
+	uint32_t readSetup = 0;
+	uint32_t readStrideSetup = 0;
+	uint32_t writeSetup = 0;
+	uint32_t writeStrideSetup = 0;
+
+	void update(const IntermediateInstruction* inst)
 	{
-		if(it.get() != nullptr && it->mapsToASMInstruction() && it->getOutput())
-			break;
-		it.previousInBlock();
+		if(!inst->writesRegister(REG_VPM_IN_SETUP) && !inst->writesRegister(REG_VPM_OUT_SETUP))
+			return;
+		Optional<Literal> value;
+		if(const LoadImmediate* load = dynamic_cast<const LoadImmediate*>(inst))
+			value = load->getImmediate();
+		else if(const MoveOperation* move = dynamic_cast<const MoveOperation*>(inst))
+			value = move->getSource().getLiteralValue();
+		if(!value)
+			return;
+		if(inst->writesRegister(REG_VPM_IN_SETUP))
+		{
+			const periphery::VPRSetup setup = periphery::VPRSetup::fromLiteral(value->toImmediate());
+			if(setup.isDMASetup())
+				readSetup = setup.value;
+			else if(setup.isStrideSetup())
+				readStrideSetup = setup.value;
+		}
+		else
+		{
+			const periphery::VPWSetup setup = periphery::VPWSetup::fromLiteral(value->toImmediate());
+			if(setup.isDMASetup())
+				writeSetup = setup.value;
+			else if(setup.isStrideSetup())
+				writeStrideSetup = setup.value;
+		}
 	}
-	PROFILE_END(findPreviousInstruction);
-	return it;
+
+	unsigned getLoadCycles() const
+	{
+		return periphery::timing::getDMALoadCycles(periphery::VPRSetup(readSetup), periphery::VPRSetup(readStrideSetup));
+	}
+
+	unsigned getStoreCycles() const
+	{
+		return periphery::timing::getDMAStoreCycles(periphery::VPWSetup(writeSetup), periphery::VPWSetup(writeStrideSetup));
+	}
+};
+
+/*
+ * Nops inserted to wait for a result, which are removed by the scheduler and re-inserted where the delay can't be filled with other instructions
+ */
+static bool isRemovableNop(const IntermediateInstruction* inst)
+{
+	const Nop* nop = dynamic_cast<const Nop*>(inst);
+	if(nop == nullptr || nop->hasSideEffects())
+		return false;
+	return nop->type == DelayType::WAIT_REGISTER || nop->type == DelayType::WAIT_SFU || nop->type == DelayType::WAIT_UNIFORM || nop->type == DelayType::WAIT_VPM;
+}
+
+/*
+ * Instructions which can't be re-ordered at all. Every instruction before them is scheduled before, every instruction after them is scheduled afterwards
+ */
+static bool isSchedulingBarrier(const IntermediateInstruction* inst)
+{
+	if(dynamic_cast<const BranchLabel*>(inst) != nullptr || dynamic_cast<const Branch*>(inst) != nullptr || dynamic_cast<const MemoryBarrier*>(inst) != nullptr ||
+			dynamic_cast<const SemaphoreAdjustment*>(inst) != nullptr || dynamic_cast<const CombinedOperation*>(inst) != nullptr)
+		return true;
+	//re-ordering MUTEX_ACQUIRE would extend the critical section (maybe a lot!), also never move anything out of (or over) the critical section
+	if(inst->readsRegister(REG_MUTEX))
+		return true;
+	//e.g. delays for branches or thread-end
+	if(dynamic_cast<const Nop*>(inst) != nullptr && !inst->hasSideEffects())
+		return true;
+	//skip every instruction, which is not mapped to machine code, since its position might be relevant
+	return !inst->mapsToASMInstruction();
 }
 
 /*
- * Finds an instruction within the basic block that does not access any of the given values
+ * Instructions accessing hardware registers or flags, which need to keep their relative order
  */
-static InstructionWalker findInstructionNotAccessing(BasicBlock& basicBlock, const InstructionWalker pos, FastSet<Value>& excludedValues)
+static bool isOrderedInstruction(const IntermediateInstruction* inst)
 {
-	std::size_t instructionsLeft = REPLACE_NOP_MAX_INSTRUCTIONS_TO_CHECK;
-	auto it = pos;
-	while(instructionsLeft > 0 && !it.isEndOfBlock())
+	if(inst->hasSideEffects() || (inst->hasValueType(ValueType::REGISTER) && !inst->writesRegister(REG_NOP)))
+		return true;
+	return std::any_of(inst->getArguments().begin(), inst->getArguments().end(), [](const Value& arg) -> bool
 	{
-		if(it.get() == nullptr)
-		{
-			//skip already replaced instructions
-			it.nextInBlock();
-			--instructionsLeft;
+		return arg.hasType(ValueType::REGISTER) && (arg.reg.isAccumulator() || arg.reg.hasSideEffectsOnRead());
+	});
+}
+
+static constexpr std::size_t NO_NODE = std::numeric_limits<std::size_t>::max();
+
+struct Dependency
+{
+	std::size_t node;
+	//the minimum number of cycles between the start of the predecessor and the start of the dependent instruction
+	unsigned latency;
+	//hard latencies need to be guaranteed by inserting nops, soft latencies only stall the hardware
+	bool isHard;
+	DelayType reason;
+};
+
+/*
+ * Whether the instruction could be combined with one of its neighbors by #combineOperations, ignoring any dependencies between them
+ */
+static bool mayBeCombined(const IntermediateInstruction* inst)
+{
+	return inst->canBeCombined && inst->mapsToASMInstruction() && (dynamic_cast<const Operation*>(inst) != nullptr || dynamic_cast<const MoveOperation*>(inst) != nullptr);
+}
+
+/*
+ * Returns the minimum number of cycles between the start of the scheduled instruction at the given position (NO_NODE for the last instruction of the previous block)
+ * and the start of the next instruction appended to the schedule.
+ *
+ * Since the instructions are combined after scheduling, this assumes every two neighboring instructions which may be combined are executed in the same cycle.
+ */
+static std::size_t getMinimumCycles(const std::vector<IntermediateInstruction*>& schedule, const std::size_t position, const bool nextMayBeCombined)
+{
+	//the last instruction of the previous block is never combined with an instruction of this block
+	std::size_t numInstructions = position == NO_NODE ? 1 : 0;
+	std::size_t numCombined = 0;
+	bool previousMayBeCombined = false;
+	for(std::size_t pos = position == NO_NODE ? 0 : position; pos <= schedule.size(); ++pos)
+	{
+		if(pos < schedule.size() && !schedule[pos]->mapsToASMInstruction())
 			continue;
+		const bool currentMayBeCombined = pos < schedule.size() ? mayBeCombined(schedule[pos]) : nextMayBeCombined;
+		//combining greedily from the front results in the maximum number of combined pairs
+		if(previousMayBeCombined && currentMayBeCombined)
+		{
+			++numCombined;
+			previousMayBeCombined = false;
+		}
+		else
+			previousMayBeCombined = currentMayBeCombined;
+		if(pos < schedule.size())
+			++numInstructions;
+	}
+	return numInstructions - numCombined;
+}
+
+/*
+ * A hard latency to a scheduled predecessor, which is not yet guaranteed
+ */
+struct HardDelay
+{
+	//the position of the predecessor in the schedule, NO_NODE for the last instruction of the previous block
+	std::size_t position;
+	unsigned latency;
+	DelayType reason;
+};
+
+struct ScheduleNode
+{
+	IntermediateInstruction* instruction;
+	bool isBarrier;
+	bool isOrdered;
+	//whether the written local is not only used within the accumulator threshold, as checked by #splitReadAfterWrites
+	bool writesLongLivingLocal;
+	std::vector<Dependency> successors;
+	std::size_t numOpenPredecessors;
+	//the length of the longest path (in cycles) to the end of the block
+	std::size_t height;
+	//the earliest cycle the instruction can be executed without stalling
+	std::size_t earliestCycle;
+	//the hard latencies which need to be guaranteed before the instruction can be executed
+	std::vector<HardDelay> hardDelays;
+	bool isScheduled;
+
+	ScheduleNode(IntermediateInstruction* inst, bool isBarrier, bool isOrdered) : instruction(inst), isBarrier(isBarrier), isOrdered(isOrdered),
+		writesLongLivingLocal(false), numOpenPredecessors(0), height(0), earliestCycle(0), isScheduled(false)
+	{}
+
+	unsigned getDuration() const
+	{
+		return instruction->mapsToASMInstruction() ? 1 : 0;
+	}
+
+	/*
+	 * Removes all hard latencies guaranteed when appending the instruction to the schedule and returns whether there are none left
+	 */
+	bool checkHardDelays(const std::vector<IntermediateInstruction*>& schedule)
+	{
+		//the end of the block is never combined with the first instruction of the next block
+		const bool nodeMayBeCombined = instruction != nullptr && mayBeCombined(instruction);
+		hardDelays.erase(std::remove_if(hardDelays.begin(), hardDelays.end(), [&schedule, nodeMayBeCombined](const HardDelay& delay) -> bool
+		{
+			return getMinimumCycles(schedule, delay.position, nodeMayBeCombined) >= delay.latency;
+		}), hardDelays.end());
+		return hardDelays.empty();
+	}
+};
+
+static void addDependency(std::vector<ScheduleNode>& nodes, const std::size_t from, const std::size_t to, const unsigned latency, const bool isHard = true, const DelayType reason = DelayType::WAIT_REGISTER)
+{
+	if(from == NO_NODE || from == to)
+		return;
+	nodes[from].successors.push_back(Dependency{to, latency, isHard, reason});
+	++nodes[to].numOpenPredecessors;
+}
+
+/*
+ * Adds a dependency only requiring the instruction to be executed after the previous one
+ */
+static void addOrderDependency(std::vector<ScheduleNode>& nodes, const std::size_t from, const std::size_t to)
+{
+	if(from != NO_NODE)
+		addDependency(nodes, from, to, nodes[from].getDuration());
+}
+
+/*
+ * Builds the dependency graph for the instructions of a basic block:
+ * - reading a local depends on the last write (with an additional delay, if the local can't be read in the next instruction, see #splitReadAfterWrites)
+ * - writing a local depends on the last write and all reads since
+ * - instructions setting flags and conditional instructions are ordered accordingly
+ * - instructions accessing hardware registers keep their relative order, with the latencies of the SFU, TMU, VPM DMA and UNIFORM address
+ */
+static void createDependencyGraph(BasicBlock& block, const std::vector<InstructionWalker>& positions, std::vector<ScheduleNode>& nodes)
+{
+	FastMap<const Local*, std::size_t> lastWriters;
+	FastMap<const Local*, std::vector<std::size_t>> readersSinceWrite;
+	std::size_t lastFlagsWriter = NO_NODE;
+	std::vector<std::size_t> flagsReaders;
+	std::size_t lastOrdered = NO_NODE;
+	std::size_t lastBarrier = NO_NODE;
+	std::vector<std::size_t> nodesSinceBarrier;
+	std::size_t lastR4Trigger = NO_NODE;
+	std::size_t lastVPMReadStart = NO_NODE;
+	std::size_t lastVPMWriteStart = NO_NODE;
+	unsigned vpmReadLatency = 0;
+	unsigned vpmWriteLatency = 0;
+	DMASetupTracker dmaSetups;
+	std::size_t lastUniformAddressWrite = NO_NODE;
+	std::size_t lastRotationOffsetWrite = NO_NODE;
+
+	for(std::size_t index = 0; index < nodes.size(); ++index)
+	{
+		ScheduleNode& node = nodes[index];
+		const IntermediateInstruction* inst = node.instruction;
+		if(node.isBarrier)
+		{
+			for(const std::size_t previous : nodesSinceBarrier)
+				addOrderDependency(nodes, previous, index);
+			addOrderDependency(nodes, lastBarrier, index);
+			lastBarrier = index;
+			nodesSinceBarrier.clear();
 		}
-		bool validReplacement = true;
-		PROFILE_START(checkExcludedValues);
-		if(it->getOutput() && excludedValues.find(it->getOutput().value()) != excludedValues.end())
+		else
 		{
-			validReplacement = false;
+			addOrderDependency(nodes, lastBarrier, index);
+			nodesSinceBarrier.push_back(index);
 		}
-		for(const Value& arg : it->getArguments())
+
+		const VectorRotation* rotation = dynamic_cast<const VectorRotation*>(inst);
+		inst->forUsedLocals([&](const Local* local, const LocalUse::Type type) -> void
 		{
-			if(excludedValues.find(arg) != excludedValues.end())
+			if(has_flag(type, LocalUse::Type::READER))
 			{
-				validReplacement = false;
-				break;
+				auto writerIt = lastWriters.find(local);
+				if(writerIt != lastWriters.end())
+				{
+					const ScheduleNode& writer = nodes[writerIt->second];
+					//vector rotations and unpacking need the input to be on a physical register (or r5), which can't be read in the next instruction.
+					//The same applies to values packed on writing
+					const bool needsDelay = rotation != nullptr || inst->hasUnpackMode() || writer.instruction->hasPackMode() || writer.writesLongLivingLocal;
+					if(needsDelay)
+						addDependency(nodes, writerIt->second, index, 2);
+					else
+						addOrderDependency(nodes, writerIt->second, index);
+				}
+				else if(rotation != nullptr)
+				{
+					//the input could be written by the last instruction of the previous block
+					node.earliestCycle = std::max(node.earliestCycle, std::size_t{1});
+					node.hardDelays.push_back(HardDelay{NO_NODE, 2, DelayType::WAIT_REGISTER});
+				}
+				readersSinceWrite[local].push_back(index);
 			}
+			if(has_flag(type, LocalUse::Type::WRITER))
+			{
+				auto writerIt = lastWriters.find(local);
+				if(writerIt != lastWriters.end())
+					addOrderDependency(nodes, writerIt->second, index);
+				for(const std::size_t reader : readersSinceWrite[local])
+					addOrderDependency(nodes, reader, index);
+				readersSinceWrite[local].clear();
+				lastWriters[local] = index;
+				if(inst->hasValueType(ValueType::LOCAL) && inst->getOutput()->local == local && !block.isLocallyLimited(positions[index], local))
+					node.writesLongLivingLocal = true;
+			}
+		});
+
+		if(inst->hasConditionalExecution())
+		{
+			addOrderDependency(nodes, lastFlagsWriter, index);
+			flagsReaders.push_back(index);
+		}
+		if(inst->setFlags == SetFlag::SET_FLAGS)
+		{
+			addOrderDependency(nodes, lastFlagsWriter, index);
+			for(const std::size_t reader : flagsReaders)
+				addOrderDependency(nodes, reader, index);
+			flagsReaders.clear();
+			lastFlagsWriter = index;
 		}
-		PROFILE_END(checkExcludedValues);
-		if(validReplacement && it->writesRegister(REG_MUTEX))
+
+		if(!node.isOrdered && !node.isBarrier)
+			continue;
+		addOrderDependency(nodes, lastOrdered, index);
+		lastOrdered = index;
+
+		if(readsR4(inst) && lastR4Trigger != NO_NODE)
 		{
-			//never move MUTEX_RELEASE
-			validReplacement = false;
-			//Allow instructions to be moved over MUTEX_RELEASE to replace the VPM wait nops
+			if(triggersTMULoad(nodes[lastR4Trigger].instruction))
+				addDependency(nodes, lastR4Trigger, index, TMU_LATENCY, false, DelayType::WAIT_TMU);
+			else
+				addDependency(nodes, lastR4Trigger, index, SFU_LATENCY, true, DelayType::WAIT_SFU);
 		}
-		if(validReplacement && it->readsRegister(REG_MUTEX))
+		if(inst->readsRegister(REG_VPM_IN_WAIT))
+			addDependency(nodes, lastVPMReadStart, index, vpmReadLatency, false, DelayType::WAIT_VPM);
+		if(inst->readsRegister(REG_VPM_OUT_WAIT))
+			addDependency(nodes, lastVPMWriteStart, index, vpmWriteLatency, false, DelayType::WAIT_VPM);
+		if(inst->readsRegister(REG_UNIFORM))
+			addDependency(nodes, lastUniformAddressWrite, index, UNIFORM_ADDRESS_LATENCY, true, DelayType::WAIT_UNIFORM);
+		if(rotation != nullptr && inst->readsRegister(REG_ACC5))
 		{
-			//Re-ordering MUTEX_ACQUIRE would extend the critical section (maybe a lot!), so don't move it
-			validReplacement = false;
-			//Also, never move anything out of (or over) the critical section
-			return basicBlock.end();
+			//the rotation offset can't be written in the instruction directly preceding the rotation
+			if(lastRotationOffsetWrite != NO_NODE)
+				addDependency(nodes, lastRotationOffsetWrite, index, 2);
+			else
+			{
+				node.earliestCycle = std::max(node.earliestCycle, std::size_t{1});
+				node.hardDelays.push_back(HardDelay{NO_NODE, 2, DelayType::WAIT_REGISTER});
+			}
+		}
 
+		if(triggersTMULoad(inst) || (inst->hasValueType(ValueType::REGISTER) && inst->getOutput()->reg.isSpecialFunctionsUnit()))
+			lastR4Trigger = index;
+		dmaSetups.update(inst);
+		//the duration of the DMA access is determined by the setup active when it is started
+		if(inst->writesRegister(REG_VPM_IN_ADDR))
+		{
+			lastVPMReadStart = index;
+			vpmReadLatency = dmaSetups.getLoadCycles();
 		}
-		//for now, skip everything setting and using flags/signals
-		if(validReplacement && (it->hasConditionalExecution() || it->hasSideEffects()))
+		if(inst->writesRegister(REG_VPM_OUT_ADDR))
 		{
-			validReplacement = false;
+			lastVPMWriteStart = index;
+			vpmWriteLatency = dmaSetups.getStoreCycles();
 		}
-		if(validReplacement && (it.has<Branch>() || it.has<BranchLabel>() || it.has<MemoryBarrier>()))
+		if(inst->writesRegister(REG_UNIFORM_ADDRESS))
+			lastUniformAddressWrite = index;
+		if(inst->writesRegister(REG_ACC5))
+			lastRotationOffsetWrite = index;
+	}
+}
+
+/*
+ * Determines the number of cycles required between the instructions of this block and the end of the block,
+ * since the results are accessed by the first instructions of the following block
+ */
+static void addDelaysAtEndOfBlock(BasicBlock& block, BasicBlock* nextBlock, std::vector<ScheduleNode>& nodes, ScheduleNode& endOfBlock)
+{
+	//the additional node representing the end of the block has the index after the last instruction
+	const auto addEndDependency = [&nodes, &endOfBlock](const std::size_t from, const unsigned latency, const DelayType reason) -> void
+	{
+		nodes[from].successors.push_back(Dependency{nodes.size(), latency, true, reason});
+		++endOfBlock.numOpenPredecessors;
+	};
+	if(nodes.empty() || nextBlock == nullptr || !block.fallsThroughToNextBlock() || dynamic_cast<const Branch*>(nodes.back().instruction) != nullptr)
+		//after branches, the delay slots are inserted
+		return;
+	InstructionWalker head = nextBlock->begin();
+	while(!head.isEndOfBlock() && (!head.has() || !head->mapsToASMInstruction()))
+		head.nextInBlock();
+	if(head.isEndOfBlock())
+		return;
+	const bool headNeedsDelay = head.has<VectorRotation>() || head->hasUnpackMode();
+	bool hasR4Trigger = false;
+	bool hasUniformAddressWrite = false;
+	bool hasRotationOffsetWrite = false;
+	FastSet<const Local*> writtenLocals;
+	//find the last writes within the block
+	for(std::size_t index = nodes.size(); index > 0; --index)
+	{
+		const ScheduleNode& node = nodes[index - 1];
+		const IntermediateInstruction* inst = node.instruction;
+		if(!hasR4Trigger && (triggersTMULoad(inst) || readsR4(inst) || (inst->hasValueType(ValueType::REGISTER) && inst->getOutput()->reg.isSpecialFunctionsUnit())))
 		{
-			//NEVER RE-ORDER BRANCHES, LABELS OR BARRIERS!
-			validReplacement = false;
+			hasR4Trigger = true;
+			if(!readsR4(inst) && !triggersTMULoad(inst))
+				addEndDependency(index - 1, SFU_LATENCY, DelayType::WAIT_SFU);
 		}
-		if(validReplacement && it.has<Nop>())
+		if(!hasUniformAddressWrite && (inst->writesRegister(REG_UNIFORM_ADDRESS) || inst->readsRegister(REG_UNIFORM)))
 		{
-			//replacing NOP with NOP will violate the delay (e.g. for branches, SFU)
-			validReplacement = false;
+			hasUniformAddressWrite = true;
+			if(inst->writesRegister(REG_UNIFORM_ADDRESS))
+				addEndDependency(index - 1, UNIFORM_ADDRESS_LATENCY, DelayType::WAIT_UNIFORM);
 		}
-		if(validReplacement && !it->mapsToASMInstruction())
+		if(!hasRotationOffsetWrite && inst->writesRegister(REG_ACC5))
 		{
-			//skip every instruction, which is not mapped to machine code, since otherwise the delay for the NOP will be violated
-			validReplacement = false;
+			hasRotationOffsetWrite = true;
+			addEndDependency(index - 1, 2, DelayType::WAIT_REGISTER);
 		}
-		if(validReplacement)
+		if(inst->hasValueType(ValueType::LOCAL) && writtenLocals.emplace(inst->getOutput()->local).second && head->readsLocal(inst->getOutput()->local))
 		{
-			logging::debug() << "Found instruction not using any of the excluded values (" << to_string<Value, FastSet<Value>>(excludedValues) << "): " << it->to_string() << logging::endl;
-			break;
+			if(headNeedsDelay || inst->hasPackMode() || node.writesLongLivingLocal)
+				addEndDependency(index - 1, 2, DelayType::WAIT_REGISTER);
 		}
+	}
+}
 
-		//otherwise add all outputs by instructions in between (the NOP and the replacement), since they could be used as input in the following instructions
-		if(it->getOutput() && !it->writesRegister(REG_NOP))
+/*
+ * Tracks the number of locals live within a basic block while scheduling it.
+ *
+ * A local becomes live when it is written and has readers within the block left, and dies when its last reader within the block is scheduled.
+ * Locals read within the block before being written are live from the start of the block.
+ */
+struct RegisterPressure
+{
+	FastMap<const Local*, std::size_t> openReaders;
+	FastSet<const Local*> liveLocals;
+
+	explicit RegisterPressure(const std::vector<ScheduleNode>& nodes)
+	{
+		FastSet<const Local*> writtenLocals;
+		for(const ScheduleNode& node : nodes)
 		{
-			excludedValues.insert(it->getOutput().value());
-			//make sure, SFU/TMU calls are not moved over other SFU/TMU calls
-			//this prevents nop-sfu-... from being replaced with sfu-sfu-...
-			if(it->writesRegister(REG_SFU_EXP2) || it->writesRegister(REG_SFU_LOG2) || it->writesRegister(REG_SFU_RECIP)
-					|| it->writesRegister(REG_SFU_RECIP_SQRT) || it->writesRegister(REG_TMU0_ADDRESS) || it->writesRegister(REG_TMU1_ADDRESS))
+			for(const Local* local : getReadLocals(node.instruction))
 			{
-				excludedValues.emplace(Value(REG_SFU_EXP2, TYPE_FLOAT));
-				excludedValues.emplace(Value(REG_SFU_LOG2, TYPE_FLOAT));
-				excludedValues.emplace(Value(REG_SFU_OUT, TYPE_FLOAT));
-				excludedValues.emplace(Value(REG_SFU_RECIP, TYPE_FLOAT));
-				excludedValues.emplace(Value(REG_SFU_RECIP_SQRT, TYPE_FLOAT));
-				excludedValues.emplace(Value(REG_TMU0_ADDRESS, TYPE_VOID.toPointerType()));
-				excludedValues.emplace(Value(REG_TMU1_ADDRESS, TYPE_VOID.toPointerType()));
+				++openReaders[local];
+				if(writtenLocals.find(local) == writtenLocals.end())
+					liveLocals.emplace(local);
 			}
+			if(node.instruction->hasValueType(ValueType::LOCAL))
+				writtenLocals.emplace(node.instruction->getOutput()->local);
+		}
+	}
+
+	/*
+	 * Returns the change in the number of live locals when scheduling the given instruction
+	 */
+	int getDelta(const IntermediateInstruction* inst) const
+	{
+		int delta = 0;
+		for(const Local* local : getReadLocals(inst))
+		{
+			if(openReaders.at(local) == 1 && liveLocals.find(local) != liveLocals.end())
+				--delta;
+		}
+		if(inst->hasValueType(ValueType::LOCAL))
+		{
+			const Local* output = inst->getOutput()->local;
+			auto readersIt = openReaders.find(output);
+			//reading and writing the same local does not change the register pressure
+			if(readersIt != openReaders.end() && readersIt->second > (inst->readsLocal(output) ? 1 : 0) && liveLocals.find(output) == liveLocals.end())
+				++delta;
+		}
+		return delta;
+	}
+
+	void update(const IntermediateInstruction* inst)
+	{
+		for(const Local* local : getReadLocals(inst))
+		{
+			if(--openReaders.at(local) == 0)
+				liveLocals.erase(local);
+		}
+		if(inst->hasValueType(ValueType::LOCAL))
+		{
+			const Local* output = inst->getOutput()->local;
+			auto readersIt = openReaders.find(output);
+			if(readersIt != openReaders.end() && readersIt->second > 0)
+				liveLocals.emplace(output);
 		}
-		--instructionsLeft;
-		it.nextInBlock();
 	}
-	if(instructionsLeft == 0)
-		it = basicBlock.end();
-	return it;
-}
+
+	static FastSet<const Local*> getReadLocals(const IntermediateInstruction* inst)
+	{
+		FastSet<const Local*> locals;
+		inst->forUsedLocals([&locals](const Local* local, const LocalUse::Type type) -> void
+		{
+			if(has_flag(type, LocalUse::Type::READER))
+				locals.emplace(local);
+		});
+		return locals;
+	}
+};
 
 /*
- * Finds a suitable instruction within this basic block to replace the NOP with, without violating the reason for the NOP.
- * Also, this instruction MUST not be dependent on any instruction in between the NOP and the replacement-instruction
+ * List scheduler for the instructions within a single basic block.
+ *
+ * In every cycle, the instruction with the highest priority is selected from all instructions whose dependencies are satisfied:
+ * - releasing the hardware mutex, to keep the critical section short
+ * - if more than MAX_SCHEDULING_REGISTER_PRESSURE locals are live, the instruction reducing the number of live locals the most
+ * - instructions which can be executed together with the previous instruction on the other ALU
+ * - the instruction with the longest path to the end of the block
+ * - the instruction appearing first in the original order
+ * If no instruction can be executed without violating a hard latency, a nop is inserted.
+ * Hard latencies are guaranteed even if all instructions which may be combined afterwards (see #combineOperations) are actually combined.
+ *
+ * To limit the increase in register pressure, only the next REPLACE_NOP_MAX_INSTRUCTIONS_TO_CHECK instructions are considered for scheduling
  */
-static InstructionWalker findReplacementCandidate(BasicBlock& basicBlock, const InstructionWalker pos, const DelayType nopReason)
+static void scheduleBasicBlock(BasicBlock& block, BasicBlock* nextBlock, std::size_t& numRemovedNops, std::size_t& numInsertedNops)
 {
-	PROFILE_START(findReplacementCandidate);
-	FastSet<Value> excludedValues;
-	InstructionWalker replacementIt = basicBlock.end();
-	switch(nopReason)
+	std::vector<InstructionWalker> slots;
+	for(InstructionWalker it = block.begin().nextInBlock(); !it.isEndOfBlock(); it.nextInBlock())
+	{
+		if(it.has())
+			slots.push_back(it);
+	}
+	//nops at the end of the block wait for the following block (e.g. for a local read there), so they are kept
+	std::size_t numKeptNops = 0;
+	while(numKeptNops < slots.size() && isRemovableNop(slots[slots.size() - 1 - numKeptNops].get()))
+		++numKeptNops;
+
+	std::vector<ScheduleNode> nodes;
+	std::vector<InstructionWalker> positions;
+	std::vector<IntermediateInstruction*> removedNops;
+	nodes.reserve(slots.size());
+	positions.reserve(slots.size());
+	for(std::size_t i = 0; i < slots.size(); ++i)
+	{
+		if(i < slots.size() - numKeptNops && isRemovableNop(slots[i].get()))
+			removedNops.push_back(slots[i].get());
+		else
+		{
+			nodes.emplace_back(slots[i].get(), isSchedulingBarrier(slots[i].get()), isOrderedInstruction(slots[i].get()));
+			positions.push_back(slots[i]);
+		}
+	}
+	if(nodes.empty())
+		return;
+
+	createDependencyGraph(block, positions, nodes);
+	ScheduleNode endOfBlock(nullptr, true, false);
+	addDelaysAtEndOfBlock(block, nextBlock, nodes, endOfBlock);
+	for(std::size_t index = nodes.size(); index > 0; --index)
+	{
+		ScheduleNode& node = nodes[index - 1];
+		node.height = node.getDuration();
+		for(const Dependency& dep : node.successors)
+		{
+			if(dep.node < nodes.size())
+				node.height = std::max(node.height, dep.latency + nodes[dep.node].height);
+		}
+	}
+
+	std::vector<IntermediateInstruction*> schedule;
+	schedule.reserve(slots.size());
+	RegisterPressure pressure(nodes);
+	std::size_t cycle = 0;
+	std::size_t firstOpen = 0;
+	std::size_t numScheduled = 0;
+	const IntermediateInstruction* lastInstruction = nullptr;
+	bool lastInstructionPaired = false;
+	const auto scheduleNode = [&](const std::size_t index) -> void
+	{
+		ScheduleNode& node = nodes[index];
+		//if the instruction has to wait for a soft latency, the hardware stalls
+		const std::size_t nodeCycle = std::max(cycle, node.earliestCycle);
+		for(const Dependency& dep : node.successors)
+		{
+			ScheduleNode& successor = dep.node < nodes.size() ? nodes[dep.node] : endOfBlock;
+			--successor.numOpenPredecessors;
+			successor.earliestCycle = std::max(successor.earliestCycle, nodeCycle + dep.latency);
+			//a latency of a single cycle is already guaranteed by the order of the instructions
+			if(dep.isHard && dep.latency > 1)
+				successor.hardDelays.push_back(HardDelay{schedule.size(), dep.latency, dep.reason});
+		}
+		lastInstructionPaired = !lastInstructionPaired && lastInstruction != nullptr && canBePaired(lastInstruction, node.instruction);
+		lastInstruction = node.instruction;
+		pressure.update(node.instruction);
+		schedule.push_back(node.instruction);
+		node.isScheduled = true;
+		++numScheduled;
+		cycle = nodeCycle + node.getDuration();
+	};
+	const auto insertNop = [&](const DelayType reason) -> void
+	{
+		schedule.push_back(new Nop(reason));
+		lastInstruction = nullptr;
+		lastInstructionPaired = false;
+		++numInsertedNops;
+		++cycle;
+	};
+
+	while(numScheduled < nodes.size())
 	{
-		case DelayType::BRANCH_DELAY:
-			//This type of NOPs do not yet exist (they are created in CodeGenerator)
-			PROFILE_END(findReplacementCandidate);
-			return basicBlock.end();
-		case DelayType::THREAD_END:
-			//there are no more instructions after THREND
-			PROFILE_END(findReplacementCandidate);
-			return basicBlock.end();
-		case DelayType::WAIT_VPM:
-		case DelayType::WAIT_REGISTER:
-		{
-			//can insert any instruction which does not access the given register/local
-			const InstructionWalker lastInstruction = findPreviousInstruction(basicBlock, pos);
-			if(lastInstruction.isStartOfBlock())
+		while(nodes[firstOpen].isScheduled)
+			++firstOpen;
+		std::size_t best = NO_NODE;
+		std::size_t bestBlocked = NO_NODE;
+		bool bestBlockedIsValid = false;
+		const bool isPressureHigh = pressure.liveLocals.size() > MAX_SCHEDULING_REGISTER_PRESSURE;
+		const std::size_t lastCandidate = std::min(nodes.size(), firstOpen + REPLACE_NOP_MAX_INSTRUCTIONS_TO_CHECK);
+		for(std::size_t index = firstOpen; index < lastCandidate; ++index)
+		{
+			ScheduleNode& node = nodes[index];
+			if(node.isScheduled || node.numOpenPredecessors > 0)
+				continue;
+			const bool isValid = node.checkHardDelays(schedule);
+			if(!isValid || node.earliestCycle > cycle)
 			{
-				//this can e.g. happen, if the vector rotation is the first instruction in a basic block
-				//TODO for now, we can't handle this case, since there may be several writing instructions jumping to the block
-				logging::debug() << "Can't find reason for NOP in block: " << basicBlock.begin()->to_string() << logging::endl;
-				return basicBlock.end();
+				//the instruction would stall or violate a hard latency, remember the one which can be executed first
+				if(bestBlocked == NO_NODE || (isValid && !bestBlockedIsValid) || (isValid == bestBlockedIsValid &&
+						(node.earliestCycle < nodes[bestBlocked].earliestCycle || (node.earliestCycle == nodes[bestBlocked].earliestCycle && node.height > nodes[bestBlocked].height))))
+				{
+					bestBlocked = index;
+					bestBlockedIsValid = isValid;
+				}
+				continue;
 			}
-			excludedValues.insert(lastInstruction->getOutput().value());
-			if(lastInstruction->writesRegister(REG_VPM_IN_ADDR))
+			if(best == NO_NODE)
 			{
-				excludedValues.emplace(Value(REG_VPM_IN_BUSY, TYPE_UNKNOWN));
-				excludedValues.emplace(Value(REG_VPM_IO, TYPE_UNKNOWN));
+				best = index;
+				continue;
 			}
-			if(lastInstruction->writesRegister(REG_VPM_OUT_ADDR))
+			const ScheduleNode& current = nodes[best];
+			const bool releasesMutex = node.instruction->writesRegister(REG_MUTEX);
+			if(releasesMutex != current.instruction->writesRegister(REG_MUTEX))
 			{
-				excludedValues.emplace(Value(REG_VPM_OUT_BUSY, TYPE_UNKNOWN));
-				excludedValues.emplace(Value(REG_VPM_IO, TYPE_UNKNOWN));
+				if(releasesMutex)
+					best = index;
+				continue;
 			}
-			PROFILE_START(findInstructionNotAccessing);
-			replacementIt = findInstructionNotAccessing(basicBlock, pos, excludedValues);
-			PROFILE_END(findInstructionNotAccessing);
-			break;
+			if(isPressureHigh)
+			{
+				//prefer the instruction ending live ranges over starting new ones
+				const int delta = pressure.getDelta(node.instruction);
+				const int currentDelta = pressure.getDelta(current.instruction);
+				if(delta != currentDelta)
+				{
+					if(delta < currentDelta)
+						best = index;
+					continue;
+				}
+			}
+			const bool isPaired = !lastInstructionPaired && lastInstruction != nullptr && canBePaired(lastInstruction, node.instruction);
+			if(isPaired != (!lastInstructionPaired && lastInstruction != nullptr && canBePaired(lastInstruction, current.instruction)))
+			{
+				if(isPaired)
+					best = index;
+				continue;
+			}
+			if(node.height > current.height)
+				best = index;
 		}
-		case DelayType::WAIT_SFU:
-		case DelayType::WAIT_TMU:
-		{
-			//can insert any instruction which doesn't access SFU/TMU or accumulator r4
-			excludedValues.emplace(Value(REG_SFU_EXP2, TYPE_FLOAT));
-			excludedValues.emplace(Value(REG_SFU_LOG2, TYPE_FLOAT));
-			excludedValues.emplace(Value(REG_SFU_OUT, TYPE_FLOAT));
-			excludedValues.emplace(Value(REG_SFU_RECIP, TYPE_FLOAT));
-			excludedValues.emplace(Value(REG_SFU_RECIP_SQRT, TYPE_FLOAT));
-			excludedValues.emplace(Value(REG_TMU0_ADDRESS, TYPE_VOID.toPointerType()));
-			excludedValues.emplace(Value(REG_TMU1_ADDRESS, TYPE_VOID.toPointerType()));
-			PROFILE_START(findInstructionNotAccessing);
-			replacementIt = findInstructionNotAccessing(basicBlock, pos, excludedValues);
-			PROFILE_END(findInstructionNotAccessing);
-			break;
+		if(best != NO_NODE)
+			scheduleNode(best);
+		else if(bestBlocked != NO_NODE && bestBlockedIsValid)
+			//only waits for the hardware, which stalls on its own
+			scheduleNode(bestBlocked);
+		else if(bestBlocked != NO_NODE)
+			insertNop(nodes[bestBlocked].hardDelays.front().reason);
+		else
+			throw CompilationError(CompilationStep::OPTIMIZER, "Failed to find instruction to schedule", nodes[firstOpen].instruction->to_string());
+	}
+	while(!endOfBlock.checkHardDelays(schedule))
+		insertNop(endOfBlock.hardDelays.front().reason);
+
+	//write the scheduled instructions back into the basic block
+	for(InstructionWalker& it : slots)
+		it.release();
+	for(IntermediateInstruction* nop : removedNops)
+		delete nop;
+	numRemovedNops += removedNops.size();
+	InstructionWalker it = slots.back();
+	for(std::size_t i = 0; i < schedule.size(); ++i)
+	{
+		if(i < slots.size())
+			slots[i].reset(schedule[i]);
+		else
+		{
+			it.nextInBlock();
+			it.emplace(schedule[i]);
+		}
+	}
+	//the remaining empty slots are removed afterwards
+}
+
+/*
+ * Calculates a static estimate of the number of cycles required to execute every instruction of the method once.
+ *
+ * This includes the stalls waiting for TMU and VPM DMA accesses and assumes every instruction which can be combined with the previous one to be executed in the same cycle.
+ */
+static std::size_t estimateCycles(Method& method)
+{
+	std::size_t numCycles = 0;
+	for(BasicBlock& block : method)
+	{
+		std::size_t cycle = 0;
+		std::size_t tmuLoadCycle = NO_NODE;
+		std::size_t vpmReadFinishedCycle = NO_NODE;
+		std::size_t vpmWriteFinishedCycle = NO_NODE;
+		DMASetupTracker dmaSetups;
+		const IntermediateInstruction* lastInstruction = nullptr;
+		bool lastInstructionPaired = false;
+		for(InstructionWalker it = block.begin(); !it.isEndOfBlock(); it.nextInBlock())
+		{
+			if(!it.has() || !it->mapsToASMInstruction())
+				continue;
+			if(!lastInstructionPaired && lastInstruction != nullptr && canBePaired(lastInstruction, it.get()))
+			{
+				lastInstructionPaired = true;
+				continue;
+			}
+			if(readsR4(it.get()) && tmuLoadCycle != NO_NODE)
+				cycle = std::max(cycle, tmuLoadCycle + TMU_LATENCY);
+			if(it->readsRegister(REG_VPM_IN_WAIT) && vpmReadFinishedCycle != NO_NODE)
+				cycle = std::max(cycle, vpmReadFinishedCycle);
+			if(it->readsRegister(REG_VPM_OUT_WAIT) && vpmWriteFinishedCycle != NO_NODE)
+				cycle = std::max(cycle, vpmWriteFinishedCycle);
+			dmaSetups.update(it.get());
+			if(triggersTMULoad(it.get()))
+				tmuLoadCycle = cycle;
+			if(it->writesRegister(REG_VPM_IN_ADDR))
+				vpmReadFinishedCycle = cycle + dmaSetups.getLoadCycles();
+			if(it->writesRegister(REG_VPM_OUT_ADDR))
+				vpmWriteFinishedCycle = cycle + dmaSetups.getStoreCycles();
+			lastInstruction = it.get();
+			lastInstructionPaired = false;
+			++cycle;
 		}
-		case DelayType::WAIT_UNIFORM:
-			//TODO could reorder, as long as we do not access uniforms ??
-			PROFILE_END(findReplacementCandidate);
-			return basicBlock.end();
+		numCycles += cycle;
 	}
-	PROFILE_END(findReplacementCandidate);
-	return replacementIt;
+	return numCycles;
 }
 
 InstructionWalker optimizations::moveInstructionUp(InstructionWalker dest, InstructionWalker it)
@@ -227,38 +836,6 @@ InstructionWalker optimizations::moveInstructionUp(InstructionWalker dest, Instr
 	return res;
 }
 
-static void replaceNOPs(BasicBlock& basicBlock, Method& method)
-{
-	InstructionWalker it = basicBlock.begin();
-	while(!it.isEndOfBlock())
-	{
-		const Nop* nop = it.get<Nop>();
-		//only replace NOPs without side-effects (e.g. signal)
-		if(nop != nullptr && !nop->hasSideEffects())
-		{
-			InstructionWalker replacementIt = findReplacementCandidate(basicBlock, it, nop->type);
-			if(!replacementIt.isEndOfBlock())
-			{
-				// replace NOP with instruction, reset instruction at position (do not yet erase, otherwise iterators are wrong!)
-				logging::debug() << "Replacing NOP with: " << replacementIt->to_string() << logging::endl;
-				bool cannotBeCombined = !it->canBeCombined;
-				it.reset(replacementIt.release());
-				if(cannotBeCombined)
-					it->canBeCombined = false;
-			}
-			else if(nop->type == DelayType::WAIT_VPM)
-			{
-				//nops inserted to wait for VPM to finish can be removed again,
-				//since the wait-instruction will correctly wait the remaining number of instructions
-				it.erase();
-				//to not skip the next nop
-				it.previousInBlock();
-			}
-		}
-		it.nextInBlock();
-	}
-}
-
 void optimizations::splitReadAfterWrites(const Module& module, Method& method, const Configuration& config)
 {
 	//try to split up consecutive instructions writing/reading to the same local (so less locals are forced to accumulators) by inserting NOPs
@@ -297,22 +874,8 @@ void optimizations::splitReadAfterWrites(const Module& module, Method& method, c
 				lastWrittenTo = it->hasValueType(ValueType::LOCAL) ? it->getOutput()->local : nullptr;
 				lastInstruction = it;
 			}
-
-			if(it->readsRegister(REG_VPM_IN_WAIT) || it->readsRegister(REG_VPM_OUT_WAIT) || it->readsRegister(REG_VPM_IO))
-			{
-				//TODO constant + x * nrows
-				unsigned numDelays = 0;
-				if(it->readsRegister(REG_VPM_IN_WAIT))
-					numDelays = 6; //XXX 8
-				else if(it->readsRegister(REG_VPM_OUT_WAIT))
-					numDelays = 10; //XXX 12
-				//TODO else insert delay only before first read!
-				for(unsigned i = 0; i < numDelays; ++i)
-				{
-					it.emplace(new Nop(DelayType::WAIT_VPM));
-					it.nextInBlock();
-				}
-			}
+			//no delays are inserted before reading the VPM DMA wait-registers, since reading them stalls until the DMA access is finished anyway.
+			//Instead, the scheduler (#reorderWithinBasicBlocks) fills the duration of the DMA access (as given by the timing model) with independent instructions
 		}
 		it.nextInMethod();
 	}
@@ -320,20 +883,31 @@ void optimizations::splitReadAfterWrites(const Module& module, Method& method, c
 
 void optimizations::reorderWithinBasicBlocks(const Module& module, Method& method, const Configuration& config)
 {
-    /*
-     * TODO re-order instructions to:
-     * 2. combine instructions(try to pair instruction from ADD and MUL ALU together, or moves)
-     * 3. split up VPM setup and wait VPM wait, so the delay can be used productively (only possible if we allow reordering over mutex-release).
-     *    How many instructions to try to insert? 3?
-     */
-	for(BasicBlock& block : method)
+	const std::size_t cyclesBefore = estimateCycles(method);
+	std::size_t numRemovedNops = 0;
+	std::size_t numInsertedNops = 0;
+	for(auto blockIt = method.begin(); blockIt != method.end(); ++blockIt)
 	{
-		// remove NOPs by inserting instructions which do not violate the reason for the NOP
-		PROFILE(replaceNOPs, block, method);
+		auto nextIt = std::next(blockIt);
+		// re-order the instructions to fill the delays (previously filled by NOPs) and to pair instructions for the ADD and MUL ALU
+		PROFILE(scheduleBasicBlock, *blockIt, nextIt != method.end() ? &*nextIt : nullptr, numRemovedNops, numInsertedNops);
 	}
 
 	//after all re-orders are done, remove empty instructions
 	method.cleanEmptyInstructions();
+	const std::size_t cyclesAfter = estimateCycles(method);
+	logging::debug() << "Instruction scheduling removed " << numRemovedNops << " and inserted " << numInsertedNops << " NOPs, estimated cycles for '" << method.name << "': " << cyclesBefore << " -> " << cyclesAfter << logging::endl;
+	PROFILE_COUNTER(15010, "Scheduling removed NOPs", numRemovedNops);
+	PROFILE_COUNTER(15011, "Scheduling inserted NOPs", numInsertedNops);
+	PROFILE_COUNTER(15020, "Estimated cycles (before scheduling)", cyclesBefore);
+	PROFILE_COUNTER_WITH_PREV(15021, "Estimated cycles (after scheduling)", cyclesAfter, 15020);
+	if(module.instrumentation != nullptr)
+	{
+		module.instrumentation->addCounter(method, "Scheduling removed NOPs", numRemovedNops);
+		module.instrumentation->addCounter(method, "Scheduling inserted NOPs", numInsertedNops);
+		module.instrumentation->addCounter(method, "Estimated cycles (before scheduling)", cyclesBefore);
+		module.instrumentation->addCounter(method, "Estimated cycles (after scheduling)", cyclesAfter);
+	}
 }
 
 InstructionWalker optimizations::moveRotationSourcesToAccumulators(const Module& module, Method& method, InstructionWalker it, const Configuration& config)
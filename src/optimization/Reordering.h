@@ -30,8 +30,12 @@ namespace vc4c
 		void splitReadAfterWrites(const Module& module, Method& method, const Configuration& config);
 
 		/*
-		 * Removes nop-instructions inserted for various reasons (waiting on TMU, SFU, splitting up read-after-write) by replacing them with other instructions from within the same basic block.
-		 * The selection of the instruction to insert guarantees semantic equivalence by checking all value and periphery dependencies.
+		 * Re-orders the instructions within every basic block with a list-scheduler to remove nop-instructions inserted for various reasons
+		 * (waiting on TMU, SFU, splitting up read-after-write) and to place instructions for the ADD and MUL ALU next to each other, so they can be combined.
+		 *
+		 * The scheduler works on a dependency-graph of the instructions, which models the dependencies on locals, flags and hardware registers
+		 * as well as the latencies of the SFU, TMU, VPM DMA accesses and register-file read-after-write hazards.
+		 * Nops are only re-inserted where a required delay can't be filled with other instructions.
 		 *
 		 * Example:
 		 *   %5 = add %3, %4
@@ -44,7 +48,7 @@ namespace vc4c
 		 *   %7 = mul24 %2, %3
 		 *   %6 = sub %2, %5
 		 *
-		 * NOTE: This optimization is a very limited implementation of instruction-scheduling and should be replaced by a more general version which can actually re-order instructions
+		 * NOTE: Instructions are never moved over branches, labels, memory barriers or the acquisition of the hardware mutex
 		 */
 		void reorderWithinBasicBlocks(const Module& module, Method& method, const Configuration& config);
 
@@ -6,6 +6,8 @@
 
 #include "SFU.h"
 
+#include "Timing.h"
+
 using namespace vc4c;
 using namespace vc4c::periphery;
 
@@ -17,9 +19,10 @@ InstructionWalker periphery::insertSFUCall(const Register sfuReg, InstructionWal
     it.emplace( new intermediate::MoveOperation(Value(sfuReg, TYPE_FLOAT), arg, cond, setFlags));
     it.nextInBlock();
     //2. wait 2 instructions / don't touch r4
-    it.emplace( new intermediate::Nop(intermediate::DelayType::WAIT_SFU));
-    it.nextInBlock();
-    it.emplace( new intermediate::Nop(intermediate::DelayType::WAIT_SFU));
-    it.nextInBlock();
+    for(unsigned i = 0; i < timing::SFU_RESULT_DELAY; ++i)
+    {
+        it.emplace( new intermediate::Nop(intermediate::DelayType::WAIT_SFU));
+        it.nextInBlock();
+    }
     return it;
 }
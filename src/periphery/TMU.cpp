@@ -6,6 +6,7 @@
 
 #include "TMU.h"
 
+#include "Timing.h"
 #include "../InstructionWalker.h"
 #include "log.h"
 
@@ -199,10 +200,11 @@ InstructionWalker periphery::insertReadTMU(Method& method, InstructionWalker it,
 	it.emplace(new intermediate::MoveOperation(Value(REG_UNIFORM_ADDRESS, TYPE_INT32.toVectorType(16).toPointerType()), imageConfig->createReference()));
 	it.nextInBlock();
 	// 2. need to wait 2 instructions for UNIFORM-pointer to be changed
-	it.emplace(new intermediate::Nop(intermediate::DelayType::WAIT_UNIFORM));
-	it.nextInBlock();
-	it.emplace(new intermediate::Nop(intermediate::DelayType::WAIT_UNIFORM));
-	it.nextInBlock();
+	for(unsigned i = 0; i < timing::UNIFORM_ADDRESS_DELAY; ++i)
+	{
+		it.emplace(new intermediate::Nop(intermediate::DelayType::WAIT_UNIFORM));
+		it.nextInBlock();
+	}
 	// 3. write the TMU addresses
 	if(yCoord)
 	{
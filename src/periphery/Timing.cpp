@@ -0,0 +1,67 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#include "Timing.h"
+
+using namespace vc4c;
+using namespace vc4c::periphery;
+
+/*
+ * The parameters of the VPM DMA timing
+ */
+struct DMATiming
+{
+	//the fixed number of cycles to set up the transfer and to signal its completion
+	unsigned setupCycles;
+	//the number of bytes transferred per cycle within a row
+	unsigned bytesPerCycle;
+	//the additional cycles to start a new memory burst for a row not directly following the previous one in memory
+	unsigned rowBurstCycles;
+};
+
+//a load of a single full row (64 Byte) takes 8 cycles, a store 12 cycles
+static constexpr DMATiming DMA_LOAD_TIMING{4, 16, 2};
+static constexpr DMATiming DMA_STORE_TIMING{8, 16, 2};
+//the values used for unknown setups, the size of a single vector
+static constexpr unsigned DEFAULT_NUM_ROWS = 1;
+static constexpr unsigned DEFAULT_ROW_BYTES = 16 * sizeof(uint32_t);
+
+static unsigned calculateDMACycles(const DMATiming& timing, const unsigned numRows, const unsigned rowBytes, const bool consecutiveRows)
+{
+	const unsigned rowCycles = (rowBytes + timing.bytesPerCycle - 1) / timing.bytesPerCycle;
+	return timing.setupCycles + numRows * rowCycles + (consecutiveRows ? 0 : (numRows - 1) * timing.rowBurstCycles);
+}
+
+static unsigned getTypeSize(const uint8_t mode)
+{
+	return mode >= 4 ? 1 /* Byte */ : mode >= 2 ? 2 /* Half-word */ : 4 /* Word */;
+}
+
+unsigned timing::getDMALoadCycles(const VPRSetup dmaSetup, const VPRSetup strideSetup)
+{
+	if(!dmaSetup.isDMASetup())
+		return calculateDMACycles(DMA_LOAD_TIMING, DEFAULT_NUM_ROWS, DEFAULT_ROW_BYTES, true);
+	const unsigned numRows = dmaSetup.dmaSetup.getNumberRows() == 0 ? 16 : dmaSetup.dmaSetup.getNumberRows();
+	const unsigned rowBytes = (dmaSetup.dmaSetup.getRowLength() == 0 ? 16 : dmaSetup.dmaSetup.getRowLength()) * getTypeSize(dmaSetup.dmaSetup.getMode());
+	//the memory pitch is the distance between the starts of two rows, taken from the extended stride setup for a MPitch of zero
+	unsigned pitch = 0;
+	if(dmaSetup.dmaSetup.getMPitch() != 0)
+		pitch = 8u << dmaSetup.dmaSetup.getMPitch();
+	else if(strideSetup.isStrideSetup())
+		pitch = strideSetup.strideSetup.getStride();
+	return calculateDMACycles(DMA_LOAD_TIMING, numRows, rowBytes, pitch == rowBytes);
+}
+
+unsigned timing::getDMAStoreCycles(const VPWSetup dmaSetup, const VPWSetup strideSetup)
+{
+	if(!dmaSetup.isDMASetup())
+		return calculateDMACycles(DMA_STORE_TIMING, DEFAULT_NUM_ROWS, DEFAULT_ROW_BYTES, true);
+	const unsigned numRows = dmaSetup.dmaSetup.getUnits() == 0 ? 128 : dmaSetup.dmaSetup.getUnits();
+	const unsigned rowBytes = (dmaSetup.dmaSetup.getDepth() == 0 ? 128 : dmaSetup.dmaSetup.getDepth()) * getTypeSize(dmaSetup.dmaSetup.getMode());
+	//the stride is the distance between the end of a row and the start of the next one
+	const bool consecutiveRows = !strideSetup.isStrideSetup() || strideSetup.strideSetup.getStride() == 0;
+	return calculateDMACycles(DMA_STORE_TIMING, numRows, rowBytes, consecutiveRows);
+}
@@ -0,0 +1,66 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#ifndef VC4C_TIMING_H
+#define VC4C_TIMING_H
+
+#include "VPM.h"
+
+namespace vc4c
+{
+	namespace periphery
+	{
+		/*
+		 * The timing model for the periphery accessed by the QPUs.
+		 *
+		 * This is the single source for the latencies of the SFU, the TMUs, the UNIFORM cache and the VPM DMA.
+		 * It is used by the code generator to insert (and by the instruction scheduler to fill) only as many delays as actually required
+		 * and by the emulator to determine when a result becomes available.
+		 */
+		namespace timing
+		{
+			/*
+			 * The number of instructions between writing the SFU register and reading the result from r4, which must not access r4 (Broadcom specification, page 30)
+			 */
+			constexpr unsigned SFU_RESULT_DELAY = 2;
+			/*
+			 * The number of instructions between writing the UNIFORM address register and the next UNIFORM read (Broadcom specification, page 22)
+			 */
+			constexpr unsigned UNIFORM_ADDRESS_DELAY = 2;
+			/*
+			 * The number of instructions between changing the TMU no-swap setting and the next write to a TMU register (Broadcom specification, page 37)
+			 */
+			constexpr unsigned TMU_NOSWAP_DELAY = 3;
+			/*
+			 * The minimum number of cycles between triggering a TMU load and the result being available in r4, when the data is already in the TMU cache.
+			 * Reading r4 earlier stalls the QPU.
+			 */
+			constexpr unsigned TMU_CACHE_HIT_CYCLES = 9;
+			/*
+			 * The number of cycles between triggering a TMU load and the result being available in r4, when the data needs to be read from memory
+			 */
+			constexpr unsigned TMU_MEMORY_CYCLES = 20;
+
+			/*
+			 * Returns the number of cycles the VPM DMA load (from memory into VPM) with the given setup takes,
+			 * i.e. the number of cycles between triggering the load by writing the memory address and reading the VPM_IN_WAIT register without stalling.
+			 *
+			 * The duration is modeled as a fixed setup time plus the time to transfer every row, where rows not consecutive in memory require an additional burst.
+			 * If the setup is not known (e.g. a zero value), the duration of a load of a single full row is returned.
+			 */
+			unsigned getDMALoadCycles(VPRSetup dmaSetup, VPRSetup strideSetup);
+			/*
+			 * Returns the number of cycles the VPM DMA store (from VPM into memory) with the given setup takes,
+			 * i.e. the number of cycles between triggering the store by writing the memory address and reading the VPM_OUT_WAIT register without stalling.
+			 *
+			 * See #getDMALoadCycles for the model used.
+			 */
+			unsigned getDMAStoreCycles(VPWSetup dmaSetup, VPWSetup strideSetup);
+		} /* namespace timing */
+	} /* namespace periphery */
+} /* namespace vc4c */
+
+#endif /* VC4C_TIMING_H */
@@ -732,19 +732,8 @@ const VPMArea* VPM::addArea(const Local* local, const DataType& elementType, boo
 	//lock scratch area, so it cannot expand over reserved VPM areas
 	isScratchLocked = true;
 
-	//find free consecutive space in VPM with the requested size and return it
-	uint8_t rowOffset = 0;
-	for(const VPMArea& area : areas)
-	{
-		if(rowOffset + numRows > area.rowOffset)
-		{
-			//if the new area doesn't fit before the current one, place it after
-			rowOffset = static_cast<unsigned char>(area.rowOffset + area.numRows);
-		}
-	}
-
-	//check if we can fit at the end
-	if(rowOffset + numRows < VPM_NUM_ROWS)
+	const uint8_t rowOffset = findFreeRows(numRows);
+	if(rowOffset < VPM_NUM_ROWS)
 	{
 		//for now align all new VPM areas at the beginning of a column
 		auto it = areas.emplace(VPMArea{isStackArea ? VPMUsage::STACK : VPMUsage::LOCAL_MEMORY, rowOffset, numRows, local});
@@ -757,10 +746,55 @@ const VPMArea* VPM::addArea(const Local* local, const DataType& elementType, boo
 	return nullptr;
 }
 
+const VPMArea* VPM::addSpillingArea(const unsigned numRegisters, const unsigned numQPUs)
+{
+	//every register is stored in a row of its own, which is replicated for every QPU in the directly following rows
+	const unsigned numRows = numRegisters * numQPUs;
+	if(numRows == 0 || numRows >= VPM_NUM_ROWS)
+		return nullptr;
+
+	//lock scratch area, so it cannot expand over reserved VPM areas
+	isScratchLocked = true;
+
+	const uint8_t rowOffset = findFreeRows(static_cast<uint8_t>(numRows));
+	if(rowOffset < VPM_NUM_ROWS)
+	{
+		auto it = areas.emplace(VPMArea{VPMUsage::REGISTER_SPILLING, rowOffset, static_cast<uint8_t>(numRows), nullptr});
+		logging::debug() << "Allocating " << numRows << " rows (per 64 byte) of VPM cache starting at row " << static_cast<unsigned>(rowOffset) << " for spilling " << numRegisters << " registers" << logging::endl;
+		PROFILE_COUNTER(9020, "VPM spilling size", numRows * VPM_NUM_COLUMNS * VPM_WORD_WIDTH);
+		return &(*it.first);
+	}
+	return nullptr;
+}
+
+unsigned VPM::getMaxSpillingRegisters(const unsigned numQPUs) const
+{
+	if(numQPUs == 0)
+		return 0;
+	unsigned numRegisters = 0;
+	while((numRegisters + 1) * numQPUs < VPM_NUM_ROWS && findFreeRows(static_cast<uint8_t>((numRegisters + 1) * numQPUs)) < VPM_NUM_ROWS)
+		++numRegisters;
+	return numRegisters;
+}
+
+uint8_t VPM::findFreeRows(const uint8_t numRows) const
+{
+	//find free consecutive space in VPM with the requested size
+	uint8_t rowOffset = 0;
+	for(const VPMArea& area : areas)
+	{
+		if(rowOffset + numRows > area.rowOffset)
+		{
+			//if the new area doesn't fit before the current one, place it after
+			rowOffset = static_cast<unsigned char>(area.rowOffset + area.numRows);
+		}
+	}
+	//check if we can fit at the end
+	return rowOffset + numRows < VPM_NUM_ROWS ? rowOffset : static_cast<uint8_t>(VPM_NUM_ROWS);
+}
+
 unsigned VPM::getMaxCacheVectors(const DataType& type, bool writeAccess) const
 {
-	if(writeAccess)
-		return std::min(63u, (maximumVPMSize / 16) / (type.getScalarBitCount() / 8));
 	return std::min(15u, (maximumVPMSize / 16) / (type.getScalarBitCount() / 8));
 }
 
@@ -737,11 +737,23 @@ namespace vc4c
 			const VPMArea& getScratchArea();
 			const VPMArea* findArea(const Local* local);
 			const VPMArea* addArea(const Local* local, const DataType& elementType, bool isStackArea, unsigned numStacks = 12);
+			/*
+			 * Reserves an area to spill the given number of registers into, with a separate copy for every QPU.
+			 * The copies of a single register for all QPUs are stored in consecutive rows, so the row of a QPU is the row of the register plus the QPU number.
+			 *
+			 * Returns nullptr, if there is not enough free space left in the VPM
+			 */
+			const VPMArea* addSpillingArea(unsigned numRegisters, unsigned numQPUs = 12);
+			/*
+			 * The maximum number of registers which can be spilled into the free space left in the VPM, with a copy for each of the given number of QPUs
+			 */
+			unsigned getMaxSpillingRegisters(unsigned numQPUs = 12) const;
 
 			/*
 			 * The maximum number of vectors (of the given type) which can be cached in this VPM.
 			 *
-			 * On the hardware side, this is limited to 16 for reading and 64 for writing (see Broadcom spec, page 53)
+			 * On the hardware side, this is limited to 16 for reading and 64 for writing (see Broadcom spec, page 53).
+			 * Writes are limited to the same number as reads, so the areas reserved afterwards (e.g. for register spilling) still fit.
 			 */
 			unsigned getMaxCacheVectors(const DataType& type, bool writeAccess) const;
 
@@ -790,6 +802,10 @@ namespace vc4c
 			//whether the scratch area is locked to a fixed size
 			bool isScratchLocked;
 
+			/*
+			 * Returns the offset of the first row of a free space of the given size, the number of rows in VPM if there is no such space
+			 */
+			uint8_t findFreeRows(uint8_t numRows) const;
 			InstructionWalker insertLockMutex(InstructionWalker it, bool useMutex) const;
 			InstructionWalker insertUnlockMutex(InstructionWalker it, bool useMutex) const;
 		};
@@ -21,7 +21,12 @@ using namespace vc4c::spirv2qasm;
 
 static Value toNewLocal(Method& method, const uint32_t id, const uint32_t typeID, const TypeMapping& typeMappings, LocalTypeMapping& localTypes)
 {
-    localTypes[id] = typeID;
+    //the types of all results are already registered by the parser, since inserting into the map
+    //would not be safe while mapping several methods in parallel
+    auto it = localTypes.find(id);
+    if(it == localTypes.end())
+    	throw CompilationError(CompilationStep::PARSER, "Type of result was not registered before mapping the instruction", std::to_string(id));
+    it->second = typeID;
     return method.findOrCreateLocal(typeMappings.at(typeID), std::string("%") + std::to_string(id))->createReference();
 }
 
@@ -228,6 +233,16 @@ Optional<Value> SPIRVCallSite::precalculate(const TypeMapping& types, const Cons
 	return NO_VALUE;
 }
 
+const Optional<uint32_t>& SPIRVCallSite::getMethodID() const
+{
+	return methodID;
+}
+
+const Optional<std::string>& SPIRVCallSite::getMethodName() const
+{
+	return methodName;
+}
+
 SPIRVReturn::SPIRVReturn(SPIRVMethod& method) : SPIRVOperation(UNDEFINED_ID, method)
 {
 
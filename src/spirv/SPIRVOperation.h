@@ -54,6 +54,11 @@ namespace vc4c
 			virtual void mapInstruction(TypeMapping& types, ConstantMapping& constants, LocalTypeMapping& localTypes, MethodMapping& methods, AllocationMapping& memoryAllocated) const = 0;
 			virtual Optional<Value> precalculate(const TypeMapping& types, const ConstantMapping& constants, const AllocationMapping& memoryAllocated) const = 0;
 
+			inline Method& getMethod() const
+			{
+				return *method.method.get();
+			}
+
 		protected:
 			const uint32_t id;
 			SPIRVMethod& method;
@@ -102,6 +107,12 @@ namespace vc4c
 			void mapInstruction(TypeMapping& types, ConstantMapping& constants, LocalTypeMapping& localTypes, MethodMapping& methods, AllocationMapping& memoryAllocated) const override;
 			Optional<Value> precalculate(const TypeMapping& types, const ConstantMapping& constants, const AllocationMapping& memoryAllocated) const override;
 
+			/*
+			 * The called method is either given by its ID (for functions defined in the module) or by its name (e.g. for OpenCL built-ins)
+			 */
+			const Optional<uint32_t>& getMethodID() const;
+			const Optional<std::string>& getMethodName() const;
+
 		private:
 			Optional<uint32_t> methodID;
 			const uint32_t typeID;
@@ -6,11 +6,14 @@
 
 #include "SPIRVParser.h"
 
+#include "../BackgroundWorker.h"
+#include "../Profiler.h"
 #include "../intermediate/IntermediateInstruction.h"
 #include "../intrinsics/Images.h"
 #include "SPIRVHelper.h"
 #include "log.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
@@ -156,10 +159,43 @@ void SPIRVParser::parse(Module& module)
         }
     }
 
+    //functions not called by any kernel are never used, so there is no need to map them
+    dropUnreachableMethods();
+
     //map SPIRVOperations to IntermediateInstructions
     logging::debug() << "Mapping instructions to intermediate..." << logging::endl;
-    for (const std::unique_ptr<SPIRVOperation>& op : instructions) {
-        op->mapInstruction(typeMappings, constantMappings, localTypes, methods, memoryAllocatedData);
+    if(module.compilationConfig.parallelFrontend)
+    {
+    	//the instructions of the single methods are independent of each other, so the methods can be mapped in parallel,
+    	//as long as the instructions within a method are mapped in order
+    	std::vector<std::vector<const SPIRVOperation*>> methodInstructions;
+    	FastMap<const Method*, std::size_t> methodIndices;
+    	for(const std::unique_ptr<SPIRVOperation>& op : instructions)
+    	{
+    		auto it = methodIndices.emplace(&op->getMethod(), methodInstructions.size()).first;
+    		if(it->second == methodInstructions.size())
+    			methodInstructions.emplace_back();
+    		methodInstructions[it->second].push_back(op.get());
+    	}
+    	std::vector<std::function<void()>> tasks;
+    	tasks.reserve(methodInstructions.size());
+    	for(const auto& ops : methodInstructions)
+    	{
+    		tasks.emplace_back([this, &ops]() -> void
+			{
+    			MemoryArena::Scope arenaScope(ops.front()->getMethod().arena);
+    			for(const SPIRVOperation* op : ops)
+    				op->mapInstruction(typeMappings, constantMappings, localTypes, methods, memoryAllocatedData);
+			});
+    	}
+    	threading::BackgroundWorker::scheduleAll(tasks, "Front-end", module.compilationConfig.numThreads);
+    }
+    else
+    {
+		for (const std::unique_ptr<SPIRVOperation>& op : instructions) {
+			MemoryArena::Scope arenaScope(op->getMethod().arena);
+			op->mapInstruction(typeMappings, constantMappings, localTypes, methods, memoryAllocatedData);
+		}
     }
 
     //apply kernel meta-data, decorations, ...
@@ -205,6 +241,82 @@ void SPIRVParser::parse(Module& module)
 	}
 }
 
+void SPIRVParser::dropUnreachableMethods()
+{
+	//without any kernel, nothing is compiled anyway
+	if(std::none_of(methods.begin(), methods.end(), [](const std::pair<const uint32_t, SPIRVMethod>& m) -> bool { return m.second.method->isKernel; }))
+		return;
+	//collect the IDs of the methods called by every method
+	FastMap<const Method*, std::vector<uint32_t>> calledMethods;
+	FastMap<std::string, std::vector<uint32_t>> methodsByName;
+	for(const auto& m : methods)
+		methodsByName[m.second.method->name].push_back(m.first);
+	for(const std::unique_ptr<SPIRVOperation>& op : instructions)
+	{
+		const SPIRVCallSite* call = dynamic_cast<const SPIRVCallSite*>(op.get());
+		if(call == nullptr)
+			continue;
+		std::vector<uint32_t>& callees = calledMethods[&op->getMethod()];
+		if(call->getMethodID())
+			callees.push_back(call->getMethodID().value());
+		else if(methodsByName.find(call->getMethodName().value()) != methodsByName.end())
+		{
+			const auto& ids = methodsByName.at(call->getMethodName().value());
+			callees.insert(callees.end(), ids.begin(), ids.end());
+		}
+	}
+
+	FastSet<uint32_t> reachableMethods;
+	std::vector<uint32_t> openMethods;
+	for(const auto& m : methods)
+	{
+		if(m.second.method->isKernel)
+		{
+			reachableMethods.insert(m.first);
+			openMethods.push_back(m.first);
+		}
+	}
+	while(!openMethods.empty())
+	{
+		const Method* method = methods.at(openMethods.back()).method.get();
+		openMethods.pop_back();
+		auto it = calledMethods.find(method);
+		if(it == calledMethods.end())
+			continue;
+		for(const uint32_t callee : it->second)
+		{
+			if(reachableMethods.insert(callee).second)
+				openMethods.push_back(callee);
+		}
+	}
+
+	//remove the operations first, since they reference their methods
+	FastSet<const Method*> unreachableMethods;
+	for(const auto& m : methods)
+	{
+		if(reachableMethods.find(m.first) == reachableMethods.end())
+			unreachableMethods.insert(m.second.method.get());
+	}
+	instructions.erase(std::remove_if(instructions.begin(), instructions.end(), [&unreachableMethods](const std::unique_ptr<SPIRVOperation>& op) -> bool
+	{
+		return unreachableMethods.find(&op->getMethod()) != unreachableMethods.end();
+	}), instructions.end());
+	const std::size_t numMethods = methods.size();
+	auto it = methods.begin();
+	while(it != methods.end())
+	{
+		if(reachableMethods.find(it->first) == reachableMethods.end())
+		{
+			logging::debug() << "Skipping function not called by any kernel: " << it->second.method->name << logging::endl;
+			it = methods.erase(it);
+		}
+		else
+			++it;
+	}
+	PROFILE_COUNTER(30, "Skipped unreachable functions", unreachableMethods.size());
+	logging::info() << "Skipped " << unreachableMethods.size() << " of " << numMethods << " functions not reachable from any kernel" << logging::endl;
+}
+
 spv_result_t SPIRVParser::parseHeader(spv_endianness_t endian, uint32_t magic, uint32_t version, uint32_t generator, uint32_t id_bound, uint32_t reserved)
 {
     //see: https://www.khronos.org/registry/spir-v/specs/1.2/SPIRV.html#_a_id_physicallayout_a_physical_layout_of_a_spir_v_module_and_instruction
@@ -433,6 +545,11 @@ spv_result_t SPIRVParser::parseInstruction(const spv_parsed_instruction_t* parse
      * Only opcodes for supported capabilities (or standard-opcodes) are listed here
      */
 
+    //the types of all results within methods are registered here, so mapping the instructions (possibly in parallel) never inserts into the map.
+    //Instructions with a result of a different type overwrite this below
+    if(currentMethod != nullptr && parsed_instruction->result_id != 0 && parsed_instruction->type_id != 0)
+    	localTypes.emplace(parsed_instruction->result_id, parsed_instruction->type_id);
+
     //see: https://www.khronos.org/registry/spir-v/specs/1.0/SPIRV.html#_a_id_instructions_a_instructions
     switch (static_cast<SpvOp>(parsed_instruction->opcode)) {
     case SpvOpNop:
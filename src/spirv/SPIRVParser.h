@@ -81,6 +81,7 @@ namespace vc4c
 			Module* module;
 
 			std::pair<spv_result_t, Optional<Value>> calculateConstantOperation(const spv_parsed_instruction_t* instruction);
+			void dropUnreachableMethods();
 		};
 	} // namespace spirv2qasm
 } // namespace vc4c
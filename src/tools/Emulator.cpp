@@ -15,16 +15,27 @@
 #include "../asm/KernelInfo.h"
 #include "../asm/LoadInstruction.h"
 #include "../asm/SemaphoreInstruction.h"
+#include "../BackgroundWorker.h"
+#include "../Profiler.h"
+#include "../periphery/Timing.h"
 #include "../periphery/VPM.h"
 
 #include "log.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <numeric>
 
+#ifdef MULTI_THREADED
+#include <condition_variable>
+#include <mutex>
+#include <sys/prctl.h>
+#include <thread>
+#endif
+
 using namespace vc4c;
 using namespace vc4c::tools;
 
@@ -37,6 +48,17 @@ static Value ELEMENT_NUMBER(ContainerValue({
 	Value(SmallImmediate(12), TYPE_INT8), Value(SmallImmediate(13), TYPE_INT8), Value(SmallImmediate(14), TYPE_INT8), Value(SmallImmediate(15), TYPE_INT8)
 }), TYPE_INT8);
 
+/*
+ * Whether messages of the given level are logged at all.
+ *
+ * The messages written for every emulated instruction (and register access) are only built if they are actually logged,
+ * since converting the values to strings takes most of the emulation time otherwise.
+ */
+static bool isLogged(logging::Level level)
+{
+	return logging::LOGGER && logging::LOGGER->willBeLogged(level);
+}
+
 std::size_t EmulationData::calcParameterSize() const
 {
 	return std::accumulate(parameter.begin(), parameter.end(), 0, [](std::size_t size, const std::pair<uint32_t, vc4c::Optional<std::vector<uint32_t>>>& pair) -> std::size_t
@@ -50,18 +72,76 @@ tools::Word EmulationData::calcNumWorkItems() const
 	return workGroup.localSizes[0] * workGroup.localSizes[1] * workGroup.localSizes[2] * workGroup.numGroups[0] * workGroup.numGroups[1] * workGroup.numGroups[2];
 }
 
+static constexpr std::size_t PAGE_BYTES = Memory::WORDS_PER_PAGE * sizeof(tools::Word);
+
+Memory::Memory(std::size_t size) : numWords(size)
+{
+	pages.reserve((size + WORDS_PER_PAGE - 1) / WORDS_PER_PAGE);
+	for(std::size_t i = 0; i < size; i += WORDS_PER_PAGE)
+		pages.emplace_back(std::make_shared<Page>());
+}
+
+Memory::Page& Memory::getWritablePage(std::size_t pageIndex)
+{
+	std::shared_ptr<Page>& page = pages[pageIndex];
+	if(page.use_count() > 1)
+		//the page is shared with other snapshots, so copy it before it can be modified
+		page = std::make_shared<Page>(*page);
+	return *page;
+}
+
 tools::Word* Memory::getWordAddress(MemoryAddress address)
 {
-	if(address >= data.size() * sizeof(Word))
+	if(address >= getMaximumAddress())
+		throw CompilationError(CompilationStep::GENERAL, "Memory address is out of bounds, consider using larger buffer");
+	return getWritablePage(address / PAGE_BYTES).data() + (address % PAGE_BYTES) / sizeof(Word);
+}
+
+const tools::Word* Memory::getWordAddress(MemoryAddress address) const
+{
+	if(address >= getMaximumAddress())
+		throw CompilationError(CompilationStep::GENERAL, "Memory address is out of bounds, consider using larger buffer");
+	return pages[address / PAGE_BYTES]->data() + (address % PAGE_BYTES) / sizeof(Word);
+}
+
+void Memory::readBytes(MemoryAddress address, void* destination, std::size_t numBytes) const
+{
+	if(address + numBytes > getMaximumAddress())
+		throw CompilationError(CompilationStep::GENERAL, "Memory address is out of bounds, consider using larger buffer");
+	uint8_t* dest = reinterpret_cast<uint8_t*>(destination);
+	while(numBytes > 0)
+	{
+		//the range may span several pages, which are not stored contiguously
+		const std::size_t offset = address % PAGE_BYTES;
+		const std::size_t length = std::min(numBytes, PAGE_BYTES - offset);
+		memcpy(dest, reinterpret_cast<const uint8_t*>(pages[address / PAGE_BYTES]->data()) + offset, length);
+		dest += length;
+		address += static_cast<MemoryAddress>(length);
+		numBytes -= length;
+	}
+}
+
+void Memory::writeBytes(MemoryAddress address, const void* source, std::size_t numBytes)
+{
+	if(address + numBytes > getMaximumAddress())
 		throw CompilationError(CompilationStep::GENERAL, "Memory address is out of bounds, consider using larger buffer");
-	return data.data() + (address / sizeof(Word));
+	const uint8_t* src = reinterpret_cast<const uint8_t*>(source);
+	while(numBytes > 0)
+	{
+		const std::size_t offset = address % PAGE_BYTES;
+		const std::size_t length = std::min(numBytes, PAGE_BYTES - offset);
+		memcpy(reinterpret_cast<uint8_t*>(getWritablePage(address / PAGE_BYTES).data()) + offset, src, length);
+		src += length;
+		address += static_cast<MemoryAddress>(length);
+		numBytes -= length;
+	}
 }
 
 Value Memory::readWord(MemoryAddress address) const
 {
 	if(address % sizeof(Word) != 0)
 		logging::debug() << "Reading word from non-word-aligned memory location will be truncated to align with word-boundaries: " << address << logging::endl;
-	return Value(Literal(data.at(address / sizeof(Word))), TYPE_INT32);
+	return Value(Literal(*getWordAddress(address)), TYPE_INT32);
 }
 
 MemoryAddress Memory::incrementAddress(MemoryAddress address, const DataType& typeSize) const
@@ -71,13 +151,36 @@ MemoryAddress Memory::incrementAddress(MemoryAddress address, const DataType& ty
 
 MemoryAddress Memory::getMaximumAddress() const
 {
-	return static_cast<MemoryAddress>(data.size() * sizeof(Word));
+	return static_cast<MemoryAddress>(numWords * sizeof(Word));
 }
 
 void Memory::setUniforms(const std::vector<Word>& uniforms, MemoryAddress address)
 {
-	std::size_t offset = address / sizeof(Word);
-	std::copy_n(uniforms.begin(), uniforms.size(), data.begin() + offset);
+	writeBytes(address, uniforms.data(), uniforms.size() * sizeof(Word));
+}
+
+Memory Memory::snapshot() const
+{
+	return Memory(pages, numWords);
+}
+
+void Memory::mergeChanges(const Memory& snapshot, const Memory& base)
+{
+	if(snapshot.numWords != numWords || base.numWords != numWords)
+		throw CompilationError(CompilationStep::GENERAL, "Cannot merge memory of different sizes");
+	for(std::size_t p = 0; p < pages.size(); ++p)
+	{
+		if(snapshot.pages[p] == base.pages[p])
+			//page not modified at all
+			continue;
+		const Page& modified = *snapshot.pages[p];
+		const Page& original = *base.pages[p];
+		for(std::size_t i = 0; i < WORDS_PER_PAGE; ++i)
+		{
+			if(modified[i] != original[i])
+				getWritablePage(p)[i] = modified[i];
+		}
+	}
 }
 
 bool Mutex::isLocked() const
@@ -107,6 +210,91 @@ void Mutex::unlock(uint8_t qpu)
 	locked = false;
 }
 
+SIMDVector::SIMDVector(const DataType& type) : elements{}, undefinedElements(0xFFFF), type(type)
+{
+}
+
+bool SIMDVector::operator==(const SIMDVector& other) const
+{
+	if(type != other.type || undefinedElements != other.undefinedElements)
+		return false;
+	for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+	{
+		if(!undefinedElements.test(i) && elements[i] != other.elements[i])
+			return false;
+	}
+	return true;
+}
+
+static Literal toLiteral(tools::Word element, const DataType& type)
+{
+	return type.isFloatingType() ? Literal(bit_cast<tools::Word, float>(element)) : Literal(element);
+}
+
+Value SIMDVector::toValue() const
+{
+	if(undefinedElements.all())
+		return Value(type);
+	if(undefinedElements.none() && std::all_of(elements.begin(), elements.end(), [this](Word element) -> bool { return element == elements[0];}))
+		return Value(toLiteral(elements[0], type), type);
+	const DataType elementType = type.complexType ? type : type.toVectorType(1);
+	Value result(ContainerValue(NATIVE_VECTOR_SIZE), type);
+	for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+	{
+		if(undefinedElements.test(i))
+			result.container.elements.push_back(UNDEFINED_VALUE);
+		else
+			result.container.elements.push_back(Value(toLiteral(elements[i], elementType), elementType));
+	}
+	return result;
+}
+
+std::string SIMDVector::to_string(std::bitset<NATIVE_VECTOR_SIZE> elementMask) const
+{
+	if(elementMask.all())
+		return toValue().to_string(true, true);
+	std::vector<std::string> parts;
+	for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+	{
+		if(!elementMask.test(i))
+			parts.push_back("-");
+		else if(undefinedElements.test(i))
+			parts.push_back(UNDEFINED_VALUE.to_string(false, true));
+		else
+			parts.push_back(Value(toLiteral(elements[i], type), type.complexType ? type : type.toVectorType(1)).to_string(false, true));
+	}
+	return (type.to_string() + " {") + vc4c::to_string<std::string>(parts) + "}";
+}
+
+Optional<SIMDVector> SIMDVector::fromValue(const Value& val)
+{
+	SIMDVector result(val.type);
+	if(val.isUndefined())
+		return result;
+	if(auto lit = val.getLiteralValue())
+	{
+		result.elements.fill(lit->unsignedInt());
+		result.undefinedElements.reset();
+		return result;
+	}
+	if(val.hasType(ValueType::CONTAINER))
+	{
+		for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE && i < val.container.elements.size(); ++i)
+		{
+			const Value& element = val.container.elements[i];
+			if(auto lit = element.getLiteralValue())
+			{
+				result.elements[i] = lit->unsignedInt();
+				result.undefinedElements.reset(i);
+			}
+			else if(!element.isUndefined())
+				return {};
+		}
+		return result;
+	}
+	return {};
+}
+
 static std::string toRegisterWriteString(const Value& val, std::bitset<16> elementMask)
 {
 	if(elementMask.all())
@@ -123,21 +311,45 @@ static std::string toRegisterWriteString(const Value& val, std::bitset<16> eleme
 	return (val.type.to_string() + " {") + to_string<std::string>(parts) + "}";
 }
 
-void Registers::writeRegister(Register reg, const Value& val, std::bitset<16> elementMask)
+/*
+ * Whether the register is stored in the register-files or accumulators, which are handled on the native representation
+ */
+static bool isStorageRegister(Register reg)
 {
-	logging::debug() << "Writing into register '" << reg.to_string(true,  false) << "': " << toRegisterWriteString(val, elementMask) << logging::endl;
-	if(reg.isGeneralPurpose())
+	return reg.isGeneralPurpose() || (reg.isAccumulator() && reg.num != REG_TMU_NOSWAP.num);
+}
+
+void Registers::writeRegister(Register reg, const SIMDVector& val, std::bitset<16> elementMask)
+{
+	if(!isStorageRegister(reg))
+	{
+		//periphery registers operate on the Value objects
+		writeRegister(reg, val.toValue(), elementMask);
+		return;
+	}
+	if(isLogged(logging::Level::DEBUG))
+		logging::debug() << "Writing into register '" << reg.to_string(true,  false) << "': " << val.to_string(elementMask) << logging::endl;
+	if(reg.isGeneralPurpose() || reg.num == REG_REPLICATE_ALL.num)
+		//the physical file A or B is important for the replication!
 		writeStorageRegister(reg, val, elementMask);
-	else if(reg.isAccumulator())
+	else
+		writeStorageRegister(Register(RegisterFile::ACCUMULATOR, reg.num), val, elementMask);
+}
+
+void Registers::writeRegister(Register reg, const Value& val, std::bitset<16> elementMask)
+{
+	if(isStorageRegister(reg))
 	{
-		if(reg.num == REG_TMU_NOSWAP.num)
-			qpu.tmus.setTMUNoSwap(getActualValue(val));
-		else if(reg.num == REG_REPLICATE_ALL.num)
-			//the physical file A or B is important here!
-			writeStorageRegister(reg, val, elementMask);
-		else
-			writeStorageRegister(Register(RegisterFile::ACCUMULATOR, reg.num), val, elementMask);
+		auto vector = SIMDVector::fromValue(getActualValue(val));
+		if(!vector)
+			throw CompilationError(CompilationStep::GENERAL, "Invalid value to write into register", val.to_string());
+		writeRegister(reg, vector.value(), elementMask);
+		return;
 	}
+	if(isLogged(logging::Level::DEBUG))
+		logging::debug() << "Writing into register '" << reg.to_string(true,  false) << "': " << toRegisterWriteString(val, elementMask) << logging::endl;
+	if(reg.num == REG_TMU_NOSWAP.num)
+		qpu.tmus.setTMUNoSwap(getActualValue(val));
 	else if(reg.num == REG_HOST_INTERRUPT.num)
 	{
 		if(hostInterrupt)
@@ -192,12 +404,23 @@ void Registers::writeRegister(Register reg, const Value& val, std::bitset<16> el
 		throw CompilationError(CompilationStep::GENERAL, "Conditional write to periphery registers is not allowed!");
 }
 
+std::pair<SIMDVector, bool> Registers::readVector(Register reg)
+{
+	if(reg.isGeneralPurpose() || (reg.file == RegisterFile::ACCUMULATOR && reg.num != REG_SFU_OUT.num))
+		return std::make_pair(readStorageRegister(reg), true);
+	auto pair = readRegister(reg);
+	auto vector = SIMDVector::fromValue(getActualValue(pair.first));
+	if(!vector)
+		throw CompilationError(CompilationStep::GENERAL, "Invalid value read from register", pair.first.to_string());
+	return std::make_pair(vector.value(), pair.second);
+}
+
 std::pair<Value, bool> Registers::readRegister(Register reg)
 {
 	if(reg.isGeneralPurpose())
-		return std::make_pair(readStorageRegister(reg), true);
+		return std::make_pair(readStorageRegister(reg).toValue(), true);
 	if(reg.file == RegisterFile::ACCUMULATOR && reg.num != REG_SFU_OUT.num)
-		return std::make_pair(readStorageRegister(reg), true);
+		return std::make_pair(readStorageRegister(reg).toValue(), true);
 	if(reg.num == REG_SFU_OUT.num)
 	{
 		if(readCache.find(REG_SFU_OUT) != readCache.end())
@@ -275,75 +498,78 @@ Value Registers::getActualValue(const Value& val)
 	throw CompilationError(CompilationStep::GENERAL, "Invalid value-type in emulator", val.to_string());
 }
 
-Value Registers::readStorageRegister(Register reg)
+static std::size_t toStorageIndex(Register reg)
 {
-	if(storageRegisters.find(reg) == storageRegisters.end())
-	{
-		logging::warn() << "Reading from register not previously defined: " << reg.to_string() << logging::endl;
-		return UNDEFINED_VALUE;
-	}
-	logging::debug() << "Reading from register '" << reg.to_string(true,  true) << "': " << storageRegisters.at(reg).to_string(true, true) << logging::endl;
-	return storageRegisters.at(reg);
+	if(reg.isGeneralPurpose())
+		return reg.file == RegisterFile::PHYSICAL_B ? 32 + reg.num : reg.num;
+	if(reg.num >= REG_ACC0.num && reg.num <= REG_ACC5.num)
+		return 64 + (reg.num - REG_ACC0.num);
+	throw CompilationError(CompilationStep::GENERAL, "Register has no storage", reg.to_string());
 }
 
-static Value toStorageValue(const Value& oldVal, const Value& newVal, std::bitset<16> elementMask)
+const SIMDVector& Registers::readStorageRegister(Register reg)
 {
-	if(elementMask.all())
-		return newVal;
-	if(elementMask.none())
-		return oldVal;
-	Value result(ContainerValue(NATIVE_VECTOR_SIZE), newVal.type);
-
-	for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+	static const SIMDVector undefinedVector(TYPE_UNKNOWN);
+	const std::size_t index = toStorageIndex(reg);
+	if(!definedRegisters.test(index))
 	{
-		const Value& newElement = newVal.hasType(ValueType::CONTAINER) ? newVal.container.elements.at(i) : newVal;
-		const Value& oldElement = oldVal.hasType(ValueType::CONTAINER) ? oldVal.container.elements.at(i) : oldVal;
-		if(elementMask.test(i))
-			result.container.elements.push_back(newElement);
-		else
-			result.container.elements.push_back(oldElement);
+		logging::warn() << "Reading from register not previously defined: " << reg.to_string() << logging::endl;
+		return undefinedVector;
 	}
-	return result;
+	if(isLogged(logging::Level::DEBUG))
+		logging::debug() << "Reading from register '" << reg.to_string(true,  true) << "': " << storageRegisters[index].to_string() << logging::endl;
+	return storageRegisters[index];
 }
 
-void Registers::writeStorageRegister(Register reg, const Value& val, std::bitset<16> elementMask)
+void Registers::writeStorageRegister(Register reg, const SIMDVector& val, std::bitset<16> elementMask)
 {
-	if(storageRegisters.find(reg) == storageRegisters.end())
-		storageRegisters.emplace(reg, val);
-	else
-		storageRegisters.at(reg) = toStorageValue(storageRegisters.at(reg), getActualValue(val), elementMask);
-	if(reg.num == REG_REPLICATE_ALL.num)
+	if(reg.num == REG_REPLICATE_ALL.num && reg.file != RegisterFile::ACCUMULATOR)
 	{
-		//is not actually stored in the physical file A or B
-		storageRegisters.erase(reg);
-		storageRegisters.emplace(REG_ACC5, val);
-
-		const Value actualValue = getActualValue(val);
-		if(actualValue.getLiteralValue() || actualValue.isUndefined())
-		{
-			//replicate same value across quads -> just store literal
-			storageRegisters.at(REG_ACC5) = actualValue;
-			return;
-		}
-		const auto& elements = actualValue.container.elements;
+		//is not actually stored in the physical file A or B, but replicated into r5 regardless of the element mask
+		SIMDVector replicated(val.type);
 		if(reg.file == RegisterFile::PHYSICAL_A)
 		{
 			//per-quad replication
-			storageRegisters.at(REG_ACC5) = Value(ContainerValue({
-				elements.at(0), elements.at(0), elements.at(0), elements.at(0),
-				elements.at(4), elements.at(4), elements.at(4), elements.at(4),
-				elements.at(8), elements.at(8), elements.at(8), elements.at(8),
-				elements.at(12), elements.at(12), elements.at(12), elements.at(12)
-			}), actualValue.type.toVectorType(16));
+			for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+			{
+				replicated.elements[i] = val.elements[i & ~3u];
+				replicated.undefinedElements.set(i, val.undefinedElements.test(i & ~3u));
+			}
 		}
 		else if(reg.file == RegisterFile::PHYSICAL_B)
 		{
 			//across all elements replication
-			storageRegisters.at(REG_ACC5) = Value(elements.at(0).getLiteralValue().value(), actualValue.type.toVectorType(16));
+			replicated.elements.fill(val.elements[0]);
+			if(!val.undefinedElements.test(0))
+				replicated.undefinedElements.reset();
 		}
 		else
 			throw CompilationError(CompilationStep::GENERAL, "Failed to determine register-file for replication register", reg.to_string());
+		if(!(val.undefinedElements.all() || (val.undefinedElements.none() && std::all_of(val.elements.begin(), val.elements.end(), [&val](Word element) -> bool { return element == val.elements[0];}))))
+			//only values differing between the elements become vectors, same as for the Value objects
+			replicated.type = val.type.toVectorType(16);
+		storageRegisters[toStorageIndex(REG_ACC5)] = replicated;
+		definedRegisters.set(toStorageIndex(REG_ACC5));
+		return;
+	}
+	const std::size_t index = toStorageIndex(reg);
+	SIMDVector& storage = storageRegisters[index];
+	if(!definedRegisters.test(index))
+	{
+		storage = SIMDVector(val.type);
+		definedRegisters.set(index);
+	}
+	if(elementMask.none())
+		return;
+	for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+	{
+		if(elementMask.test(i))
+		{
+			storage.elements[i] = val.elements[i];
+			storage.undefinedElements.set(i, val.undefinedElements.test(i));
+		}
 	}
+	storage.type = val.type;
 }
 
 void Registers::setReadCache(Register reg, const Value& val)
@@ -356,13 +582,14 @@ void Registers::setReadCache(Register reg, const Value& val)
 
 Value UniformCache::readUniform()
 {
-	if(lastAddressSetCycle != 0 && lastAddressSetCycle + 2 > qpu.getCurrentCycle())
+	if(lastAddressSetCycle != 0 && lastAddressSetCycle + periphery::timing::UNIFORM_ADDRESS_DELAY > qpu.getCurrentCycle())
 		//see Broadcom specification, page 22
-		logging::warn() << "Reading UNIFORM within 2 cycles of last UNIFORM reset" << logging::endl;
+		logging::warn() << "Reading UNIFORM within " << periphery::timing::UNIFORM_ADDRESS_DELAY << " cycles of last UNIFORM reset" << logging::endl;
 	Value val = memory.readWord(uniformAddress);
 	// do not increment UNIFORM pointer for multiple reads in same instruction
 	uniformAddress = memory.incrementAddress(uniformAddress, TYPE_INT32);
-	logging::debug() << "Reading UNIFORM value: " << val.to_string(false, true) << logging::endl;
+	if(isLogged(logging::Level::DEBUG))
+		logging::debug() << "Reading UNIFORM value: " << val.to_string(false, true) << logging::endl;
 	return val;
 }
 
@@ -397,13 +624,13 @@ std::pair<Value, bool> TMUs::readTMU()
 			queue = &tmuQueues.at(1);
 	}
 
-	//always blocks at least 9 cycles (reading from TMU cache)
-	bool blocks = queue->front().second + 9 > qpu.getCurrentCycle();
+	//always blocks until the value is in the TMU cache
+	bool blocks = queue->front().second + periphery::timing::TMU_CACHE_HIT_CYCLES > qpu.getCurrentCycle();
 	const Value val = queue->front().first;
 	if(!blocks)
 	{
-		if(queue->front().second + 20 > qpu.getCurrentCycle())
-			//blocks up to 20 cycles when reading from RAM
+		if(queue->front().second + periphery::timing::TMU_MEMORY_CYCLES > qpu.getCurrentCycle())
+			//blocks longer when reading from RAM
 			logging::debug() << "Distance between triggering of TMU read and read is " << (qpu.getCurrentCycle() - queue->front().second) << ", additional stalls may be introduced" << logging::endl;
 		queue->pop_front();
 	}
@@ -466,8 +693,8 @@ void TMUs::triggerTMURead(uint8_t tmu)
 void TMUs::checkTMUWriteCycle() const
 {
 	//Broadcom specification, page 37
-	if(lastTMUNoSwap + 3 > qpu.getCurrentCycle())
-		logging::warn() << "Writing to TMU within 3 cycles of last TMU no-swap change" << logging::endl;
+	if(lastTMUNoSwap + periphery::timing::TMU_NOSWAP_DELAY > qpu.getCurrentCycle())
+		logging::warn() << "Writing to TMU within " << periphery::timing::TMU_NOSWAP_DELAY << " cycles of last TMU no-swap change" << logging::endl;
 }
 
 Value TMUs::readMemoryAddress(const Value& address) const
@@ -486,7 +713,8 @@ Value TMUs::readMemoryAddress(const Value& address) const
 		else
 			res.container.elements.push_back(memory.readWord(element.getLiteralValue()->toImmediate()));
 	}
-	logging::debug() << "Reading via TMU from memory address " << address.to_string(false, true) << ": " << res.to_string(false, true) << logging::endl;
+	if(isLogged(logging::Level::DEBUG))
+		logging::debug() << "Reading via TMU from memory address " << address.to_string(false, true) << ": " << res.to_string(false, true) << logging::endl;
 	return res;
 }
 
@@ -498,8 +726,8 @@ uint8_t TMUs::toRealTMU(uint8_t tmu) const
 
 Value SFU::readSFU()
 {
-	if(lastSFUWrite + 2 > currentCycle)
-		logging::warn() << "Reading of SFU result within 2 cycles of triggering SFU calculation" << logging::endl;
+	if(lastSFUWrite + periphery::timing::SFU_RESULT_DELAY > currentCycle)
+		logging::warn() << "Reading of SFU result within " << periphery::timing::SFU_RESULT_DELAY << " cycles of triggering SFU calculation" << logging::endl;
 	if(!sfuResult)
 		throw CompilationError(CompilationStep::GENERAL, "Cannot read empty SFU result!");
 	const Value val = sfuResult.value();
@@ -642,8 +870,11 @@ Value VPM::readValue()
 	setup.genericSetup.setNumber(static_cast<uint8_t>((16 + setup.genericSetup.getNumber() - 1) % 16));
 	vpmReadSetup = setup.value;
 
-	logging::debug() << "Read value from VPM: " << result.to_string(false, true) << logging::endl;
-	logging::debug() << "New read setup is now: " << setup.to_string() << logging::endl;
+	if(isLogged(logging::Level::DEBUG))
+	{
+		logging::debug() << "Read value from VPM: " << result.to_string(false, true) << logging::endl;
+		logging::debug() << "New read setup is now: " << setup.to_string() << logging::endl;
+	}
 
 	return result;
 }
@@ -707,8 +938,11 @@ void VPM::writeValue(const Value& val)
 	setup.genericSetup.setAddress(static_cast<uint8_t>(setup.genericSetup.getAddress() + setup.genericSetup.getStride()));
 	vpmWriteSetup = setup.value;
 
-	logging::debug() << "Wrote value into VPM: " << val.to_string(true, true) << logging::endl;
-	logging::debug() << "New write setup is now: " << setup.to_string() << logging::endl;
+	if(isLogged(logging::Level::DEBUG))
+	{
+		logging::debug() << "Wrote value into VPM: " << val.to_string(true, true) << logging::endl;
+		logging::debug() << "New write setup is now: " << setup.to_string() << logging::endl;
+	}
 }
 
 void VPM::setWriteSetup(const Value& val)
@@ -771,13 +1005,13 @@ void VPM::setDMAWriteAddress(const Value& val)
 
 	for(uint32_t i = 0; i < sizes.first; ++i)
 	{
-		memcpy(reinterpret_cast<uint8_t*>(memory.getWordAddress(address)) + address % sizeof(Word), reinterpret_cast<uint8_t*>(&cache.at(vpmBaseAddress.first).at(vpmBaseAddress.second)) + byteOffset, typeSize * sizes.second);
+		memory.writeBytes(address, reinterpret_cast<uint8_t*>(&cache.at(vpmBaseAddress.first).at(vpmBaseAddress.second)) + byteOffset, typeSize * sizes.second);
 		//TODO stride-setup
 		vpmBaseAddress.first += 1;
 		address += typeSize;
 	}
 
-	lastDMAWriteTrigger = currentCycle;
+	dmaWriteFinishedCycle = currentCycle + periphery::timing::getDMAStoreCycles(setup, periphery::VPWSetup::fromLiteral(writeStrideSetup));
 }
 
 void VPM::setDMAReadAddress(const Value& val)
@@ -809,26 +1043,24 @@ void VPM::setDMAReadAddress(const Value& val)
 
 	for(uint32_t i = 0; i < sizes.first; ++i)
 	{
-		memcpy(reinterpret_cast<uint8_t*>(&cache.at(vpmBaseAddress.first).at(vpmBaseAddress.second)) + byteOffset, reinterpret_cast<uint8_t*>(memory.getWordAddress(address)) + address % sizeof(Word), typeSize * sizes.second);
+		memory.readBytes(address, reinterpret_cast<uint8_t*>(&cache.at(vpmBaseAddress.first).at(vpmBaseAddress.second)) + byteOffset, typeSize * sizes.second);
 		//TODO stride-setup
 		vpmBaseAddress.first += static_cast<uint32_t>((vpitch * typeSize) / sizeof(Word));
 		vpmBaseAddress.second += static_cast<uint32_t>((vpitch * typeSize) % sizeof(Word));
 		address += typeSize;
 	}
 
-	lastDMAReadTrigger = currentCycle;
+	dmaReadFinishedCycle = currentCycle + periphery::timing::getDMALoadCycles(setup, periphery::VPRSetup::fromLiteral(readStrideSetup));
 }
 
 bool VPM::waitDMAWrite() const
 {
-	//XXX how many cycles?
-	return lastDMAWriteTrigger + 12 < currentCycle;
+	return dmaWriteFinishedCycle <= currentCycle;
 }
 
 bool VPM::waitDMARead() const
 {
-	//XXX how many cycles?
-	return lastDMAReadTrigger + 12 < currentCycle;
+	return dmaReadFinishedCycle <= currentCycle;
 }
 
 void VPM::incrementCycle()
@@ -836,6 +1068,11 @@ void VPM::incrementCycle()
 	++currentCycle;
 }
 
+void VPM::setCurrentCycle(uint32_t cycle)
+{
+	currentCycle = cycle;
+}
+
 void VPM::dumpContents() const
 {
 	logging::debug() << "VPM contents:" << logging::endl;
@@ -934,76 +1171,196 @@ static Register toRegister(Address addr, bool isfileB)
 	return Register(isfileB ? RegisterFile::PHYSICAL_B : RegisterFile::PHYSICAL_A, addr);
 }
 
-bool QPU::execute(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction)
+static Register toInputRegister(InputMultiplex mux, Address addressA, Address addressB)
 {
-	const qpu_asm::Instruction* inst = (firstInstruction + pc)->get();
-	++instrumentation[inst].numExecutions;
-	logging::info() << "QPU " << static_cast<unsigned>(ID) << " (0x" << std::hex << pc << std::dec << "): " << inst->toASMString() << logging::endl;
-	ProgramCounter nextPC = pc;
-	if(dynamic_cast<const qpu_asm::ALUInstruction*>(inst) != nullptr)
+	switch(mux)
 	{
-		if(executeALU(dynamic_cast<const qpu_asm::ALUInstruction*>(inst)))
-			++nextPC;
-		//otherwise the execution stalled and the PC stays the same
+		case InputMultiplex::ACC0:
+			return REG_ACC0;
+		case InputMultiplex::ACC1:
+			return REG_ACC1;
+		case InputMultiplex::ACC2:
+			return REG_ACC2;
+		case InputMultiplex::ACC3:
+			return REG_ACC3;
+		case InputMultiplex::ACC4:
+			return REG_SFU_OUT;
+		case InputMultiplex::ACC5:
+			return REG_ACC5;
+		case InputMultiplex::REGA:
+			return Register(RegisterFile::PHYSICAL_A, addressA);
+		case InputMultiplex::REGB:
+			return Register(RegisterFile::PHYSICAL_B, addressB);
 	}
-	else if(dynamic_cast<const qpu_asm::BranchInstruction*>(inst) != nullptr)
+	throw CompilationError(CompilationStep::GENERAL, "Unhandled ALU input");
+}
+
+/*
+ * Whether reading the register accesses state shared between all QPUs (UNIFORMs in memory, VPM, mutex)
+ */
+static bool isSharedRead(Register reg)
+{
+	if(reg.file == RegisterFile::ACCUMULATOR)
+		return false;
+	return reg.num == REG_UNIFORM.num || reg.num == REG_VPM_IO.num || reg.num == REG_VPM_IN_WAIT.num || reg.num == REG_MUTEX.num;
+}
+
+/*
+ * Whether writing the register accesses state shared between all QPUs (VPM incl. DMA, mutex)
+ */
+static bool isSharedWrite(Register reg)
+{
+	return reg.num == REG_VPM_IO.num || reg.num == REG_VPM_IN_SETUP.num || reg.num == REG_VPM_IN_ADDR.num || reg.num == REG_MUTEX.num;
+}
+
+struct tools::DecodedInstruction
+{
+	using Handler = ProgramCounter (QPU::*)(const DecodedInstruction& inst);
+
+	//the original instruction, e.g. as key for the instrumentation results
+	const qpu_asm::Instruction* instruction;
+	Handler handler;
+	std::string asmString;
+	Signaling signal;
+	//the conditions are COND_NEVER for ALUs executing no operation
+	ConditionCode addCondition;
+	ConditionCode mulCondition;
+	Register addOut;
+	Register mulOut;
+	bool setAddFlags;
+	bool setMulFlags;
+
+	//ALU instructions, the inputs are in the order: add input A, add input B, mul input A, mul input B
+	OpCode addCode;
+	OpCode mulCode;
+	std::array<Register, 4> inputs;
+	std::bitset<4> immediateInputs;
+	std::bitset<4> unpackedInputs;
+	Unpack unpack;
+	Pack addPack;
+	Pack mulPack;
+	//the small immediate for ALU instructions, the (packed) value loaded for load instructions
+	Optional<SIMDVector> immediate;
+
+	//branch instructions
+	BranchCond branchCondition;
+	int32_t branchOffset;
+	bool isSupportedBranch;
+
+	//semaphore instructions
+	uint8_t semaphore;
+	bool incrementSemaphore;
+	Pack semaphorePack;
+
+	//whether the instruction accesses state shared between all QPUs (mutex, semaphores, VPM, memory via UNIFORMs or TMU)
+	bool accessesSharedState;
+
+	explicit DecodedInstruction(const qpu_asm::Instruction* inst);
+};
+
+DecodedInstruction::DecodedInstruction(const qpu_asm::Instruction* inst) :
+	instruction(inst), handler(nullptr), asmString(inst->toASMString()), signal(inst->getSig()),
+	addCondition(COND_NEVER), mulCondition(COND_NEVER), addOut(toRegister(inst->getAddOut(), inst->getWriteSwap() == WriteSwap::SWAP)),
+	mulOut(toRegister(inst->getMulOut(), inst->getWriteSwap() == WriteSwap::DONT_SWAP)), setAddFlags(false), setMulFlags(false),
+	addCode(OP_NOP), mulCode(OP_NOP), unpack(UNPACK_NOP), addPack(PACK_NOP), mulPack(PACK_NOP), branchCondition(), branchOffset(0),
+	isSupportedBranch(true), semaphore(0), incrementSemaphore(false), semaphorePack(PACK_NOP), accessesSharedState(false)
+{
+	if(const qpu_asm::ALUInstruction* alu = dynamic_cast<const qpu_asm::ALUInstruction*>(inst))
 	{
-		const auto br = dynamic_cast<const qpu_asm::BranchInstruction*>(inst);
-		if(isConditionMet(br->getBranchCondition()))
+		handler = &QPU::executeALU;
+		addCode = OpCode::toOpCode(alu->getAddition(), false);
+		mulCode = OpCode::toOpCode(alu->getMultiplication(), true);
+		addCondition = alu->getAddition() != OP_NOP.opAdd ? alu->getAddCondition() : COND_NEVER;
+		mulCondition = alu->getMultiplication() != OP_NOP.opMul ? alu->getMulCondition() : COND_NEVER;
+		setAddFlags = alu->getSetFlag() == SetFlag::SET_FLAGS && addCondition != COND_NEVER;
+		setMulFlags = alu->getSetFlag() == SetFlag::SET_FLAGS && addCondition == COND_NEVER;
+
+		const std::array<InputMultiplex, 4> muxes = {alu->getAddMultiplexA(), alu->getAddMultiplexB(), alu->getMulMultiplexA(), alu->getMulMultiplexB()};
+		for(std::size_t i = 0; i < muxes.size(); ++i)
 		{
-			++instrumentation[inst].numBranchTaken;
-			int32_t offset = 4 /* Branch starts at PC + 4 */ + static_cast<int32_t>(br->getImmediate() / sizeof(uint64_t)) /* immediate offset is in bytes */;
-			if(br->getAddRegister() == BranchReg::BRANCH_REG || br->getBranchRelative() == BranchRel::BRANCH_ABSOLUTE)
-				throw CompilationError(CompilationStep::GENERAL, "This kind of branch is not yet implemented", br->toASMString());
-			nextPC += offset;
-
-			//see Broadcom specification, page 34
-			registers.writeRegister(toRegister(br->getAddOut(), br->getWriteSwap() == WriteSwap::SWAP), Value(Literal(pc + 4), TYPE_INT32), std::bitset<16>(0xFFFF));
-			registers.writeRegister(toRegister(br->getMulOut(), br->getWriteSwap() == WriteSwap::DONT_SWAP), Value(Literal(pc + 4), TYPE_INT32), std::bitset<16>(0xFFFF));
+			inputs[i] = toInputRegister(muxes[i], alu->getInputA(), alu->getInputB());
+			immediateInputs.set(i, muxes[i] == InputMultiplex::REGB && alu->getSig() == SIGNAL_ALU_IMMEDIATE);
+			unpackedInputs.set(i, muxes[i] == InputMultiplex::REGA);
 		}
+		if(alu->getSig() == SIGNAL_ALU_IMMEDIATE)
+			//vector rotations have no literal value and fail on execution, if used as input
+			immediate = SIMDVector::fromValue(Value(SmallImmediate(alu->getInputB()), (SmallImmediate(alu->getInputB())).getFloatingValue() ? TYPE_FLOAT : TYPE_INT32));
+		unpack = alu->getUnpack();
+		if(alu->getWriteSwap() == WriteSwap::DONT_SWAP)
+			addPack = alu->getPack();
 		else
-			//simply skip to next PC
-			++nextPC;
-	}
-	else if(dynamic_cast<const qpu_asm::LoadInstruction*>(inst) != nullptr)
-	{
-		const auto load = dynamic_cast<const qpu_asm::LoadInstruction*>(inst);
-		Value imm = Value(Literal(load->getImmediateInt()), TYPE_INT32);
-		imm = load->getPack().pack(imm).value();
-		if(load->getSetFlag() == SetFlag::SET_FLAGS)
-			setFlags(imm, load->getAddCondition() != COND_NEVER ? load->getAddCondition() : load->getMulCondition());
-		writeConditional(toRegister(load->getAddOut(), load->getWriteSwap() == WriteSwap::SWAP), imm, load->getAddCondition());
-		writeConditional(toRegister(load->getMulOut(), load->getWriteSwap() == WriteSwap::DONT_SWAP), imm, load->getMulCondition());
-		++nextPC;
-	}
-	else if(dynamic_cast<const qpu_asm::SemaphoreInstruction*>(inst) != nullptr)
-	{
-		const auto semaphore = dynamic_cast<const qpu_asm::SemaphoreInstruction*>(inst);
-		bool dontStall = true;
-		Value result = UNDEFINED_VALUE;
-		if(semaphore->getIncrementSemaphore())
-			std::tie(result, dontStall) = semaphores.increment(static_cast<uint8_t>(semaphore->getSemaphore()));
-		else
-			std::tie(result, dontStall) = semaphores.decrement(static_cast<uint8_t>(semaphore->getSemaphore()));
-		if(dontStall)
-		{
-			result = semaphore->getPack().pack(result).value();
-			if(semaphore->getSetFlag() == SetFlag::SET_FLAGS)
-				setFlags(result, semaphore->getAddCondition() != COND_NEVER ? semaphore->getAddCondition() : semaphore->getMulCondition());
-			writeConditional(toRegister(semaphore->getAddOut(), semaphore->getWriteSwap() == WriteSwap::SWAP), result, semaphore->getAddCondition());
-			writeConditional(toRegister(semaphore->getMulOut(), semaphore->getWriteSwap() == WriteSwap::DONT_SWAP), result, semaphore->getMulCondition());
-			++nextPC;
-		}
-		else
-			++instrumentation[inst].numStalls;
+			mulPack = alu->getPack();
+	}
+	else if(const qpu_asm::BranchInstruction* br = dynamic_cast<const qpu_asm::BranchInstruction*>(inst))
+	{
+		handler = &QPU::executeBranch;
+		branchCondition = br->getBranchCondition();
+		branchOffset = 4 /* Branch starts at PC + 4 */ + static_cast<int32_t>(br->getImmediate() / sizeof(uint64_t)) /* immediate offset is in bytes */;
+		isSupportedBranch = br->getAddRegister() != BranchReg::BRANCH_REG && br->getBranchRelative() != BranchRel::BRANCH_ABSOLUTE;
+	}
+	else if(const qpu_asm::LoadInstruction* load = dynamic_cast<const qpu_asm::LoadInstruction*>(inst))
+	{
+		handler = &QPU::executeLoad;
+		addCondition = load->getAddCondition();
+		mulCondition = load->getMulCondition();
+		setAddFlags = load->getSetFlag() == SetFlag::SET_FLAGS;
+		immediate = SIMDVector::fromValue(load->getPack().pack(Value(Literal(load->getImmediateInt()), TYPE_INT32)).value());
+	}
+	else if(const qpu_asm::SemaphoreInstruction* sema = dynamic_cast<const qpu_asm::SemaphoreInstruction*>(inst))
+	{
+		handler = &QPU::executeSemaphore;
+		addCondition = sema->getAddCondition();
+		mulCondition = sema->getMulCondition();
+		setAddFlags = sema->getSetFlag() == SetFlag::SET_FLAGS;
+		semaphore = static_cast<uint8_t>(sema->getSemaphore());
+		incrementSemaphore = sema->getIncrementSemaphore();
+		semaphorePack = sema->getPack();
 	}
 	else
-		throw CompilationError(CompilationStep::GENERAL, "Invalid assembler instruction", inst->toASMString());
+		throw CompilationError(CompilationStep::GENERAL, "Invalid assembler instruction", asmString);
+
+	//this over-approximates the accesses (e.g. the inputs are checked, even if the ALU executes no operation), which is always safe
+	accessesSharedState = handler == &QPU::executeSemaphore || signal == SIGNAL_LOAD_TMU0 || signal == SIGNAL_LOAD_TMU1 || isSharedWrite(addOut) || isSharedWrite(mulOut);
+	if(handler == &QPU::executeALU)
+	{
+		for(std::size_t i = 0; i < inputs.size(); ++i)
+			accessesSharedState = accessesSharedState || (!immediateInputs.test(i) && isSharedRead(inputs[i]));
+	}
+}
+
+/*
+ * Decodes the instructions of the kernel starting at the given position up to (and including) the instruction ending the program
+ */
+static DecodedProgram decodeProgram(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction)
+{
+	PROFILE_START(DecodeProgram);
+	DecodedProgram program;
+	auto it = firstInstruction;
+	while(true)
+	{
+		program.emplace_back(it->get());
+		if((*it)->getSig() == SIGNAL_END_PROGRAM)
+			break;
+		++it;
+	}
+	PROFILE_END(DecodeProgram);
+	logging::debug() << "Decoded " << program.size() << " instructions for emulation" << logging::endl;
+	return program;
+}
+
+bool QPU::execute(const DecodedProgram& program)
+{
+	const DecodedInstruction& inst = getCurrentInstruction(program);
+	++instrumentation[inst.instruction].numExecutions;
+	if(isLogged(logging::Level::INFO))
+		logging::info() << "QPU " << static_cast<unsigned>(ID) << " (0x" << std::hex << pc << std::dec << "): " << inst.asmString << logging::endl;
+	//if the execution stalls, the handler returns the current PC
+	const ProgramCounter nextPC = (this->*inst.handler)(inst);
 
 	//clear cache for registers already read this instruction
 	registers.clearReadCache();
 
-	if(!executeSignal(inst->getSig()))
+	if(!executeSignal(inst.signal))
 		//end program
 		return false;
 
@@ -1012,159 +1369,269 @@ bool QPU::execute(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iter
 	return true;
 }
 
-const qpu_asm::Instruction* QPU::getCurrentInstruction(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction) const
+ProgramCounter QPU::executeBranch(const DecodedInstruction& inst)
 {
-	return (firstInstruction + pc)->get();
+	if(!isConditionMet(inst.branchCondition))
+		//simply skip to next PC
+		return pc + 1;
+
+	++instrumentation[inst.instruction].numBranchTaken;
+	if(!inst.isSupportedBranch)
+		throw CompilationError(CompilationStep::GENERAL, "This kind of branch is not yet implemented", inst.asmString);
+
+	//see Broadcom specification, page 34
+	registers.writeRegister(inst.addOut, Value(Literal(pc + 4), TYPE_INT32), std::bitset<16>(0xFFFF));
+	registers.writeRegister(inst.mulOut, Value(Literal(pc + 4), TYPE_INT32), std::bitset<16>(0xFFFF));
+	return static_cast<ProgramCounter>(static_cast<int32_t>(pc) + inst.branchOffset);
 }
 
-static std::pair<Value, bool> toInputValue(Registers& registers, InputMultiplex mux, Address addressA, Address addressB, bool regBIsImmediate)
+ProgramCounter QPU::executeLoad(const DecodedInstruction& inst)
 {
-	switch(mux)
+	const SIMDVector& imm = inst.immediate.value();
+	if(inst.setAddFlags)
+		setFlags(imm, inst.addCondition != COND_NEVER ? inst.addCondition : inst.mulCondition);
+	writeConditional(inst.addOut, imm, inst.addCondition);
+	writeConditional(inst.mulOut, imm, inst.mulCondition);
+	return pc + 1;
+}
+
+ProgramCounter QPU::executeSemaphore(const DecodedInstruction& inst)
+{
+	bool dontStall = true;
+	Value result = UNDEFINED_VALUE;
+	if(inst.incrementSemaphore)
+		std::tie(result, dontStall) = semaphores.increment(inst.semaphore);
+	else
+		std::tie(result, dontStall) = semaphores.decrement(inst.semaphore);
+	if(!dontStall)
 	{
-		case InputMultiplex::ACC0:
-			return registers.readRegister(REG_ACC0);
-		case InputMultiplex::ACC1:
-			return registers.readRegister(REG_ACC1);
-		case InputMultiplex::ACC2:
-			return registers.readRegister(REG_ACC2);
-		case InputMultiplex::ACC3:
-			return registers.readRegister(REG_ACC3);
-		case InputMultiplex::ACC4:
-			return registers.readRegister(REG_SFU_OUT);
-		case InputMultiplex::ACC5:
-			return registers.readRegister(REG_ACC5);
-		case InputMultiplex::REGA:
-			return registers.readRegister(Register(RegisterFile::PHYSICAL_A, addressA));
-		case InputMultiplex::REGB:
-			if(regBIsImmediate)
-				return std::make_pair(Value(SmallImmediate(addressB), (SmallImmediate(addressB)).getFloatingValue() ? TYPE_FLOAT : TYPE_INT32), true);
-			else
-				return registers.readRegister(Register(RegisterFile::PHYSICAL_B, addressB));
+		++instrumentation[inst.instruction].numStalls;
+		return pc;
 	}
-	throw CompilationError(CompilationStep::GENERAL, "Unhandled ALU input");
+	const SIMDVector packedResult = SIMDVector::fromValue(inst.semaphorePack.pack(result).value()).value();
+	if(inst.setAddFlags)
+		setFlags(packedResult, inst.addCondition != COND_NEVER ? inst.addCondition : inst.mulCondition);
+	writeConditional(inst.addOut, packedResult, inst.addCondition);
+	writeConditional(inst.mulOut, packedResult, inst.mulCondition);
+	return pc + 1;
+}
+
+const DecodedInstruction& QPU::getCurrentInstruction(const DecodedProgram& program) const
+{
+	if(pc >= program.size())
+		throw CompilationError(CompilationStep::GENERAL, "Program counter is outside of the kernel code", std::to_string(pc));
+	return program[pc];
+}
+
+static std::pair<SIMDVector, bool> readInput(Registers& registers, const DecodedInstruction& inst, std::size_t index)
+{
+	if(!inst.immediateInputs.test(index))
+		return registers.readVector(inst.inputs[index]);
+	if(!inst.immediate)
+		throw CompilationError(CompilationStep::GENERAL, "Vector rotations are not supported by the emulator", inst.asmString);
+	return std::make_pair(inst.immediate.value(), true);
+}
+
+template<typename Func>
+static void calculateIntegers(SIMDVector& result, const SIMDVector& in0, const SIMDVector& in1, const Func& func)
+{
+	//simple loops over the fixed-size arrays, which are vectorized by the compiler
+	for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+		result.elements[i] = func(in0.elements[i], in1.elements[i]);
+}
+
+template<typename Func>
+static void calculateFloats(SIMDVector& result, const SIMDVector& in0, const SIMDVector& in1, const Func& func)
+{
+	std::array<float, NATIVE_VECTOR_SIZE> first, second, output;
+	std::memcpy(first.data(), in0.elements.data(), sizeof(first));
+	std::memcpy(second.data(), in1.elements.data(), sizeof(second));
+	for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+		output[i] = func(first[i], second[i]);
+	std::memcpy(result.elements.data(), output.data(), sizeof(output));
+}
+
+/*
+ * Calculates the operation directly on the native representation of the operands.
+ *
+ * Returns false for operations not (yet) supported natively, which need to be calculated via OpCode#calculate
+ */
+static bool calculateNative(const OpCode& code, const SIMDVector& in0, const SIMDVector& in1, SIMDVector& result)
+{
+	if(code == OP_ADD)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return a + b;});
+	else if(code == OP_SUB)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return a - b;});
+	else if(code == OP_AND)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return a & b;});
+	else if(code == OP_OR)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return a | b;});
+	else if(code == OP_XOR)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return a ^ b;});
+	else if(code == OP_NOT)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return ~a;});
+	else if(code == OP_SHL)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return a << (b & 31);});
+	else if(code == OP_SHR)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return a >> (b & 31);});
+	else if(code == OP_ROR)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return (a >> (b & 31)) | (a << ((32 - (b & 31)) & 31));});
+	else if(code == OP_MIN)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return static_cast<tools::Word>(std::min(static_cast<int32_t>(a), static_cast<int32_t>(b)));});
+	else if(code == OP_MAX)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return static_cast<tools::Word>(std::max(static_cast<int32_t>(a), static_cast<int32_t>(b)));});
+	else if(code == OP_MUL24)
+		calculateIntegers(result, in0, in1, [](tools::Word a, tools::Word b) -> tools::Word { return (a & 0xFFFFFF) * (b & 0xFFFFFF);});
+	else if(code == OP_FADD)
+		calculateFloats(result, in0, in1, [](float a, float b) -> float { return a + b;});
+	else if(code == OP_FSUB)
+		calculateFloats(result, in0, in1, [](float a, float b) -> float { return a - b;});
+	else if(code == OP_FMUL)
+		calculateFloats(result, in0, in1, [](float a, float b) -> float { return a * b;});
+	else if(code == OP_FMIN)
+		calculateFloats(result, in0, in1, [](float a, float b) -> float { return std::min(a, b);});
+	else if(code == OP_FMAX)
+		calculateFloats(result, in0, in1, [](float a, float b) -> float { return std::max(a, b);});
+	else if(code == OP_FMINABS)
+		calculateFloats(result, in0, in1, [](float a, float b) -> float { return std::min(std::fabs(a), std::fabs(b));});
+	else if(code == OP_FMAXABS)
+		calculateFloats(result, in0, in1, [](float a, float b) -> float { return std::max(std::fabs(a), std::fabs(b));});
+	else if(code == OP_FTOI)
+	{
+		std::array<float, NATIVE_VECTOR_SIZE> input;
+		std::memcpy(input.data(), in0.elements.data(), sizeof(input));
+		for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+			result.elements[i] = static_cast<tools::Word>(static_cast<int32_t>(input[i]));
+	}
+	else if(code == OP_ITOF)
+	{
+		std::array<float, NATIVE_VECTOR_SIZE> output;
+		for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
+			output[i] = static_cast<float>(static_cast<int32_t>(in0.elements[i]));
+		std::memcpy(result.elements.data(), output.data(), sizeof(output));
+	}
+	else
+		//the type-dependent (e.g. asr, clz) and the 8-bit vector operations
+		return false;
+
+	//same result types as calculated by OpCode#calculate
+	if(code == OP_FTOI)
+		result.type = TYPE_FLOAT.toVectorType(in0.type.num);
+	else if(code == OP_ITOF)
+		result.type = TYPE_INT32.toVectorType(in0.type.num);
+	else if(code.numOperands > 1 && (in1.type.num > in0.type.num || in1.type.containsType(in0.type)))
+		result.type = in1.type;
+	else
+		result.type = in0.type;
+	result.undefinedElements = in0.undefinedElements;
+	if(code.numOperands > 1)
+		result.undefinedElements |= in1.undefinedElements;
+	return true;
 }
 
-bool QPU::executeALU(const qpu_asm::ALUInstruction* aluInst)
+static SIMDVector calculateOperation(const OpCode& code, SIMDVector in0, SIMDVector in1, bool unpackIn0, bool unpackIn1, bool isMove, Unpack unpack, Pack pack)
 {
-	Value addIn0 = UNDEFINED_VALUE;
-	Value addIn1 = UNDEFINED_VALUE;
-	Value mulIn0 = UNDEFINED_VALUE;
-	Value mulIn1 = UNDEFINED_VALUE;
+	if(unpack != UNPACK_NOP)
+	{
+		if(unpackIn0)
+			in0 = SIMDVector::fromValue(unpack.unpack(in0.toValue()).value()).value();
+		if(unpackIn1)
+			in1 = SIMDVector::fromValue(unpack.unpack(in1.toValue()).value()).value();
+	}
+
+	//"bit-cast" to correct type for displaying and pack-modes
+	if(code.acceptsFloat)
+	{
+		in0.type = TYPE_FLOAT.toVectorType(in0.type.num);
+		in1.type = TYPE_FLOAT.toVectorType(in1.type.num);
+	}
+	else if(!isMove) // move leaves original types
+	{
+		in0.type = in0.type.isFloatingType() ? TYPE_INT32.toVectorType(in0.type.num) : in0.type;
+		in1.type = in1.type.isFloatingType() ? TYPE_INT32.toVectorType(in1.type.num) : in1.type;
+	}
+
+	SIMDVector result;
+	if(!calculateNative(code, in0, in1, result))
+	{
+		const Value firstOperand = in0.toValue();
+		const Value secondOperand = in1.toValue();
+		auto tmp = code.calculate(firstOperand, secondOperand);
+		if(!tmp)
+			logging::error() << "Failed to emulate ALU operation: " << code.name << " with " << firstOperand.to_string(false, true) << " and " << secondOperand.to_string(false, true) << logging::endl;
+		result = SIMDVector::fromValue(tmp.value()).value();
+	}
+	if(pack != PACK_NOP)
+		result = SIMDVector::fromValue(pack.pack(result.toValue()).value()).value();
+	return result;
+}
 
-	const OpCode addCode = OpCode::toOpCode(aluInst->getAddition(), false);
-	const OpCode mulCode = OpCode::toOpCode(aluInst->getMultiplication(), true);
+ProgramCounter QPU::executeALU(const DecodedInstruction& inst)
+{
+	SIMDVector addIn0;
+	SIMDVector addIn1;
+	SIMDVector mulIn0;
+	SIMDVector mulIn1;
 
 	//need to read both input before writing any registers
-	if(aluInst->getAddCondition() != COND_NEVER && aluInst->getAddition() != OP_NOP.opAdd)
+	if(inst.addCondition != COND_NEVER)
 	{
 		bool addIn0NotStall = true;
 		bool addIn1NotStall = true;
-		std::tie(addIn0, addIn0NotStall) = toInputValue(registers, aluInst->getAddMultiplexA(), aluInst->getInputA(), aluInst->getInputB(), aluInst->getSig() == SIGNAL_ALU_IMMEDIATE);
-		if(addCode.numOperands > 1)
-			std::tie(addIn1, addIn1NotStall) = toInputValue(registers, aluInst->getAddMultiplexB(), aluInst->getInputA(), aluInst->getInputB(), aluInst->getSig() == SIGNAL_ALU_IMMEDIATE);
+		std::tie(addIn0, addIn0NotStall) = readInput(registers, inst, 0);
+		if(inst.addCode.numOperands > 1)
+			std::tie(addIn1, addIn1NotStall) = readInput(registers, inst, 1);
 
 		if(!addIn0NotStall || !addIn1NotStall)
 		{
 			//we stall on input, so do not calculate anything
-			++instrumentation[aluInst].numStalls;
-			return false;
+			++instrumentation[inst.instruction].numStalls;
+			return pc;
 		}
 	}
 
-	if(aluInst->getMulCondition() != COND_NEVER && aluInst->getMultiplication() != OP_NOP.opMul)
+	if(inst.mulCondition != COND_NEVER)
 	{
 		bool mulIn0NotStall = true;
 		bool mulIn1NotStall = true;
 
-		std::tie(mulIn0, mulIn0NotStall) = toInputValue(registers, aluInst->getMulMultiplexA(), aluInst->getInputA(), aluInst->getInputB(), aluInst->getSig() == SIGNAL_ALU_IMMEDIATE);
-		if(mulCode.numOperands > 1)
-			std::tie(mulIn1, mulIn1NotStall) = toInputValue(registers, aluInst->getMulMultiplexB(), aluInst->getInputA(), aluInst->getInputB(), aluInst->getSig() == SIGNAL_ALU_IMMEDIATE);
+		std::tie(mulIn0, mulIn0NotStall) = readInput(registers, inst, 2);
+		if(inst.mulCode.numOperands > 1)
+			std::tie(mulIn1, mulIn1NotStall) = readInput(registers, inst, 3);
 
 		if(!mulIn0NotStall || !mulIn1NotStall)
 		{
 			//we stall on input, so do not calculate anything
-			++instrumentation[aluInst].numStalls;
-			return false;
+			++instrumentation[inst.instruction].numStalls;
+			return pc;
 		}
 	}
 
-	if(aluInst->getAddCondition() != COND_NEVER && aluInst->getAddition() != OP_NOP.opAdd)
+	if(inst.addCondition != COND_NEVER)
 	{
-		if(addIn0.hasType(ValueType::CONTAINER) && addIn0.container.isUndefined())
-			addIn0 = UNDEFINED_VALUE;
-		if(addIn1.hasType(ValueType::CONTAINER) && addIn1.container.isUndefined())
-			addIn1 = UNDEFINED_VALUE;
-
-		if(aluInst->getAddMultiplexA() == InputMultiplex::REGA)
-			addIn0 = aluInst->getUnpack().unpack(addIn0).value();
-		if(aluInst->getAddMultiplexB() == InputMultiplex::REGA)
-			addIn1 = aluInst->getUnpack().unpack(addIn1).value();
-
-		//"bit-cast" to correct type for displaying and pack-modes
-		if(addCode.acceptsFloat)
-		{
-			addIn0.type = TYPE_FLOAT.toVectorType(addIn0.type.num);
-			addIn1.type = TYPE_FLOAT.toVectorType(addIn1.type.num);
-		}
-		else if(!(addCode == OP_OR && addIn0 == addIn1)) // move leaves original types
-		{
-			addIn0.type = addIn0.type.isFloatingType() ? TYPE_INT32.toVectorType(addIn0.type.num) : addIn0.type;
-			addIn1.type = addIn1.type.isFloatingType() ? TYPE_INT32.toVectorType(addIn1.type.num) : addIn1.type;
-		}
+		const SIMDVector result = calculateOperation(inst.addCode, addIn0, addIn1, inst.unpackedInputs.test(0), inst.unpackedInputs.test(1),
+				inst.addCode == OP_OR && addIn0 == addIn1, inst.unpack, inst.addPack);
 
-		auto tmp = addCode.calculate(addIn0, addIn1);
-		if(!tmp)
-			logging::error() << "Failed to emulate ALU operation: " << addCode.name << " with " << addIn0.to_string(false, true) << " and " << addIn1.to_string(false, true) << logging::endl;
-		Value result = tmp.value();
-		if(aluInst->getWriteSwap() == WriteSwap::DONT_SWAP)
-			result = aluInst->getPack().pack(result).value();
+		if(inst.setAddFlags)
+			setFlags(result, inst.addCondition);
 
-		if(aluInst->getSetFlag() == SetFlag::SET_FLAGS)
-			setFlags(result, aluInst->getAddCondition());
-
-		writeConditional(toRegister(aluInst->getAddOut(), aluInst->getWriteSwap() == WriteSwap::SWAP), result, aluInst->getAddCondition(), aluInst, nullptr);
+		writeConditional(inst.addOut, result, inst.addCondition, inst.instruction, nullptr);
 	}
-	if(aluInst->getMulCondition() != COND_NEVER && aluInst->getMultiplication() != OP_NOP.opMul)
+	if(inst.mulCondition != COND_NEVER)
 	{
-		if(mulIn0.hasType(ValueType::CONTAINER) && mulIn0.container.isUndefined())
-			mulIn0 = UNDEFINED_VALUE;
-		if(mulIn1.hasType(ValueType::CONTAINER) && mulIn1.container.isUndefined())
-			mulIn1 = UNDEFINED_VALUE;
-
-		if(aluInst->getMulMultiplexA() == InputMultiplex::REGA)
-			mulIn0 = aluInst->getUnpack().unpack(mulIn0).value();
-		if(aluInst->getMulMultiplexB() == InputMultiplex::REGA)
-			mulIn1 = aluInst->getUnpack().unpack(mulIn1).value();
-
-		//"bit-cast" to correct type for displaying and pack-modes
-		if(mulCode.acceptsFloat)
-		{
-			mulIn0.type = TYPE_FLOAT.toVectorType(mulIn0.type.num);
-			mulIn1.type = TYPE_FLOAT.toVectorType(mulIn1.type.num);
-		}
-		else if(!((mulCode == OP_V8MIN || mulCode == OP_V8MAX) && addIn0 == addIn1)) // move leaves original types
-		{
-			mulIn0.type = mulIn0.type.isFloatingType() ? TYPE_INT32.toVectorType(mulIn0.type.num) : mulIn0.type;
-			mulIn1.type = mulIn1.type.isFloatingType() ? TYPE_INT32.toVectorType(mulIn1.type.num) : mulIn1.type;
-		}
+		const SIMDVector result = calculateOperation(inst.mulCode, mulIn0, mulIn1, inst.unpackedInputs.test(2), inst.unpackedInputs.test(3),
+				(inst.mulCode == OP_V8MIN || inst.mulCode == OP_V8MAX) && addIn0 == addIn1, inst.unpack, inst.mulPack);
 
-		auto tmp = mulCode.calculate(mulIn0, mulIn1);
-		if(!tmp)
-			logging::error() << "Failed to emulate ALU operation: " << mulCode.name << " with " << mulIn0.to_string(false, true) << " and " << mulIn1.to_string(false, true) << logging::endl;
-		Value result = tmp.value();
-		if(aluInst->getWriteSwap() == WriteSwap::SWAP)
-			result = aluInst->getPack().pack(result).value();
-
-		if(aluInst->getSetFlag() == SetFlag::SET_FLAGS && (aluInst->getAddCondition() == COND_NEVER || aluInst->getAddition() == OP_NOP.opAdd))
-			setFlags(result, aluInst->getMulCondition());
+		if(inst.setMulFlags)
+			setFlags(result, inst.mulCondition);
 
-		writeConditional(toRegister(aluInst->getMulOut(), aluInst->getWriteSwap() == WriteSwap::DONT_SWAP), result, aluInst->getMulCondition(), nullptr, aluInst);
+		writeConditional(inst.mulOut, result, inst.mulCondition, nullptr, inst.instruction);
 	}
 
-	return true;
+	return pc + 1;
 }
 
-void QPU::writeConditional(Register dest, const Value& in, ConditionCode cond, const qpu_asm::ALUInstruction* addInst, const qpu_asm::ALUInstruction* mulInst)
+void QPU::writeConditional(Register dest, const SIMDVector& in, ConditionCode cond, const qpu_asm::Instruction* addInst, const qpu_asm::Instruction* mulInst)
 {
 	if(cond == COND_ALWAYS)
 	{
@@ -1183,24 +1650,16 @@ void QPU::writeConditional(Register dest, const Value& in, ConditionCode cond, c
 			++instrumentation[mulInst].numMulALUSkipped;
 		return;
 	}
-	Value result(ContainerValue(NATIVE_VECTOR_SIZE), in.type);
 
 	std::bitset<16> elementMask;
-
 	for(uint8_t i = 0; i < NATIVE_VECTOR_SIZE; ++i)
 	{
-		if((!in.hasType(ValueType::CONTAINER) || i < in.container.elements.size()) && flags.at(i).matchesCondition(cond))
-		{
+		if(flags[i].matchesCondition(cond))
 			elementMask.set(i);
-			Value element = in.hasType(ValueType::CONTAINER) ? in.container.elements.at(i) : in;
-			element.type = element.type.toVectorType(1);
-			result.container.elements.push_back(element);
-		}
-		else
-			result.container.elements.push_back(UNDEFINED_VALUE);
 	}
 
-	registers.writeRegister(dest, result, elementMask);
+	//the elements not written are not modified by the register
+	registers.writeRegister(dest, in, elementMask);
 	
 	if(addInst != nullptr)
 	{
@@ -1309,36 +1768,93 @@ static std::string toFlagString(uint8_t flag, char flagChar)
 	return "?";
 }
 
-void QPU::setFlags(const Value& output, ConditionCode cond)
+void QPU::setFlags(const SIMDVector& output, ConditionCode cond)
 {
-	std::vector<std::string> parts;
+	const bool isFloat = output.type.isFloatingType();
+	std::bitset<16> updatedElements;
 	for(uint8_t i = 0; i < flags.size(); ++i)
 	{
-		if(flags.at(i).matchesCondition(cond))
+		if(flags[i].matchesCondition(cond))
 		{
+			updatedElements.set(i);
 			//only update flags for elements we actually write (where we actually calculate a result)
-			const Value& element = output.hasType(ValueType::CONTAINER) ? (i < output.container.elements.size() ? output.container.elements.at(i) : UNDEFINED_VALUE) : output;
-			if(element.getLiteralValue())
+			if(!output.undefinedElements.test(i))
 			{
-				flags.at(i).zero = element.getLiteralValue()->unsignedInt() == 0 ? ElementFlags::FLAG_SET : ElementFlags::FLAG_CLEAR;
-				flags.at(i).negative = (element.type.isFloatingType() ? element.getLiteralValue()->real() < 0.0f : element.getLiteralValue()->signedInt() < 0) ? ElementFlags::FLAG_SET : ElementFlags::FLAG_CLEAR;
+				const Word element = output.elements[i];
+				flags[i].zero = element == 0 ? ElementFlags::FLAG_SET : ElementFlags::FLAG_CLEAR;
+				flags[i].negative = (isFloat ? bit_cast<Word, float>(element) < 0.0f : static_cast<int32_t>(element) < 0) ? ElementFlags::FLAG_SET : ElementFlags::FLAG_CLEAR;
 				//TODO carry!!
-				flags.at(i).carry = ElementFlags::FLAG_UNDEFINED;
+				flags[i].carry = ElementFlags::FLAG_UNDEFINED;
 			}
 			else
 			{
-				flags.at(i).zero = ElementFlags::FLAG_UNDEFINED;
-				flags.at(i).negative = ElementFlags::FLAG_UNDEFINED;
-				flags.at(i).carry = ElementFlags::FLAG_UNDEFINED;
+				flags[i].zero = ElementFlags::FLAG_UNDEFINED;
+				flags[i].negative = ElementFlags::FLAG_UNDEFINED;
+				flags[i].carry = ElementFlags::FLAG_UNDEFINED;
 			}
-			parts.push_back(toFlagString(flags.at(i).zero, 'z') + toFlagString(flags.at(i).negative, 'n') + toFlagString(flags.at(i).carry, 'c'));
 		}
 	}
-	logging::debug() << "Setting flags: {" + to_string<std::string>(parts) << "}" << logging::endl;
+	if(isLogged(logging::Level::DEBUG))
+	{
+		std::vector<std::string> parts;
+		for(uint8_t i = 0; i < flags.size(); ++i)
+		{
+			if(updatedElements.test(i))
+				parts.push_back(toFlagString(flags[i].zero, 'z') + toFlagString(flags[i].negative, 'n') + toFlagString(flags[i].carry, 'c'));
+		}
+		logging::debug() << "Setting flags: {" + to_string<std::string>(parts) << "}" << logging::endl;
+	}
 
 	//TODO not completely correct, see http://maazl.de/project/vc4asm/doc/instructions.html
 }
 
+static void fillUniforms(std::vector<tools::Word>& qpuUniforms, const std::vector<MemoryAddress>& parameter, const WorkGroupConfig& config, const std::array<tools::Word, 3>& localIDs,
+		const std::array<tools::Word, 3>& groupIDs, tools::Word rerunFlag, MemoryAddress globalData, const KernelUniforms& uniformsUsed)
+{
+	std::size_t i = 0;
+	if(uniformsUsed.getWorkDimensionsUsed())
+		qpuUniforms[i++] = config.dimensions;
+	if(uniformsUsed.getLocalSizesUsed())
+		qpuUniforms[i++] = (config.localSizes.at(2) << 16) | (config.localSizes.at(1) << 8) | config.localSizes.at(0);
+	if(uniformsUsed.getLocalIDsUsed())
+		qpuUniforms[i++] = (localIDs.at(2) << 16) | (localIDs.at(1) << 8) | localIDs.at(0);
+	if(uniformsUsed.getNumGroupsXUsed())
+		qpuUniforms[i++] = config.numGroups.at(0);
+	if(uniformsUsed.getNumGroupsYUsed())
+		qpuUniforms[i++] = config.numGroups.at(1);
+	if(uniformsUsed.getNumGroupsZUsed())
+		qpuUniforms[i++] = config.numGroups.at(2);
+	if(uniformsUsed.getGroupIDXUsed())
+		qpuUniforms[i++] = groupIDs.at(0);
+	if(uniformsUsed.getGroupIDYUsed())
+		qpuUniforms[i++] = groupIDs.at(1);
+	if(uniformsUsed.getGroupIDZUsed())
+		qpuUniforms[i++] = groupIDs.at(2);
+	if(uniformsUsed.getGlobalOffsetXUsed())
+		qpuUniforms[i++] = config.globalOffsets.at(0);
+	if(uniformsUsed.getGlobalOffsetYUsed())
+		qpuUniforms[i++] = config.globalOffsets.at(1);
+	if(uniformsUsed.getGlobalOffsetZUsed())
+		qpuUniforms[i++] = config.globalOffsets.at(2);
+	if(uniformsUsed.getGlobalDataAddressUsed())
+		qpuUniforms[i++] = globalData;
+	for(auto param : parameter)
+	{
+		qpuUniforms[i++] = param;
+	}
+	qpuUniforms[i++] = rerunFlag;
+}
+
+static std::array<tools::Word, 3> toLocalIDs(const WorkGroupConfig& config, tools::Word q)
+{
+	return {q % config.localSizes.at(0), (q / config.localSizes.at(0)) % config.localSizes.at(1), (q / config.localSizes.at(0)) / config.localSizes.at(1)};
+}
+
+static std::array<tools::Word, 3> toGroupIDs(const WorkGroupConfig& config, tools::Word g)
+{
+	return {g % config.numGroups.at(0), (g / config.numGroups.at(0)) % config.numGroups.at(1), (g / config.numGroups.at(0)) / config.numGroups.at(1)};
+}
+
 std::vector<MemoryAddress> tools::buildUniforms(Memory& memory, MemoryAddress baseAddress, const std::vector<MemoryAddress>& parameter, const WorkGroupConfig& config, MemoryAddress globalData, const KernelUniforms& uniformsUsed)
 {
 	std::vector<MemoryAddress> res;
@@ -1347,51 +1863,16 @@ std::vector<MemoryAddress> tools::buildUniforms(Memory& memory, MemoryAddress ba
 	Word numReruns = config.numGroups.at(0) * config.numGroups.at(1) * config.numGroups.at(2);
 	res.reserve(numQPUs);
 
-	std::array<Word, 3> groupIDs = {0, 0, 0};
-
 	std::vector<Word> qpuUniforms;
 	qpuUniforms.resize(uniformsUsed.countUniforms() + 1 /* re-run flag */ + parameter.size());
 
 	for(uint8_t q = 0; q < numQPUs; ++q)
 	{
-		std::array<Word, 3> localIDs = {q % config.localSizes.at(0), (q / config.localSizes.at(0)) % config.localSizes.at(1), (q / config.localSizes.at(0)) / config.localSizes.at(1)};
+		const std::array<Word, 3> localIDs = toLocalIDs(config, q);
 
 		for(uint8_t g = 0; g < numReruns; ++g)
 		{
-			groupIDs = {g % config.numGroups.at(0), (g / config.numGroups.at(0)) % config.numGroups.at(1), (g / config.numGroups.at(0)) / config.numGroups.at(1)};
-
-			std::size_t i = 0;
-			if(uniformsUsed.getWorkDimensionsUsed())
-				qpuUniforms[i++] = config.dimensions;
-			if(uniformsUsed.getLocalSizesUsed())
-				qpuUniforms[i++] = (config.localSizes.at(2) << 16) | (config.localSizes.at(1) << 8) | config.localSizes.at(0);
-			if(uniformsUsed.getLocalIDsUsed())
-				qpuUniforms[i++] = (localIDs.at(2) << 16) | (localIDs.at(1) << 8) | localIDs.at(0);
-			if(uniformsUsed.getNumGroupsXUsed())
-				qpuUniforms[i++] = config.numGroups.at(0);
-			if(uniformsUsed.getNumGroupsYUsed())
-				qpuUniforms[i++] = config.numGroups.at(1);
-			if(uniformsUsed.getNumGroupsZUsed())
-				qpuUniforms[i++] = config.numGroups.at(2);
-			if(uniformsUsed.getGroupIDXUsed())
-				qpuUniforms[i++] = groupIDs.at(0);
-			if(uniformsUsed.getGroupIDYUsed())
-				qpuUniforms[i++] = groupIDs.at(1);
-			if(uniformsUsed.getGroupIDZUsed())
-				qpuUniforms[i++] = groupIDs.at(2);
-			if(uniformsUsed.getGlobalOffsetXUsed())
-				qpuUniforms[i++] = config.globalOffsets.at(0);
-			if(uniformsUsed.getGlobalOffsetYUsed())
-				qpuUniforms[i++] = config.globalOffsets.at(1);
-			if(uniformsUsed.getGlobalOffsetZUsed())
-				qpuUniforms[i++] = config.globalOffsets.at(2);
-			if(uniformsUsed.getGlobalDataAddressUsed())
-				qpuUniforms[i++] = globalData;
-			for(auto param : parameter)
-			{
-				qpuUniforms[i++] = param;
-			}
-			qpuUniforms[i++] = (numReruns - 1) - g;
+			fillUniforms(qpuUniforms, parameter, config, localIDs, toGroupIDs(config, g), (numReruns - 1) - g, globalData, uniformsUsed);
 
 			memory.setUniforms(qpuUniforms, baseAddress);
 			if(g == 0)
@@ -1404,12 +1885,36 @@ std::vector<MemoryAddress> tools::buildUniforms(Memory& memory, MemoryAddress ba
 	return res;
 }
 
-static void emulateStep(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction, ReferenceRetainingList<QPU>& qpus)
+std::vector<MemoryAddress> tools::buildGroupUniforms(Memory& memory, MemoryAddress baseAddress, const std::vector<MemoryAddress>& parameter, const WorkGroupConfig& config, uint32_t groupIndex, MemoryAddress globalData, const KernelUniforms& uniformsUsed)
+{
+	std::vector<MemoryAddress> res;
+
+	Word numQPUs = config.localSizes.at(0) * config.localSizes.at(1) * config.localSizes.at(2);
+	res.reserve(numQPUs);
+
+	std::vector<Word> qpuUniforms;
+	qpuUniforms.resize(uniformsUsed.countUniforms() + 1 /* re-run flag */ + parameter.size());
+
+	for(uint8_t q = 0; q < numQPUs; ++q)
+	{
+		//the kernel is not re-run for the following work-groups
+		fillUniforms(qpuUniforms, parameter, config, toLocalIDs(config, q), toGroupIDs(config, groupIndex), 0, globalData, uniformsUsed);
+
+		memory.setUniforms(qpuUniforms, baseAddress);
+		res.push_back(baseAddress);
+
+		baseAddress += static_cast<Word>(qpuUniforms.size() * sizeof(Word));
+	}
+
+	return res;
+}
+
+static void emulateStep(const DecodedProgram& program, ReferenceRetainingList<QPU>& qpus)
 {
 	auto it = qpus.begin();
 	while(it != qpus.end())
 	{
-		const bool continueRunning = it->execute(firstInstruction);
+		const bool continueRunning = it->execute(program);
 		if(!continueRunning)
 			//this QPU has finished
 			it = qpus.erase(it);
@@ -1418,31 +1923,216 @@ static void emulateStep(std::vector<std::unique_ptr<qpu_asm::Instruction>>::cons
 	}
 }
 
-bool tools::emulate(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction, Memory& memory, const std::vector<MemoryAddress>& uniformAddresses, InstrumentationResults& instrumentation, uint32_t maxCycles)
+#ifdef MULTI_THREADED
+/*
+ * The number of cycles a QPU emulated on its own thread executes before publishing its progress to the other QPUs
+ */
+static constexpr uint32_t PARALLEL_BATCH_CYCLES = 64;
+
+/*
+ * The position of an instruction in the order the sequential emulation executes them, first by cycle, then by QPU ID
+ */
+static uint64_t toExecutionOrder(uint32_t cycle, uint8_t qpu)
+{
+	return (static_cast<uint64_t>(cycle) << 8) | qpu;
+}
+
+/*
+ * Runs every QPU on its own host thread.
+ *
+ * The QPUs execute instructions which only access state local to the QPU (registers, flags, SFU, TMU queues) independently of each other
+ * and publish their progress to the other QPUs only every PARALLEL_BATCH_CYCLES cycles.
+ * An instruction accessing the shared state is only executed once all other QPUs have executed every instruction preceding it in the order of the
+ * sequential emulation (see #toExecutionOrder). Thus, all shared accesses are executed in exactly the same order as for the sequential emulation.
+ */
+class QPUThreads : private NonCopyable
+{
+public:
+	QPUThreads(const DecodedProgram& program, VPM& vpm, uint32_t maxCycles) :
+		program(program), vpm(vpm), maxCycles(maxCycles), failedInstruction(std::numeric_limits<uint64_t>::max())
+	{
+	}
+
+	/*
+	 * Runs all given QPUs until they are finished and returns the number of cycles the last QPU finished after
+	 */
+	uint32_t run(ReferenceRetainingList<QPU>& qpus, std::array<SFU, 12>& sfus)
+	{
+		progress.assign(qpus.size(), 0);
+		executedCycles.assign(qpus.size(), 0);
+		stillRunning.assign(qpus.size(), false);
+		std::vector<std::thread> threads;
+		threads.reserve(qpus.size());
+		for(QPU& qpu : qpus)
+			threads.emplace_back(&QPUThreads::runQPU, this, std::ref(qpu), std::ref(sfus.at(qpu.ID)));
+		for(std::thread& thread : threads)
+			thread.join();
+		if(error)
+			std::rethrow_exception(error);
+
+		for(const QPU& qpu : qpus)
+		{
+			if(stillRunning[qpu.ID] != 0)
+				logging::error() << "After the maximum number of execution cycles, QPU " << static_cast<unsigned>(qpu.ID) << " is still running: " << qpu.getCurrentInstruction(program).asmString << logging::endl;
+		}
+		return *std::max_element(executedCycles.begin(), executedCycles.end());
+	}
+
+private:
+	const DecodedProgram& program;
+	VPM& vpm;
+	const uint32_t maxCycles;
+
+	std::mutex lock;
+	std::condition_variable progressChanged;
+	//the position (see #toExecutionOrder) of the next instruction executed by the QPU, all previous instructions are executed
+	std::vector<uint64_t> progress;
+	//the position of the first instruction (in the sequential order) which threw an error
+	uint64_t failedInstruction;
+	std::exception_ptr error;
+	//only modified by the thread running the QPU, not std::vector<bool> to allow concurrent modification of different elements
+	std::vector<uint32_t> executedCycles;
+	std::vector<uint8_t> stillRunning;
+
+	/*
+	 * Publishes the progress of the QPU and returns whether to continue the execution
+	 */
+	bool publishProgress(uint8_t qpu, uint64_t position)
+	{
+		bool continueRunning;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			progress[qpu] = position;
+			//the instructions after the first error are not executed by the sequential emulation
+			continueRunning = position < failedInstruction;
+		}
+		progressChanged.notify_all();
+		return continueRunning;
+	}
+
+	/*
+	 * Waits until all QPUs executed every instruction preceding the instruction at the given position and returns whether to execute it
+	 */
+	bool waitForTurn(uint8_t qpu, uint64_t position)
+	{
+		if(!publishProgress(qpu, position))
+			return false;
+		std::unique_lock<std::mutex> guard(lock);
+		progressChanged.wait(guard, [this, position]() -> bool
+		{
+			return position > failedInstruction || std::all_of(progress.begin(), progress.end(), [position](uint64_t other) -> bool { return other >= position;});
+		});
+		return position < failedInstruction;
+	}
+
+	void runQPU(QPU& qpu, SFU& sfu)
+	{
+		prctl(PR_SET_NAME, ("QPU " + std::to_string(qpu.ID)).data(), 0, 0, 0);
+		uint32_t cycle = 0;
+		uint32_t lastPublishedCycle = 0;
+		bool running = true;
+		try
+		{
+			while(running && cycle < maxCycles)
+			{
+				const bool isSharedAccess = qpu.getCurrentInstruction(program).accessesSharedState;
+				if(isSharedAccess)
+				{
+					if(!waitForTurn(qpu.ID, toExecutionOrder(cycle, qpu.ID)))
+						break;
+					vpm.setCurrentCycle(cycle);
+				}
+				running = qpu.execute(program);
+				sfu.incrementCycle();
+				++cycle;
+				//other QPUs could wait for this shared access to be executed
+				if(isSharedAccess || cycle - lastPublishedCycle >= PARALLEL_BATCH_CYCLES)
+				{
+					if(!publishProgress(qpu.ID, toExecutionOrder(cycle, qpu.ID)))
+						break;
+					lastPublishedCycle = cycle;
+				}
+			}
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if(toExecutionOrder(cycle, qpu.ID) < failedInstruction)
+			{
+				failedInstruction = toExecutionOrder(cycle, qpu.ID);
+				error = std::current_exception();
+			}
+		}
+		executedCycles[qpu.ID] = cycle;
+		stillRunning[qpu.ID] = running;
+		//a finished QPU does not delay any other QPU
+		publishProgress(qpu.ID, std::numeric_limits<uint64_t>::max());
+	}
+};
+#endif
+
+static void addInstrumentation(InstrumentationResult& res, const InstrumentationResult& other)
+{
+	res.numAddALUExecuted += other.numAddALUExecuted;
+	res.numAddALUSkipped += other.numAddALUSkipped;
+	res.numMulALUExecuted += other.numMulALUExecuted;
+	res.numMulALUSkipped += other.numMulALUSkipped;
+	res.numBranchTaken += other.numBranchTaken;
+	res.numStalls += other.numStalls;
+	res.numExecutions += other.numExecutions;
+}
+
+static void mergeInstrumentation(InstrumentationResults& results, const InstrumentationResults& qpuResults)
+{
+	for(const auto& pair : qpuResults)
+		addInstrumentation(results[pair.first], pair.second);
+}
+
+static bool emulateProgram(const DecodedProgram& program, Memory& memory, const std::vector<MemoryAddress>& uniformAddresses, InstrumentationResults& instrumentation, uint32_t maxCycles, bool parallelQPUs)
 {
 	if(uniformAddresses.size() > 12)
 		throw CompilationError(CompilationStep::GENERAL, "Cannot use more than 12 QPUs!");
+#ifndef MULTI_THREADED
+	if(parallelQPUs)
+		logging::warn() << "Parallel emulation of QPUs requires multi-threading support, falling back to sequential emulation" << logging::endl;
+	parallelQPUs = false;
+#endif
 
 	Mutex mutex;
 	//FIXME is SFU execution per QPU or need SFUs be locked?
 	std::array<SFU, 12> sfus;
 	VPM vpm(memory);
 	Semaphores semaphores;
+	//when running in parallel, every QPU collects its own instrumentation results, which are merged afterwards
+	std::array<InstrumentationResults, 12> qpuInstrumentation;
 
 	ReferenceRetainingList<QPU> qpus;
 	uint8_t numQPU = 0;
 	for(MemoryAddress uniformPointer : uniformAddresses)
 	{
-		qpus.emplace_back(numQPU, mutex, sfus.at(numQPU), vpm, semaphores, memory, uniformPointer, instrumentation);
+		qpus.emplace_back(numQPU, mutex, sfus.at(numQPU), vpm, semaphores, memory, uniformPointer, parallelQPUs ? qpuInstrumentation.at(numQPU) : instrumentation);
 		++numQPU;
 	}
 
 	uint32_t cycle = 0;
 	bool success = true;
+#ifdef MULTI_THREADED
+	if(parallelQPUs)
+	{
+		QPUThreads threads(program, vpm, maxCycles);
+		cycle = threads.run(qpus, sfus);
+		//same as for the sequential emulation, reaching the maximum number of cycles is a time-out, even if all QPUs finished in the last cycle
+		success = cycle < maxCycles;
+		for(const InstrumentationResults& results : qpuInstrumentation)
+			mergeInstrumentation(instrumentation, results);
+		qpus.clear();
+	}
+#endif
 	while(!qpus.empty())
 	{
-		logging::debug() << "Emulating cycle: " << cycle << logging::endl;
-		emulateStep(firstInstruction, qpus);
+		if(isLogged(logging::Level::DEBUG))
+			logging::debug() << "Emulating cycle: " << cycle << logging::endl;
+		emulateStep(program, qpus);
 		for(SFU& sfu : sfus)
 			sfu.incrementCycle();
 		vpm.incrementCycle();
@@ -1453,7 +2143,7 @@ bool tools::emulate(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_it
 		{
 			logging::error() << "After the maximum number of execution cycles, following QPUs are still running: " << logging::endl;
 			for(const QPU& qpu : qpus)
-				logging::error() << "QPU " << static_cast<unsigned>(qpu.ID) << ": " << qpu.getCurrentInstruction(firstInstruction)->toASMString() << logging::endl;
+				logging::error() << "QPU " << static_cast<unsigned>(qpu.ID) << ": " << qpu.getCurrentInstruction(program).asmString << logging::endl;
 			success = false;
 			break;
 		}
@@ -1465,6 +2155,11 @@ bool tools::emulate(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_it
 	return success;
 }
 
+bool tools::emulate(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction, Memory& memory, const std::vector<MemoryAddress>& uniformAddresses, InstrumentationResults& instrumentation, uint32_t maxCycles, bool parallelQPUs)
+{
+	return emulateProgram(decodeProgram(firstInstruction), memory, uniformAddresses, instrumentation, maxCycles, parallelQPUs);
+}
+
 bool tools::emulateTask(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction, const std::vector<MemoryAddress>& parameter, Memory& memory, MemoryAddress uniformBaseAddress, MemoryAddress globalData, const KernelUniforms& uniformsUsed, InstrumentationResults& instrumentation, uint32_t maxCycles)
 {
 	WorkGroupConfig config;
@@ -1502,11 +2197,10 @@ static Memory fillMemory(const ReferenceRetainingList<Global>& globalData, const
 
 	for(const auto& pair : settings.parameter)
 	{
-		tools::Word* addr = mem.getWordAddress(currentAddress);
 		if(pair.second)
 		{
 			parameterAddressesOut.push_back(currentAddress);
-			std::copy_n(pair.second->data(), pair.second->size(), addr);
+			mem.writeBytes(currentAddress, pair.second->data(), pair.second->size() * sizeof(uint32_t));
 			currentAddress += static_cast<MemoryAddress>(pair.second->size() * sizeof(uint32_t));
 		}
 		else
@@ -1583,23 +2277,23 @@ std::string InstrumentationResult::to_string() const
 	return vc4c::to_string<std::string>(parts);
 }
 
-EmulationResult tools::emulate(const EmulationData& data)
+static void loadModule(const std::pair<std::string, std::istream*>& moduleData, qpu_asm::ModuleInfo& module, ReferenceRetainingList<Global>& globals, std::vector<std::unique_ptr<qpu_asm::Instruction>>& instructions)
 {
-	qpu_asm::ModuleInfo module;
-	ReferenceRetainingList<Global> globals;
-	std::vector<std::unique_ptr<qpu_asm::Instruction>> instructions;
-	if(data.module.second != nullptr)
-		extractBinary(*data.module.second, module, globals, instructions);
+	if(moduleData.second != nullptr)
+		extractBinary(*moduleData.second, module, globals, instructions);
 	else
 	{
-		std::ifstream f(data.module.first, std::ios_base::in|std::ios_base::binary);
+		std::ifstream f(moduleData.first, std::ios_base::in|std::ios_base::binary);
 		extractBinary(f, module, globals, instructions);
 	}
 	if(instructions.empty())
 		throw CompilationError(CompilationStep::GENERAL, "Extracted module has no instructions!");
 	if(module.kernelInfos.empty())
 		throw CompilationError(CompilationStep::GENERAL, "Extracted module has no kernels!");
+}
 
+static const qpu_asm::KernelInfo& findKernel(const qpu_asm::ModuleInfo& module, const EmulationData& data)
+{
 	auto kernelInfo = std::find_if(module.kernelInfos.begin(), module.kernelInfos.end(), [&data](const qpu_asm::KernelInfo& info) -> bool { return info.name == data.kernelName; });
 	if(data.kernelName.empty() && module.kernelInfos.size() == 1)
 		kernelInfo = module.kernelInfos.begin();
@@ -1607,23 +2301,17 @@ EmulationResult tools::emulate(const EmulationData& data)
 		throw CompilationError(CompilationStep::GENERAL, "Failed to find kernel-info for kernel", data.kernelName);
 	if(data.parameter.size() != kernelInfo->getParamCount())
 		throw CompilationError(CompilationStep::GENERAL, "The number of parameters specified does not match the number of kernel arguments", std::to_string(static_cast<unsigned>(kernelInfo->getParamCount())));
+	return *kernelInfo;
+}
 
-	MemoryAddress uniformAddress;
-	MemoryAddress globalDataAddress;
-	std::vector<MemoryAddress> paramAddresses;
-	Memory mem(fillMemory(globals, data, uniformAddress, globalDataAddress, paramAddresses));
-
-	auto uniformAddresses = buildUniforms(mem, uniformAddress, paramAddresses, data.workGroup, globalDataAddress, kernelInfo->uniformsUsed);
-
-	if(!data.memoryDump.empty())
-		dumpMemory(mem, data.memoryDump, uniformAddress, true);
-
-	InstrumentationResults instrumentation;
-	bool status = emulate(instructions.begin() + (kernelInfo->getOffset() - module.kernelInfos.front().getOffset()).getValue(), mem, uniformAddresses, instrumentation, data.maxEmulationCycles);
-
-	if(!data.memoryDump.empty())
-		dumpMemory(mem, data.memoryDump, uniformAddress, false);
+static std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator getFirstInstruction(const std::vector<std::unique_ptr<qpu_asm::Instruction>>& instructions, const qpu_asm::ModuleInfo& module, const qpu_asm::KernelInfo& kernelInfo)
+{
+	return instructions.begin() + (kernelInfo.getOffset() - module.kernelInfos.front().getOffset()).getValue();
+}
 
+static EmulationResult toEmulationResult(const EmulationData& data, bool status, const Memory& mem, const std::vector<MemoryAddress>& paramAddresses, InstrumentationResults& instrumentation,
+		std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction, const qpu_asm::KernelInfo& kernelInfo)
+{
 	EmulationResult result{data};
 	result.executionSuccessful = status;
 
@@ -1634,8 +2322,8 @@ EmulationResult tools::emulate(const EmulationData& data)
 			result.results.push_back(std::make_pair(data.parameter[i].first, Optional<std::vector<uint32_t>>{}));
 		else
 		{
-			result.results.push_back(std::make_pair(paramAddresses[i], std::vector<uint32_t>{}));
-			std::copy_n(mem.getWordAddress(paramAddresses[i]), data.parameter[i].second->size(), std::back_inserter(*result.results[i].second));
+			result.results.push_back(std::make_pair(paramAddresses[i], std::vector<uint32_t>(data.parameter[i].second->size())));
+			mem.readBytes(paramAddresses[i], result.results[i].second->data(), result.results[i].second->size() * sizeof(uint32_t));
 		}
 	}
 	
@@ -1643,8 +2331,8 @@ EmulationResult tools::emulate(const EmulationData& data)
 	std::unique_ptr<std::ofstream> dumpInstrumentation;
 	if(!data.instrumentationDump.empty())
 		dumpInstrumentation.reset(new std::ofstream(data.instrumentationDump));
-	auto it = instructions.begin() + (kernelInfo->getOffset() - module.kernelInfos.front().getOffset()).getValue();
-	result.instrumentation.reserve(kernelInfo->getLength().getValue());
+	auto it = firstInstruction;
+	result.instrumentation.reserve(kernelInfo.getLength().getValue());
 	while(true)
 	{
 		result.instrumentation.emplace_back(instrumentation[it->get()]);
@@ -1657,3 +2345,148 @@ EmulationResult tools::emulate(const EmulationData& data)
 
 	return result;
 }
+
+EmulationResult tools::emulate(const EmulationData& data)
+{
+	qpu_asm::ModuleInfo module;
+	ReferenceRetainingList<Global> globals;
+	std::vector<std::unique_ptr<qpu_asm::Instruction>> instructions;
+	loadModule(data.module, module, globals, instructions);
+
+	const qpu_asm::KernelInfo& kernelInfo = findKernel(module, data);
+
+	MemoryAddress uniformAddress;
+	MemoryAddress globalDataAddress;
+	std::vector<MemoryAddress> paramAddresses;
+	Memory mem(fillMemory(globals, data, uniformAddress, globalDataAddress, paramAddresses));
+
+	auto uniformAddresses = buildUniforms(mem, uniformAddress, paramAddresses, data.workGroup, globalDataAddress, kernelInfo.uniformsUsed);
+
+	if(!data.memoryDump.empty())
+		dumpMemory(mem, data.memoryDump, uniformAddress, true);
+
+	InstrumentationResults instrumentation;
+	bool status = emulate(getFirstInstruction(instructions, module, kernelInfo), mem, uniformAddresses, instrumentation, data.maxEmulationCycles, data.parallelQPUs);
+
+	if(!data.memoryDump.empty())
+		dumpMemory(mem, data.memoryDump, uniformAddress, false);
+
+	return toEmulationResult(data, status, mem, paramAddresses, instrumentation, getFirstInstruction(instructions, module, kernelInfo), kernelInfo);
+}
+
+BatchEmulationResult tools::emulate(const BatchEmulationData& data)
+{
+	qpu_asm::ModuleInfo module;
+	ReferenceRetainingList<Global> globals;
+	std::vector<std::unique_ptr<qpu_asm::Instruction>> instructions;
+	loadModule(data.module, module, globals, instructions);
+
+	//the initial state of a single run
+	struct Run
+	{
+		const qpu_asm::KernelInfo& kernelInfo;
+		const DecodedProgram& program;
+		Memory memory;
+		MemoryAddress uniformAddress;
+		std::vector<MemoryAddress> paramAddresses;
+	};
+	//a single emulation executed in parallel, either a whole run or a single work-group of a run
+	struct Job
+	{
+		std::size_t run;
+		Memory memory;
+		std::vector<MemoryAddress> uniformAddresses;
+		InstrumentationResults instrumentation;
+		bool status;
+	};
+
+	//the kernels are only decoded once for all their runs
+	std::map<std::string, DecodedProgram> programs;
+	std::vector<Run> runs;
+	std::vector<Job> jobs;
+	runs.reserve(data.runs.size());
+	for(std::size_t i = 0; i < data.runs.size(); ++i)
+	{
+		const EmulationData& runData = data.runs[i];
+		const qpu_asm::KernelInfo& kernelInfo = findKernel(module, runData);
+		auto programIt = programs.find(kernelInfo.name);
+		if(programIt == programs.end())
+			programIt = programs.emplace(kernelInfo.name, decodeProgram(getFirstInstruction(instructions, module, kernelInfo))).first;
+
+		MemoryAddress uniformAddress;
+		MemoryAddress globalDataAddress;
+		std::vector<MemoryAddress> paramAddresses;
+		Memory mem(fillMemory(globals, runData, uniformAddress, globalDataAddress, paramAddresses));
+
+		//all UNIFORMs are written before taking the snapshots, so a job only copies the memory if the kernel actually writes into it
+		std::vector<std::vector<MemoryAddress>> jobUniforms;
+		if(data.splitWorkGroups)
+		{
+			const uint32_t numGroups = runData.workGroup.numGroups.at(0) * runData.workGroup.numGroups.at(1) * runData.workGroup.numGroups.at(2);
+			const MemoryAddress uniformsSize = static_cast<MemoryAddress>((kernelInfo.uniformsUsed.countUniforms() + 1 /* re-run flag */ + paramAddresses.size()) * sizeof(Word));
+			MemoryAddress groupUniformAddress = uniformAddress;
+			for(uint32_t g = 0; g < numGroups; ++g)
+			{
+				jobUniforms.push_back(buildGroupUniforms(mem, groupUniformAddress, paramAddresses, runData.workGroup, g, globalDataAddress, kernelInfo.uniformsUsed));
+				groupUniformAddress += static_cast<MemoryAddress>(jobUniforms.back().size()) * uniformsSize;
+			}
+		}
+		else
+			jobUniforms.push_back(buildUniforms(mem, uniformAddress, paramAddresses, runData.workGroup, globalDataAddress, kernelInfo.uniformsUsed));
+
+		if(!runData.memoryDump.empty())
+			dumpMemory(mem, runData.memoryDump, uniformAddress, true);
+
+		for(auto& uniforms : jobUniforms)
+			jobs.push_back(Job{i, mem.snapshot(), std::move(uniforms), InstrumentationResults{}, false});
+		runs.push_back(Run{kernelInfo, programIt->second, std::move(mem), uniformAddress, std::move(paramAddresses)});
+	}
+
+	std::vector<std::function<void()>> tasks;
+	tasks.reserve(jobs.size());
+	for(Job& job : jobs)
+	{
+		tasks.emplace_back([&job, &runs, &data]() -> void
+		{
+			const EmulationData& runData = data.runs[job.run];
+			job.status = emulateProgram(runs[job.run].program, job.memory, job.uniformAddresses, job.instrumentation, runData.maxEmulationCycles, runData.parallelQPUs);
+		});
+	}
+	threading::BackgroundWorker::scheduleAll(tasks, "Emulator", data.maxThreads);
+
+	BatchEmulationResult result;
+	result.results.reserve(runs.size());
+	auto jobIt = jobs.begin();
+	for(std::size_t i = 0; i < runs.size(); ++i)
+	{
+		const Run& run = runs[i];
+		Memory mem = run.memory.snapshot();
+		InstrumentationResults instrumentation;
+		bool status = true;
+		//the work-groups are merged in the order of their group IDs
+		for(; jobIt != jobs.end() && jobIt->run == i; ++jobIt)
+		{
+			mem.mergeChanges(jobIt->memory, run.memory);
+			mergeInstrumentation(instrumentation, jobIt->instrumentation);
+			status = status && jobIt->status;
+		}
+
+		if(!data.runs[i].memoryDump.empty())
+			dumpMemory(mem, data.runs[i].memoryDump, run.uniformAddress, false);
+
+		result.results.push_back(toEmulationResult(data.runs[i], status, mem, run.paramAddresses, instrumentation, getFirstInstruction(instructions, module, run.kernelInfo), run.kernelInfo));
+
+		std::vector<InstrumentationResult>& aggregated = result.instrumentation[run.kernelInfo.name];
+		const std::vector<InstrumentationResult>& runInstrumentation = result.results.back().instrumentation;
+		if(aggregated.empty())
+			aggregated = runInstrumentation;
+		else
+		{
+			for(std::size_t k = 0; k < aggregated.size(); ++k)
+				addInstrumentation(aggregated[k], runInstrumentation[k]);
+		}
+	}
+
+	logging::info() << "Emulated " << runs.size() << " runs in " << jobs.size() << " parallel jobs" << logging::endl;
+	return result;
+}
@@ -13,8 +13,10 @@
 #include "config.h"
 #include "tools.h"
 
+#include <array>
 #include <bitset>
 #include <limits>
+#include <memory>
 
 namespace vc4c
 {
@@ -23,7 +25,6 @@ namespace vc4c
 	namespace qpu_asm
 	{
 		class Instruction;
-		class ALUInstruction;
 	}
 
 	namespace tools
@@ -32,16 +33,28 @@ namespace vc4c
 
 		using MemoryAddress = uint32_t;
 		using Word = uint32_t;
+		/*
+		 * The memory accessible by the emulated QPUs.
+		 *
+		 * The memory is split into pages. Snapshots share the pages with the memory they are taken from,
+		 * until either of them writes into a page, which then copies only this single page (copy-on-write).
+		 */
 		class Memory : private NonCopyable
 		{
 		public:
+			static constexpr std::size_t WORDS_PER_PAGE = 1024;
 
-			explicit Memory(std::size_t size) : data(size)
-			{
-				data.resize(size, 0);
-			}
+			explicit Memory(std::size_t size);
 
+			/*
+			 * Returns the address of the single word at the given memory address.
+			 *
+			 * NOTE: The following words are not necessarily stored contiguously, use readBytes() and writeBytes() to access ranges of memory
+			 */
 			Word* getWordAddress(MemoryAddress address);
+			const Word* getWordAddress(MemoryAddress address) const;
+			void readBytes(MemoryAddress address, void* destination, std::size_t numBytes) const;
+			void writeBytes(MemoryAddress address, const void* source, std::size_t numBytes);
 
 			Value readWord(MemoryAddress address) const;
 			MemoryAddress incrementAddress(MemoryAddress address, const DataType& typeSize) const;
@@ -49,8 +62,20 @@ namespace vc4c
 			MemoryAddress getMaximumAddress() const;
 			void setUniforms(const std::vector<Word>& uniforms, MemoryAddress address);
 
+			Memory snapshot() const;
+			/*
+			 * Applies all words the snapshot modified since it was taken from the base memory to this memory
+			 */
+			void mergeChanges(const Memory& snapshot, const Memory& base);
+
 		private:
-			std::vector<Word> data;
+			using Page = std::array<Word, WORDS_PER_PAGE>;
+			std::vector<std::shared_ptr<Page>> pages;
+			std::size_t numWords;
+
+			explicit Memory(const std::vector<std::shared_ptr<Page>>& pages, std::size_t numWords) : pages(pages), numWords(numWords) { }
+
+			Page& getWritablePage(std::size_t pageIndex);
 		};
 
 		class Mutex : private NonCopyable
@@ -68,6 +93,33 @@ namespace vc4c
 			uint8_t lockOwner;
 		};
 
+		/*
+		 * Native representation of the content of a SIMD register, storing the 32-bit word of every element.
+		 *
+		 * This is used for the storage registers and the ALU operations on the hot path of the emulation,
+		 * so an executed instruction does not need to create and process a Value object per element.
+		 */
+		struct SIMDVector
+		{
+			std::array<Word, NATIVE_VECTOR_SIZE> elements;
+			//the elements without a defined value (e.g. never written)
+			std::bitset<NATIVE_VECTOR_SIZE> undefinedElements;
+			//the type the elements are interpreted as, e.g. for floating-point flags and the conversion into a Value
+			DataType type;
+
+			explicit SIMDVector(const DataType& type = TYPE_UNKNOWN);
+
+			bool operator==(const SIMDVector& other) const;
+
+			Value toValue() const;
+			std::string to_string(std::bitset<NATIVE_VECTOR_SIZE> elementMask = 0xFFFF) const;
+
+			/*
+			 * Converts the given literal, undefined or container value into its native representation
+			 */
+			static Optional<SIMDVector> fromValue(const Value& val);
+		};
+
 		class Registers : private NonCopyable
 		{
 		public:
@@ -75,7 +127,9 @@ namespace vc4c
 			explicit Registers(QPU& qpu) : qpu(qpu), hostInterrupt(NO_VALUE) { }
 
 			void writeRegister(Register reg, const Value& val, std::bitset<16> elementMask);
+			void writeRegister(Register reg, const SIMDVector& val, std::bitset<16> elementMask);
 			std::pair<Value, bool> readRegister(Register reg);
+			std::pair<SIMDVector, bool> readVector(Register reg);
 
 			Value getInterruptValue() const;
 
@@ -83,14 +137,16 @@ namespace vc4c
 
 		private:
 			QPU& qpu;
-			FastMap<Register, Value> storageRegisters;
+			//the physical register-files A and B followed by the accumulators r0 to r5
+			std::array<SIMDVector, 32 + 32 + 6> storageRegisters;
+			std::bitset<32 + 32 + 6> definedRegisters;
 			Optional<Value> hostInterrupt;
 			OrderedMap<Register, Value> readCache;
 
 			Value getActualValue(const Value& val);
 
-			Value readStorageRegister(Register reg);
-			void writeStorageRegister(Register reg, const Value& val, std::bitset<16> elementMask);
+			const SIMDVector& readStorageRegister(Register reg);
+			void writeStorageRegister(Register reg, const SIMDVector& val, std::bitset<16> elementMask);
 			void setReadCache(Register reg, const Value& val);
 		};
 
@@ -167,7 +223,7 @@ namespace vc4c
 		{
 		public:
 
-			VPM(Memory& memory) : memory(memory), vpmReadSetup(0), vpmWriteSetup(0), dmaReadSetup(0), dmaWriteSetup(0), readStrideSetup(0), writeStrideSetup(0), lastDMAReadTrigger(0), lastDMAWriteTrigger(0), currentCycle(0) { }
+			VPM(Memory& memory) : memory(memory), vpmReadSetup(0), vpmWriteSetup(0), dmaReadSetup(0), dmaWriteSetup(0), readStrideSetup(0), writeStrideSetup(0), dmaReadFinishedCycle(0), dmaWriteFinishedCycle(0), currentCycle(0) { }
 
 			Value readValue();
 			void writeValue(const Value& val);
@@ -182,6 +238,10 @@ namespace vc4c
 			bool waitDMARead() const;
 
 			void incrementCycle();
+			/*
+			 * Sets the cycle of the QPU accessing the VPM, for QPUs not emulated in lock-step
+			 */
+			void setCurrentCycle(uint32_t cycle);
 
 			void dumpContents() const;
 		private:
@@ -192,8 +252,9 @@ namespace vc4c
 			uint32_t dmaWriteSetup;
 			uint32_t readStrideSetup;
 			uint32_t writeStrideSetup;
-			uint32_t lastDMAReadTrigger;
-			uint32_t lastDMAWriteTrigger;
+			//the cycles the last DMA load/store is finished, as determined by the timing model
+			uint32_t dmaReadFinishedCycle;
+			uint32_t dmaWriteFinishedCycle;
 			uint32_t currentCycle;
 
 			std::array<std::array<Word, 16>, 64> cache;
@@ -232,6 +293,15 @@ namespace vc4c
 		
 		using InstrumentationResults = std::map<const qpu_asm::Instruction*, InstrumentationResult>;
 
+		/*
+		 * An instruction decoded into the fields required for its execution (e.g. the resolved input registers and the handler executing it).
+		 *
+		 * The kernel code is decoded once before the emulation starts, so the emulation of a cycle does not need to
+		 * determine the type of the instruction or extract and convert the single fields of the machine code again.
+		 */
+		struct DecodedInstruction;
+		using DecodedProgram = std::vector<DecodedInstruction>;
+
 		class QPU : private NonCopyable
 		{
 		public:
@@ -245,9 +315,9 @@ namespace vc4c
 			uint32_t getCurrentCycle() const;
 			std::pair<Value, bool> readR4();
 
-			bool execute(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction);
+			bool execute(const DecodedProgram& program);
 
-			const qpu_asm::Instruction* getCurrentInstruction(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction) const;
+			const DecodedInstruction& getCurrentInstruction(const DecodedProgram& program) const;
 
 		private:
 			Mutex& mutex;
@@ -267,16 +337,24 @@ namespace vc4c
 			friend class TMUs;
 			friend class SFU;
 			friend class VPM;
+			friend struct DecodedInstruction;
 
-			bool executeALU(const qpu_asm::ALUInstruction* aluInst);
-			void writeConditional(Register dest, const Value& in, ConditionCode cond, const qpu_asm::ALUInstruction* addInst = nullptr, const qpu_asm::ALUInstruction* mulInst = nullptr);
+			ProgramCounter executeALU(const DecodedInstruction& inst);
+			ProgramCounter executeBranch(const DecodedInstruction& inst);
+			ProgramCounter executeLoad(const DecodedInstruction& inst);
+			ProgramCounter executeSemaphore(const DecodedInstruction& inst);
+			void writeConditional(Register dest, const SIMDVector& in, ConditionCode cond, const qpu_asm::Instruction* addInst = nullptr, const qpu_asm::Instruction* mulInst = nullptr);
 			bool isConditionMet(BranchCond cond) const;
 			bool executeSignal(Signaling signal);
-			void setFlags(const Value& output, ConditionCode cond);
+			void setFlags(const SIMDVector& output, ConditionCode cond);
 		};
 
 		std::vector<MemoryAddress> buildUniforms(Memory& memory, MemoryAddress baseAddress, const std::vector<MemoryAddress>& parameter, const WorkGroupConfig& config, MemoryAddress globalData, const KernelUniforms& uniformsUsed);
-		bool emulate(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction, Memory& memory, const std::vector<MemoryAddress>& uniformAddresses, InstrumentationResults& instrumentation, uint32_t maxCycles = std::numeric_limits<uint32_t>::max());
+		/*
+		 * Builds the UNIFORMs for executing only the work-group with the given index, without re-running the kernel for the following work-groups
+		 */
+		std::vector<MemoryAddress> buildGroupUniforms(Memory& memory, MemoryAddress baseAddress, const std::vector<MemoryAddress>& parameter, const WorkGroupConfig& config, uint32_t groupIndex, MemoryAddress globalData, const KernelUniforms& uniformsUsed);
+		bool emulate(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction, Memory& memory, const std::vector<MemoryAddress>& uniformAddresses, InstrumentationResults& instrumentation, uint32_t maxCycles = std::numeric_limits<uint32_t>::max(), bool parallelQPUs = false);
 		bool emulateTask(std::vector<std::unique_ptr<qpu_asm::Instruction>>::const_iterator firstInstruction, const std::vector<MemoryAddress>& parameter, Memory& memory, MemoryAddress uniformBaseAddress, MemoryAddress globalData, const KernelUniforms& uniformsUsed, InstrumentationResults& instrumentation, uint32_t maxCycles = std::numeric_limits<uint32_t>::max());
 	}
 }
@@ -0,0 +1,279 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#include "TestBenchmarks.h"
+
+#include "Compiler.h"
+#include "InstructionWalker.h"
+#include "Locals.h"
+#include "Module.h"
+#include "Values.h"
+#include "performance.h"
+#include "intermediate/IntermediateInstruction.h"
+#include "tools.h"
+#include "llvm/Scanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace vc4c;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t NUM_ITERATIONS = 100;
+
+//the large kernels of the regression-test, used to measure the overall compilation time
+static const std::vector<std::pair<std::string, std::string>> largeKernels = {
+		{"./testing/deepCL/BackpropWeightsScratchLarge.cl", "-DgFilterSize=4 -DgFilterSizeSquared=16 -DgOutputSize=16 -DgInputSize=16 -DgMargin=1 -DgInputStripeInnerSize=2 -DgInputStripeOuterSize=3 -DgOutputSizeSquared=16 -DgInputStripeMarginSize=1 -DgNumStripes=16 -DgOutputStripeSize=16 -DgOutputStripeNumRows=4 -DgNumFilters=4 -DgInputPlanes=4 -DgInputSizeSquared=16"},
+		{"./testing/deepCL/forward3.cl", "-DgHalfFilterSize=8 -DgInputSize=16 -DgOutputSize=16 -DgFilterSizeSquared=64 -DgNumFilters=4 -DgOutputSizeSquared=64 -DgInputSizeSquared=64 -DgNumInputPlanes=4 -DgEven=2 -DgFilterSize=16 -DgPadZeros=true -DgInputPlanes=8"},
+		{"./testing/CLTune/gemm.opencl", "-DVWM=16 -DVWN=16 -DMWG=1 -DNWG=1 -DMDIMC=1 -DNDIMC=1 -DKWG=1 -DKWI=1 -Dreal16=float16 -Dreal=float -DZERO=0.0f"},
+		{"./testing/CLTune/multiple_kernels_tiled.opencl", "-DVECTOR=16 -DWPTX=256 -DWPTY=64 -DTBX=2 -DTBY=2 -DUNROLL_FACTOR -Dfloatvec=float16 -DTS=8"},
+		{"./example/fft2_2.cl", ""}
+};
+
+TestBenchmarks::TestBenchmarks()
+{
+	TEST_ADD(TestBenchmarks::benchmarkValueHashing);
+	for(const auto& kernel : largeKernels)
+		TEST_ADD_TWO_ARGUMENTS(TestBenchmarks::benchmarkCompilation, kernel.first, kernel.second);
+	TEST_ADD(TestBenchmarks::benchmarkEmulation);
+	for(const auto& kernel : largeKernels)
+		TEST_ADD_TWO_ARGUMENTS(TestBenchmarks::benchmarkRegisterAllocation, kernel.first, kernel.second);
+	TEST_ADD(TestBenchmarks::benchmarkScanner);
+	TEST_ADD(TestBenchmarks::benchmarkBasicBlocks);
+}
+
+TestBenchmarks::~TestBenchmarks()
+{
+	//out-of-line virtual destructor
+}
+
+//the previous implementation of hash<Value>, for comparison
+struct StringValueHash
+{
+	std::size_t operator()(const Value& val) const noexcept
+	{
+		return std::hash<std::string>{}(val.to_string());
+	}
+};
+
+template<typename H>
+static Clock::duration runValueLookups(const std::vector<Value>& values)
+{
+	const auto start = Clock::now();
+	FastSet<Value, H> set;
+	std::size_t found = 0;
+	for(std::size_t i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		set.clear();
+		for(const Value& val : values)
+			set.insert(val);
+		for(const Value& val : values)
+			found += set.count(val);
+	}
+	const auto duration = Clock::now() - start;
+	TEST_ASSERT_EQUALS(values.size() * NUM_ITERATIONS, found);
+	return duration;
+}
+
+void TestBenchmarks::benchmarkValueHashing()
+{
+	//mix of values as found in a typical kernel
+	std::vector<std::unique_ptr<Parameter>> locals;
+	std::vector<Value> values;
+	for(uint32_t i = 0; i < 1000; ++i)
+	{
+		locals.emplace_back(new Parameter(std::string("%local.") + std::to_string(i), TYPE_INT32.toVectorType(16)));
+		values.push_back(locals.back()->createReference());
+		values.push_back(Value(Literal(i), TYPE_INT32));
+	}
+	values.push_back(UNIFORM_REGISTER);
+	values.push_back(ELEMENT_NUMBER_REGISTER);
+	values.push_back(Value(REG_ACC0, TYPE_INT32));
+
+	const auto structural = runValueLookups<hash<Value>>(values);
+	const auto string = runValueLookups<StringValueHash>(values);
+	printf("Value hashing for %u values: structural %u us, string-based %u us\n", static_cast<unsigned>(values.size()),
+			static_cast<unsigned>(std::chrono::duration_cast<std::chrono::microseconds>(structural).count()),
+			static_cast<unsigned>(std::chrono::duration_cast<std::chrono::microseconds>(string).count()));
+}
+
+void TestBenchmarks::benchmarkCompilation(std::string clFile, std::string options)
+{
+	std::ifstream in(clFile);
+	std::ostringstream out;
+	const auto start = Clock::now();
+	const std::size_t numBytes = Compiler::compile(in, out, Configuration{}, options, clFile);
+	const auto duration = Clock::now() - start;
+	TEST_ASSERT(numBytes > 0);
+	printf("Compiling %s: %u ms, %u bytes\n", clFile.data(), static_cast<unsigned>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()),
+			static_cast<unsigned>(numBytes));
+}
+
+void TestBenchmarks::benchmarkEmulation()
+{
+	const std::string fileName("./testing/test_barrier.cl");
+	std::ifstream in(fileName);
+	std::stringstream buffer;
+	Configuration config;
+	config.outputMode = OutputMode::BINARY;
+	config.writeKernelInfo = true;
+	Compiler::compile(in, buffer, config, "", fileName);
+
+	tools::EmulationData data;
+	data.kernelName = "test_barrier";
+	data.module = std::make_pair("", &buffer);
+	data.workGroup.localSizes = {12, 1, 1};
+	data.workGroup.numGroups = {4, 1, 1};
+	data.parameter.emplace_back(0u, std::vector<uint32_t>(12  * data.calcNumWorkItems()));
+
+	const auto start = Clock::now();
+	const auto result = tools::emulate(data);
+	const auto duration = Clock::now() - start;
+	TEST_ASSERT(result.executionSuccessful);
+	std::size_t numExecutions = 0;
+	for(const auto& instrumentation : result.instrumentation)
+		numExecutions += instrumentation.numExecutions;
+	printf("Emulating %u instructions: %u ms\n", static_cast<unsigned>(numExecutions), static_cast<unsigned>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()));
+}
+
+/*
+ * Sums up the numeric field of all entries in the instrumentation report, whose key (e.g. "step" or "counter") has one of the given names
+ */
+static std::size_t sumReportEntries(const std::string& reportFile, const std::string& key, const std::vector<std::string>& names, const std::string& field)
+{
+	std::ifstream report(reportFile);
+	std::size_t sum = 0;
+	std::string line;
+	while(std::getline(report, line))
+	{
+		const bool matches = std::any_of(names.begin(), names.end(), [&](const std::string& name) -> bool
+		{
+			return line.find("\"" + key + "\": \"" + name + "\"") != std::string::npos;
+		});
+		const auto pos = line.find("\"" + field + "\": ");
+		if(matches && pos != std::string::npos)
+			sum += std::stoul(line.substr(pos + field.size() + 4));
+	}
+	return sum;
+}
+
+/*
+ * Compiles the file with the given register-allocator and returns the time spent in the register-allocation and the number of instructions generated
+ */
+static std::pair<Clock::duration, std::size_t> compileWithAllocator(const std::string& clFile, const std::string& options, const RegisterAllocator allocator)
+{
+	static const std::string reportFile("./register_allocation_report.json");
+	std::ifstream in(clFile);
+	std::ostringstream out;
+	Configuration config;
+	config.registerAllocator = allocator;
+	config.instrumentationReport = reportFile;
+	Compiler::compile(in, out, config, options, clFile);
+	//the graph is also created for the linear-scan, which uses its local-uses. If the linear-scan fails, graph coloring is used instead
+	const std::size_t allocationTime = sumReportEntries(reportFile, "step", {"CreateInterferenceGraph", "LinearScan", "ColorGraph"}, "duration_us");
+	const std::size_t numInstructions = sumReportEntries(reportFile, "counter", {"Generated instructions"}, "value");
+	std::remove(reportFile.data());
+	return std::make_pair(std::chrono::microseconds(allocationTime), numInstructions);
+}
+
+void TestBenchmarks::benchmarkRegisterAllocation(std::string clFile, std::string options)
+{
+	const auto coloring = compileWithAllocator(clFile, options, RegisterAllocator::GRAPH_COLORING);
+	const auto linearScan = compileWithAllocator(clFile, options, RegisterAllocator::LINEAR_SCAN);
+	TEST_ASSERT(coloring.second > 0);
+	TEST_ASSERT(linearScan.second > 0);
+	printf("Register allocation for %s: graph coloring %u us, %u instructions, linear-scan %u us, %u instructions\n", clFile.data(),
+			static_cast<unsigned>(std::chrono::duration_cast<std::chrono::microseconds>(coloring.first).count()), static_cast<unsigned>(coloring.second),
+			static_cast<unsigned>(std::chrono::duration_cast<std::chrono::microseconds>(linearScan.first).count()), static_cast<unsigned>(linearScan.second));
+}
+
+static std::pair<Clock::duration, std::size_t> scanAll(const std::string& code, const bool bufferInput)
+{
+	const auto start = Clock::now();
+	std::istringstream in(code);
+	llvm2qasm::Scanner scanner(in, bufferInput);
+	std::size_t numTokens = 0;
+	while(scanner.hasInput())
+	{
+		scanner.pop();
+		++numTokens;
+	}
+	return std::make_pair(Clock::now() - start, numTokens);
+}
+
+void TestBenchmarks::benchmarkScanner()
+{
+	//LLVM IR code similar to the linked kernels, repeated to a few megabytes
+	const std::string block = "define spir_kernel void @kernel(float addrspace(1)* nocapture %in, float addrspace(1)* nocapture %out) #0 {\n"
+			"  %1 = tail call spir_func i32 @_Z13get_global_idj(i32 0) #2\n"
+			"  %2 = getelementptr inbounds float, float addrspace(1)* %in, i32 %1\n"
+			"  %3 = load float, float addrspace(1)* %2, align 4, !tbaa !11\n"
+			"  %4 = fmul float %3, 0x3FF3333340000000\n"
+			"  store float %4, float addrspace(1)* %out, align 4, !tbaa !11 ; <label>:5\n"
+			"  ret void\n"
+			"}\n"
+			"@.str = private unnamed_addr constant [12 x i8] c\"some string\\00\", align 1\n";
+	std::string code;
+	while(code.size() < 4 * 1024 * 1024)
+		code.append(block);
+
+	const auto streamed = scanAll(code, false);
+	const auto buffered = scanAll(code, true);
+	TEST_ASSERT_EQUALS(streamed.second, buffered.second);
+	const auto toMBPerSecond = [&code](Clock::duration duration) -> unsigned
+	{
+		const auto micros = std::max(static_cast<int64_t>(1), static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+		return static_cast<unsigned>(static_cast<int64_t>(code.size()) / micros);
+	};
+	printf("Scanning %u KB (%u tokens): streamed %u ms (%u MB/s), buffered %u ms (%u MB/s)\n", static_cast<unsigned>(code.size() / 1024),
+			static_cast<unsigned>(streamed.second),
+			static_cast<unsigned>(std::chrono::duration_cast<std::chrono::milliseconds>(streamed.first).count()), toMBPerSecond(streamed.first),
+			static_cast<unsigned>(std::chrono::duration_cast<std::chrono::milliseconds>(buffered.first).count()), toMBPerSecond(buffered.first));
+}
+
+void TestBenchmarks::benchmarkBasicBlocks()
+{
+	//a method with many basic blocks, every second block ending with a conditional branch (and falling through to the next block)
+	static constexpr std::size_t NUM_BLOCKS = 800;
+	Configuration config;
+	Module module(config);
+	Method method(module);
+	std::vector<const Local*> labels;
+	labels.reserve(NUM_BLOCKS);
+	for(std::size_t i = 0; i < NUM_BLOCKS; ++i)
+		labels.push_back(method.findOrCreateLocal(TYPE_LABEL, std::string("%label") + std::to_string(i)));
+	const Value cond = method.addNewLocal(TYPE_BOOL, "%cond");
+	for(std::size_t i = 0; i < NUM_BLOCKS; ++i)
+	{
+		method.appendToEnd(new intermediate::BranchLabel(*labels[i]));
+		method.appendToEnd(new intermediate::MoveOperation(cond, BOOL_TRUE));
+		if(i % 2 == 0)
+			method.appendToEnd(new intermediate::Branch(labels[(i * 7 + 3) % NUM_BLOCKS], COND_ZERO_CLEAR, cond));
+		else
+			method.appendToEnd(new intermediate::Branch(labels[(i * 13 + 1) % NUM_BLOCKS], COND_ALWAYS, BOOL_TRUE));
+	}
+
+	const auto start = Clock::now();
+	std::size_t numPredecessors = 0;
+	std::size_t numSuccessors = 0;
+	for(std::size_t n = 0; n < NUM_ITERATIONS; ++n)
+	{
+		for(const Local* label : labels)
+		{
+			BasicBlock* block = method.findBasicBlock(label);
+			block->forPredecessors([&numPredecessors](InstructionWalker it) -> void { ++numPredecessors; });
+			block->forSuccessiveBlocks([&numSuccessors](BasicBlock& bb) -> void { ++numSuccessors; });
+		}
+	}
+	const auto duration = Clock::now() - start;
+	TEST_ASSERT_EQUALS(numPredecessors, numSuccessors);
+	printf("Querying predecessors and successors of %u blocks %u times: %u ms (%u edges)\n", static_cast<unsigned>(NUM_BLOCKS), static_cast<unsigned>(NUM_ITERATIONS),
+			static_cast<unsigned>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()), static_cast<unsigned>(numPredecessors / NUM_ITERATIONS));
+}
@@ -0,0 +1,31 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#ifndef TEST_BENCHMARKS_H
+#define TEST_BENCHMARKS_H
+
+#include "cpptest.h"
+
+/*
+ * Micro-benchmarks for performance-critical parts of the compiler.
+ *
+ * The benchmarks only print their timings and are not run by default
+ */
+class TestBenchmarks : public Test::Suite
+{
+public:
+	TestBenchmarks();
+	~TestBenchmarks() override;
+
+	void benchmarkValueHashing();
+	void benchmarkCompilation(std::string clFile, std::string options);
+	void benchmarkEmulation();
+	void benchmarkRegisterAllocation(std::string clFile, std::string options);
+	void benchmarkScanner();
+	void benchmarkBasicBlocks();
+};
+
+#endif /* TEST_BENCHMARKS_H */
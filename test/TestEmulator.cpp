@@ -11,9 +11,11 @@
 #include "asm/Instruction.h"
 #include "asm/KernelInfo.h"
 #include "helper.h"
+#include "tools/Emulator.h"
 
 #include "test_cases.h"
 
+#include <cmath>
 #include <cstring>
 #include <fstream>
 #include <sstream>
@@ -32,6 +34,11 @@ TestEmulator::TestEmulator()
 	//TODO requires v8muld
 	//TEST_ADD(TestEmulator::testSHA1);
 	TEST_ADD(TestEmulator::testSHA256);
+	TEST_ADD(TestEmulator::testParallelEmulation);
+	TEST_ADD(TestEmulator::testBatchEmulation);
+	TEST_ADD(TestEmulator::testMemorySnapshots);
+	TEST_ADD(TestEmulator::testRegisterSpilling);
+	TEST_ADD(TestEmulator::testScheduling);
 	for(std::size_t i = 0; i < vc4c::test::integerTests.size(); ++i)
 	{
 		TEST_ADD_TWO_ARGUMENTS(TestEmulator::testIntegerEmulations, i, vc4c::test::integerTests.at(i).first.kernelName);
@@ -149,9 +156,8 @@ void TestEmulator::testPrime()
 	}
 }
 
-void TestEmulator::testBarrier()
+static EmulationData createBarrierData(std::stringstream& buffer)
 {
-	std::stringstream buffer;
 	compileFile(buffer, "./testing/test_barrier.cl");
 
 	EmulationData data;
@@ -163,6 +169,13 @@ void TestEmulator::testBarrier()
 
 	//output parameter has size: 12 * sizes
 	data.parameter.emplace_back(0u, std::vector<uint32_t>(12  * data.calcNumWorkItems()));
+	return data;
+}
+
+void TestEmulator::testBarrier()
+{
+	std::stringstream buffer;
+	const EmulationData data = createBarrierData(buffer);
 
 	const auto result = emulate(data);
 	TEST_ASSERT(result.executionSuccessful);
@@ -356,6 +369,224 @@ void TestEmulator::testSHA256()
 	}
 }
 
+static bool compareParallelEmulation(std::stringstream& buffer, EmulationData data)
+{
+	buffer.clear();
+	buffer.seekg(0);
+	data.parallelQPUs = false;
+	const auto sequentialResult = emulate(data);
+
+	buffer.clear();
+	buffer.seekg(0);
+	data.parallelQPUs = true;
+	const auto parallelResult = emulate(data);
+
+	//the parallel emulation needs to produce exactly the same results as the sequential one, even if it times out
+	bool identical = sequentialResult.executionSuccessful == parallelResult.executionSuccessful;
+	identical = identical && sequentialResult.results.size() == parallelResult.results.size();
+	for(std::size_t i = 0; identical && i < sequentialResult.results.size(); ++i)
+	{
+		const auto& sequentialOut = sequentialResult.results[i].second;
+		const auto& parallelOut = parallelResult.results[i].second;
+		identical = sequentialOut.has_value() == parallelOut.has_value() && (!sequentialOut || sequentialOut.value() == parallelOut.value());
+	}
+	identical = identical && sequentialResult.instrumentation.size() == parallelResult.instrumentation.size();
+	for(std::size_t i = 0; identical && i < sequentialResult.instrumentation.size(); ++i)
+	{
+		identical = sequentialResult.instrumentation[i].numExecutions == parallelResult.instrumentation[i].numExecutions &&
+			sequentialResult.instrumentation[i].numStalls == parallelResult.instrumentation[i].numStalls &&
+			sequentialResult.instrumentation[i].numBranchTaken == parallelResult.instrumentation[i].numBranchTaken;
+	}
+	return identical;
+}
+
+void TestEmulator::testParallelEmulation()
+{
+	//synchronizes the QPUs via semaphores and accesses the VPM
+	std::stringstream barrierBuffer;
+	EmulationData barrierData = createBarrierData(barrierBuffer);
+	TEST_ASSERT(compareParallelEmulation(barrierBuffer, barrierData));
+	//aborts the QPUs in the middle of waiting for each other
+	barrierData.maxEmulationCycles = 500;
+	TEST_ASSERT(compareParallelEmulation(barrierBuffer, barrierData));
+
+	//reads UNIFORMs and writes the results via VPM DMA, without any further synchronization
+	std::stringstream workItemBuffer;
+	compileFile(workItemBuffer, "./testing/test_work_item.cl");
+	EmulationData workItemData;
+	workItemData.kernelName = "test_work_item";
+	workItemData.maxEmulationCycles = vc4c::test::maxExecutionCycles;
+	workItemData.module = std::make_pair("", &workItemBuffer);
+	workItemData.workGroup.localSizes = {12, 1, 1};
+	workItemData.workGroup.numGroups = {2, 1, 1};
+	workItemData.parameter.emplace_back(0, std::vector<uint32_t>(24 * workItemData.calcNumWorkItems()));
+	TEST_ASSERT(compareParallelEmulation(workItemBuffer, workItemData));
+}
+
+void TestEmulator::testBatchEmulation()
+{
+	std::stringstream buffer;
+	const EmulationData data = createBarrierData(buffer);
+
+	const auto singleResult = emulate(data);
+	TEST_ASSERT(singleResult.executionSuccessful);
+
+	buffer.clear();
+	buffer.seekg(0);
+	BatchEmulationData batch;
+	batch.module = data.module;
+	batch.runs = {data, data};
+	batch.splitWorkGroups = true;
+	const auto batchResult = emulate(batch);
+	TEST_ASSERT_EQUALS(2u, batchResult.results.size());
+	TEST_ASSERT_EQUALS(1u, batchResult.instrumentation.size());
+
+	//every run of the batch needs to produce exactly the same results as the single emulation
+	for(const auto& result : batchResult.results)
+	{
+		TEST_ASSERT(result.executionSuccessful);
+		TEST_ASSERT(singleResult.results.front().second.value() == result.results.front().second.value());
+	}
+}
+
+void TestEmulator::testMemorySnapshots()
+{
+	const std::size_t pageSize = Memory::WORDS_PER_PAGE * sizeof(uint32_t);
+	Memory base(Memory::WORDS_PER_PAGE * 3);
+	*base.getWordAddress(0) = 17;
+	*base.getWordAddress(pageSize) = 42;
+
+	Memory snapshot = base.snapshot();
+	const Memory& constBase = base;
+	const Memory& constSnapshot = snapshot;
+	TEST_ASSERT_EQUALS(constBase.getWordAddress(pageSize), constSnapshot.getWordAddress(pageSize));
+	//writing the last word of the first page and the first word of the second page copies only these pages
+	const std::vector<uint32_t> words = {1, 2};
+	snapshot.writeBytes(static_cast<MemoryAddress>(pageSize - sizeof(uint32_t)), words.data(), words.size() * sizeof(uint32_t));
+	TEST_ASSERT_EQUALS(17u, *constSnapshot.getWordAddress(0));
+	TEST_ASSERT_EQUALS(2u, *constSnapshot.getWordAddress(pageSize));
+	TEST_ASSERT_EQUALS(42u, *constBase.getWordAddress(pageSize));
+	TEST_ASSERT_EQUALS(constBase.getWordAddress(2 * pageSize), constSnapshot.getWordAddress(2 * pageSize));
+
+	//merging applies only the modified words
+	Memory merged = base.snapshot();
+	*merged.getWordAddress(0) = 23;
+	merged.mergeChanges(snapshot, base);
+	std::vector<uint32_t> result(3);
+	merged.readBytes(static_cast<MemoryAddress>(pageSize - sizeof(uint32_t)), result.data(), result.size() * sizeof(uint32_t));
+	TEST_ASSERT_EQUALS(23u, *merged.getWordAddress(0));
+	TEST_ASSERT_EQUALS(1u, result[0]);
+	TEST_ASSERT_EQUALS(2u, result[1]);
+	TEST_ASSERT_EQUALS(0u, result[2]);
+}
+
+void TestEmulator::testRegisterSpilling()
+{
+	const std::string fileName = "./testing/test_register_spilling.cl";
+	//the compilation only succeeds, if all remaining locals can be assigned to registers after spilling
+	std::stringstream assembler;
+	{
+		Configuration config;
+		config.outputMode = OutputMode::ASSEMBLER;
+		std::ifstream input(fileName);
+		Compiler::compile(input, assembler, config, "", fileName);
+	}
+	//the spilled locals are accessed in the VPM rows selected by the QPU number
+	std::size_t numSpillAccesses = 0;
+	std::string line;
+	while(std::getline(assembler, line))
+	{
+		if((line.find("vpr_setup") != std::string::npos || line.find("vpw_setup") != std::string::npos) && line.find("qpu_num") != std::string::npos)
+			++numSpillAccesses;
+	}
+	TEST_ASSERT(numSpillAccesses > 0);
+
+	std::stringstream buffer;
+	compileFile(buffer, fileName);
+
+	//80 vectors are kept live across the loop, which do not fit into the registers.
+	//With the fixed work-group size of 1, every spilled local occupies a single VPM row, so enough of them can be spilled
+	const uint32_t numValues = 80;
+	const uint32_t count = 2;
+	const std::vector<uint32_t> in = vc4c::test::toRange<uint32_t>(0, numValues * 16);
+
+	EmulationData data;
+	data.kernelName = "test_register_spilling";
+	data.maxEmulationCycles = vc4c::test::maxExecutionCycles;
+	data.module = std::make_pair("", &buffer);
+	data.workGroup.localSizes = {1, 1, 1};
+	data.workGroup.numGroups = {1, 1, 1};
+	data.parameter.push_back(vc4c::test::toParameter(in));
+	data.parameter.push_back(vc4c::test::toParameter(std::vector<uint32_t>(in.size())));
+	data.parameter.push_back(vc4c::test::toScalarParameter(count));
+
+	const auto result = emulate(data);
+	TEST_ASSERT(result.executionSuccessful);
+	TEST_ASSERT_EQUALS(data.parameter.size(), result.results.size());
+
+	//the values of the spilled locals need to survive the loop
+	std::vector<uint32_t> sum(16, 0);
+	for(uint32_t k = 0; k < count; ++k)
+	{
+		for(uint32_t i = 0; i < numValues; ++i)
+		{
+			for(uint32_t e = 0; e < 16; ++e)
+				sum[e] = sum[e] * 3 + in[i * 16 + e] + (i + 10);
+		}
+	}
+	const auto& out = *result.results.at(1).second;
+	for(uint32_t i = 0; i < numValues; ++i)
+	{
+		for(uint32_t e = 0; e < 16; ++e)
+			TEST_ASSERT_EQUALS((in[i * 16 + e] + (i + 10)) ^ sum[e], out[i * 16 + e]);
+	}
+}
+
+void TestEmulator::testScheduling()
+{
+	std::stringstream buffer;
+	compileFile(buffer, "./testing/test_scheduling.cl");
+
+	std::vector<float> in(32);
+	for(std::size_t i = 0; i < 16; ++i)
+	{
+		in[i] = 1.0f + static_cast<float>(i);
+		in[16 + i] = 8.0f - static_cast<float>(i) * 0.5f;
+	}
+
+	EmulationData data;
+	data.kernelName = "test_scheduling";
+	data.maxEmulationCycles = vc4c::test::maxExecutionCycles;
+	data.module = std::make_pair("", &buffer);
+	data.workGroup.localSizes = {1, 1, 1};
+	data.workGroup.numGroups = {1, 1, 1};
+	data.parameter.push_back(vc4c::test::toParameter(in));
+	data.parameter.push_back(vc4c::test::toParameter(std::vector<float>(32)));
+	data.parameter.push_back(vc4c::test::toParameter(std::vector<int32_t>(16)));
+
+	const auto result = emulate(data);
+	TEST_ASSERT(result.executionSuccessful);
+	TEST_ASSERT_EQUALS(data.parameter.size(), result.results.size());
+
+	//the SFU results are only read after their delay, even if the instructions in between are re-ordered and combined
+	const auto& out = *result.results.at(1).second;
+	const auto& diff = *result.results.at(2).second;
+	for(std::size_t i = 0; i < 16; ++i)
+	{
+		const float a = in[i];
+		const float b = in[16 + i];
+		const float sum = a * b + b;
+		const float first = bit_cast<uint32_t, float>(out.at(i));
+		const float second = bit_cast<uint32_t, float>(out.at(16 + i));
+		//the SFU calculates the native functions with reduced precision
+		TEST_ASSERT(std::abs(first - (1.0f / a + sum - a)) <= 0.001f * std::abs(1.0f / a + sum - a));
+		TEST_ASSERT(std::abs(second - std::exp2(b) * sum) <= 0.001f * std::abs(std::exp2(b) * sum));
+		const int32_t x = static_cast<int32_t>(a);
+		const int32_t y = static_cast<int32_t>(b);
+		TEST_ASSERT_EQUALS(x > y ? x - y : y - x, static_cast<int32_t>(diff.at(i)));
+	}
+}
+
 void TestEmulator::testIntegerEmulations(std::size_t index, std::string name)
 {
 	auto& data = vc4c::test::integerTests.at(index).first;
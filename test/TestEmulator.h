@@ -33,6 +33,11 @@ public:
 	void testWorkItem();
 	void testSHA1();
 	void testSHA256();
+	void testParallelEmulation();
+	void testBatchEmulation();
+	void testMemorySnapshots();
+	void testRegisterSpilling();
+	void testScheduling();
 	void testIntegerEmulations(std::size_t index, std::string name);
 	void testFloatEmulations(std::size_t index, std::string name);
 	void testMathFunction(std::size_t index, std::string name);
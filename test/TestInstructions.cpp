@@ -6,6 +6,7 @@
 
 #include "TestInstructions.h"
 
+#include "Locals.h"
 #include "Values.h"
 #include "asm/OpCodes.h"
 #include "Bitfield.h"
@@ -18,6 +19,7 @@ TestInstructions::TestInstructions()
 	TEST_ADD(TestInstructions::testConstantSaturations);
 	TEST_ADD(TestInstructions::testBitfields);
 	TEST_ADD(TestInstructions::testOpCodes);
+	TEST_ADD(TestInstructions::testValueHashes);
 }
 
 TestInstructions::~TestInstructions()
@@ -183,4 +185,30 @@ void TestInstructions::testOpCodes()
 	
 	TEST_ASSERT_EQUALS(INT_ZERO, OP_V8SUBS(INT_ONE, INT_ONE).value());
 	TEST_ASSERT_EQUALS(INT_ONE, OP_V8MAX(INT_ONE, INT_ZERO).value());
-}
\ No newline at end of file
+}
+
+void TestInstructions::testValueHashes()
+{
+	const hash<Value> hashValue;
+	Parameter loc("%loc", TYPE_INT32);
+	Parameter otherLoc("%other", TYPE_INT32);
+
+	//equal values need to have equal hashes
+	TEST_ASSERT_EQUALS(hashValue(INT_ONE), hashValue(Value(Literal(1u), TYPE_INT8)));
+	TEST_ASSERT_EQUALS(hashValue(loc.createReference()), hashValue(Value(&loc, TYPE_INT32)));
+	TEST_ASSERT_EQUALS(hashValue(UNIFORM_REGISTER), hashValue(Value(REG_UNIFORM, TYPE_INT32.toVectorType(16))));
+	TEST_ASSERT_EQUALS(hashValue(Value(SmallImmediate(3), TYPE_INT8)), hashValue(Value(SmallImmediate(3), TYPE_INT8)));
+	ContainerValue container;
+	container.elements.push_back(INT_ONE);
+	container.elements.push_back(INT_ZERO);
+	const Value vector(container, TYPE_INT32.toVectorType(2));
+	TEST_ASSERT_EQUALS(hashValue(vector), hashValue(Value(vector)));
+
+	//different values should have different hashes
+	TEST_ASSERT(hashValue(loc.createReference()) != hashValue(otherLoc.createReference()));
+	TEST_ASSERT(hashValue(INT_ONE) != hashValue(INT_ZERO));
+	TEST_ASSERT(hashValue(INT_ONE) != hashValue(Value(Literal(1u), TYPE_INT32)));
+	TEST_ASSERT(hashValue(Value(REG_ACC0, TYPE_INT32)) != hashValue(Value(REG_ACC1, TYPE_INT32)));
+	TEST_ASSERT(loc.createReference() != otherLoc.createReference());
+	TEST_ASSERT(INT_ONE != Value(Literal(1u), TYPE_INT32));
+}
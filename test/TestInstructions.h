@@ -19,6 +19,7 @@ public:
 	void testConstantSaturations();
 	void testBitfields();
 	void testOpCodes();
+	void testValueHashes();
 };
 
 #endif /* TEST_INSTRUCTIONS_H */
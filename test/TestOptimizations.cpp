@@ -0,0 +1,251 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#include "TestOptimizations.h"
+
+#include "CompilationError.h"
+#include "InstructionWalker.h"
+#include "Module.h"
+#include "asm/GraphColoring.h"
+#include "intermediate/IntermediateInstruction.h"
+#include "optimization/Optimizer.h"
+
+#include <vector>
+
+using namespace vc4c;
+using namespace vc4c::intermediate;
+
+TestOptimizations::TestOptimizations()
+{
+	TEST_ADD(TestOptimizations::testSingleStepsFixPoint);
+	TEST_ADD(TestOptimizations::testSpillLocals);
+	TEST_ADD(TestOptimizations::testSchedulingDelays);
+	TEST_ADD(TestOptimizations::testUndefinedLocals);
+}
+
+TestOptimizations::~TestOptimizations()
+{
+	//out-of-line virtual destructor
+}
+
+void TestOptimizations::testSingleStepsFixPoint()
+{
+	Configuration config;
+	Module module(config);
+	Method method(module);
+	method.metaData.workGroupSizes.fill(1);
+
+	const Local* start = method.findOrCreateLocal(TYPE_LABEL, "%start");
+	const Local* use = method.findOrCreateLocal(TYPE_LABEL, "%use");
+	const Local* def = method.findOrCreateLocal(TYPE_LABEL, "%def");
+	const Local* end = method.findOrCreateLocal(TYPE_LABEL, "%end");
+	const Value y = method.addNewLocal(TYPE_INT32, "%y");
+	const Value z = method.addNewLocal(TYPE_INT32, "%z");
+
+	//the use of %y is located before its definition, so it is visited first
+	method.appendToEnd(new BranchLabel(*start));
+	method.appendToEnd(new Branch(def, COND_ALWAYS, BOOL_TRUE));
+	method.appendToEnd(new BranchLabel(*use));
+	method.appendToEnd(new Operation(OP_AND, z, Value(REG_QPU_NUMBER, TYPE_INT32), y));
+	method.appendToEnd(new MoveOperation(NOP_REGISTER, z));
+	method.appendToEnd(new Branch(end, COND_ALWAYS, BOOL_TRUE));
+	method.appendToEnd(new BranchLabel(*def));
+	//for a work-group size of 1, the local ID is replaced in-place with the constant zero by the intrinsics,
+	//which only then allows to simplify "qpu_num & %y" to zero
+	method.appendToEnd(new MethodCall(y, "vc4cl_local_id", {INT_ZERO}));
+	method.appendToEnd(new Branch(use, COND_ALWAYS, BOOL_TRUE));
+	method.appendToEnd(new BranchLabel(*end));
+
+	optimizations::RUN_SINGLE_STEPS(module, method, config);
+
+	const LocalUser* writer = z.local->getSingleWriter();
+	TEST_ASSERT(writer != nullptr);
+	TEST_ASSERT(!writer->readsLocal(y.local));
+	TEST_ASSERT(writer->precalculate(1) && writer->precalculate(1)->hasLiteral(Literal(0u)));
+}
+
+void TestOptimizations::testSpillLocals()
+{
+	Configuration config;
+	Module module(config);
+	Method method(module);
+	//the method runs on a single QPU, so every spilled local requires a single row of the VPM
+	method.metaData.workGroupSizes.fill(1);
+
+	//all values are live at the same time, which is more than there are registers available
+	const std::size_t numValues = 80;
+	method.appendToEnd(new BranchLabel(*method.findOrCreateLocal(TYPE_LABEL, "%start")));
+	std::vector<Value> values;
+	for(std::size_t i = 0; i < numValues; ++i)
+	{
+		values.push_back(method.addNewLocal(TYPE_INT32, "%value"));
+		method.appendToEnd(new MoveOperation(values.back(), Value(Literal(static_cast<uint32_t>(i)), TYPE_INT32)));
+	}
+	Value sum = INT_ZERO;
+	for(const Value& val : values)
+	{
+		const Value next = method.addNewLocal(TYPE_INT32, "%sum");
+		method.appendToEnd(new Operation(OP_ADD, next, sum, val));
+		sum = next;
+	}
+	method.appendToEnd(new MoveOperation(NOP_REGISTER, sum));
+
+	optimizations::SPILL_LOCALS(module, method, config);
+
+	std::size_t numStores = 0;
+	std::size_t numLoads = 0;
+	method.forAllInstructions([&numStores, &numLoads](const IntermediateInstruction* inst) -> void
+	{
+		if(inst->writesRegister(REG_VPM_OUT_SETUP))
+			++numStores;
+		if(inst->writesRegister(REG_VPM_IN_SETUP))
+			++numLoads;
+	});
+	//enough locals are spilled to reduce the register pressure to the available registers, every spilled local is written and read once
+	TEST_ASSERT(numStores >= numValues - 60);
+	TEST_ASSERT_EQUALS(numStores, numLoads);
+
+	//the spilled locals are not accessed anymore, all accesses are replaced with temporaries
+	std::size_t numUnusedValues = 0;
+	for(const Value& val : values)
+	{
+		if(val.local->getUsers().empty())
+			++numUnusedValues;
+	}
+	TEST_ASSERT_EQUALS(numStores, numUnusedValues);
+
+	//the remaining locals and the temporaries introduced by the spilling can be assigned to registers
+	qpu_asm::GraphColoring coloring(method, method.walkAllInstructions());
+	std::size_t round = 0;
+	while(round < REGISTER_RESOLVER_MAX_ROUNDS && !coloring.colorGraph())
+	{
+		if(coloring.fixErrors())
+			break;
+		++round;
+	}
+	TEST_ASSERT(round < REGISTER_RESOLVER_MAX_ROUNDS);
+	TEST_ASSERT(!coloring.toRegisterMap().empty());
+}
+
+void TestOptimizations::testSchedulingDelays()
+{
+	Configuration config;
+	Module module(config);
+	Method method(module);
+
+	const Value a = method.addNewLocal(TYPE_FLOAT, "%a");
+	const Value b = method.addNewLocal(TYPE_INT32, "%b");
+	const Value recip = method.addNewLocal(TYPE_FLOAT, "%recip");
+	const Value cond = method.addNewLocal(TYPE_INT32, "%cond");
+	const Value select = method.addNewLocal(TYPE_INT32, "%select");
+	method.appendToEnd(new BranchLabel(*method.findOrCreateLocal(TYPE_LABEL, "%start")));
+	//the delay of the SFU result is initially filled with nops, followed by independent instructions which can be combined
+	IntermediateInstruction* sfuWrite = new MoveOperation(Value(REG_SFU_RECIP, TYPE_FLOAT), a);
+	method.appendToEnd(sfuWrite);
+	method.appendToEnd(new Nop(DelayType::WAIT_SFU));
+	method.appendToEnd(new Nop(DelayType::WAIT_SFU));
+	IntermediateInstruction* sfuRead = new MoveOperation(recip, Value(REG_SFU_OUT, TYPE_FLOAT));
+	method.appendToEnd(sfuRead);
+	std::vector<Value> values;
+	for(uint32_t i = 0; i < 4; ++i)
+	{
+		values.push_back(method.addNewLocal(TYPE_INT32, "%value"));
+		method.appendToEnd(new Operation(i % 2 == 0 ? OP_ADD : OP_MUL24, values.back(), b, Value(Literal(i + 1), TYPE_INT32)));
+	}
+	//the conditional move needs to stay after the instruction setting the flags
+	IntermediateInstruction* flagsWrite = new Operation(OP_XOR, cond, b, INT_ONE, COND_ALWAYS, SetFlag::SET_FLAGS);
+	method.appendToEnd(flagsWrite);
+	IntermediateInstruction* flagsRead = new MoveOperation(select, INT_ONE, COND_ZERO_SET);
+	method.appendToEnd(flagsRead);
+	method.appendToEnd(new MoveOperation(NOP_REGISTER, recip));
+	method.appendToEnd(new MoveOperation(NOP_REGISTER, select));
+	for(const Value& val : values)
+		method.appendToEnd(new MoveOperation(NOP_REGISTER, val));
+
+	optimizations::REORDER(module, method, config);
+
+	//the scheduler does not prevent the instructions from being combined
+	bool allCombinable = true;
+	method.forAllInstructions([&allCombinable](const IntermediateInstruction* inst) -> void
+	{
+		if(dynamic_cast<const Nop*>(inst) == nullptr)
+			allCombinable = allCombinable && inst->canBeCombined;
+	});
+	TEST_ASSERT(allCombinable);
+
+	optimizations::COMBINE(module, method, config);
+
+	//even if all instructions in between are combined, the SFU result is read only after its delay
+	std::vector<const IntermediateInstruction*> instructions;
+	method.forAllInstructions([&instructions](const IntermediateInstruction* inst) -> void
+	{
+		if(inst->mapsToASMInstruction())
+			instructions.push_back(inst);
+	});
+	const auto findPosition = [&instructions](const IntermediateInstruction* inst) -> std::size_t
+	{
+		for(std::size_t i = 0; i < instructions.size(); ++i)
+		{
+			const CombinedOperation* combined = dynamic_cast<const CombinedOperation*>(instructions[i]);
+			if(instructions[i] == inst || (combined != nullptr && (combined->op1.get() == inst || combined->op2.get() == inst)))
+				return i;
+		}
+		return instructions.size();
+	};
+	const std::size_t sfuWritePosition = findPosition(sfuWrite);
+	const std::size_t sfuReadPosition = findPosition(sfuRead);
+	TEST_ASSERT(sfuReadPosition < instructions.size());
+	TEST_ASSERT(sfuWritePosition + 2 < sfuReadPosition);
+	TEST_ASSERT(findPosition(flagsWrite) < findPosition(flagsRead));
+	TEST_ASSERT(findPosition(flagsRead) < instructions.size());
+}
+
+void TestOptimizations::testUndefinedLocals()
+{
+	Configuration config;
+	Module module(config);
+
+	//%x is only written on one of the paths leading to its use
+	Method undefined(module);
+	const Local* start = undefined.findOrCreateLocal(TYPE_LABEL, "%start");
+	const Local* def = undefined.findOrCreateLocal(TYPE_LABEL, "%def");
+	const Local* use = undefined.findOrCreateLocal(TYPE_LABEL, "%use");
+	const Value cond = undefined.addNewLocal(TYPE_INT32, "%cond");
+	const Value x = undefined.addNewLocal(TYPE_INT32, "%x");
+	undefined.appendToEnd(new BranchLabel(*start));
+	undefined.appendToEnd(new MoveOperation(cond, Value(REG_QPU_NUMBER, TYPE_INT32)));
+	undefined.appendToEnd(new Branch(use, COND_ZERO_SET, cond));
+	undefined.appendToEnd(new BranchLabel(*def));
+	undefined.appendToEnd(new MoveOperation(x, INT_ONE));
+	undefined.appendToEnd(new BranchLabel(*use));
+	undefined.appendToEnd(new Operation(OP_ADD, NOP_REGISTER, x, INT_ONE));
+
+	bool errorThrown = false;
+	try
+	{
+		qpu_asm::GraphColoring coloring(undefined, undefined.walkAllInstructions());
+		coloring.colorGraph();
+	}
+	catch(const CompilationError&)
+	{
+		errorThrown = true;
+	}
+	TEST_ASSERT(errorThrown);
+
+	//parameters are written before the kernel starts and a conditional write intentionally leaves the other elements undefined
+	Method defined(module);
+	defined.parameters.emplace_back(Parameter("%param", TYPE_INT32));
+	const Value param(&defined.parameters.back(), TYPE_INT32);
+	const Value flags = defined.addNewLocal(TYPE_INT32, "%flags");
+	const Value select = defined.addNewLocal(TYPE_INT32, "%select");
+	defined.appendToEnd(new BranchLabel(*defined.findOrCreateLocal(TYPE_LABEL, "%start")));
+	defined.appendToEnd(new Operation(OP_XOR, flags, param, INT_ONE, COND_ALWAYS, SetFlag::SET_FLAGS));
+	defined.appendToEnd(new MoveOperation(select, param, COND_ZERO_SET));
+	defined.appendToEnd(new Operation(OP_ADD, NOP_REGISTER, select, flags, COND_ZERO_SET));
+
+	qpu_asm::GraphColoring coloring(defined, defined.walkAllInstructions());
+	TEST_ASSERT(coloring.colorGraph());
+}
@@ -0,0 +1,27 @@
+/*
+ * Author: doe300
+ *
+ * See the file "LICENSE" for the full license governing this code.
+ */
+
+#ifndef TEST_OPTIMIZATIONS_H
+#define TEST_OPTIMIZATIONS_H
+
+#include "cpptest.h"
+
+/*
+ * Tests single optimizations on manually constructed methods
+ */
+class TestOptimizations : public Test::Suite
+{
+public:
+	TestOptimizations();
+	~TestOptimizations() override;
+
+	void testSingleStepsFixPoint();
+	void testSpillLocals();
+	void testSchedulingDelays();
+	void testUndefinedLocals();
+};
+
+#endif /* TEST_OPTIMIZATIONS_H */
@@ -7,8 +7,11 @@
 #include "TestParser.h"
 #include "../lib/cpplog/include/log.h"
 #include "../lib/cpplog/include/logger.h"
+#include "Module.h"
+#include "intermediate/IntermediateInstruction.h"
 
 #include <fstream>
+#include <sstream>
 
 using namespace vc4c;
 
@@ -21,6 +24,7 @@ TestParser::TestParser() : parser1(source1), parser2(source2)
     TEST_ADD(TestParser::testGlobalData);
     TEST_ADD(TestParser::testStructDefinition);
     TEST_ADD(TestParser::testUnionDefinition);
+    TEST_ADD(TestParser::testParallelFrontend);
 }
 
 bool TestParser::setup()
@@ -73,3 +77,35 @@ void TestParser::testUnionDefinition()
 {
 
 }
+
+static std::string parseLLVMIR(const std::string& fileName, const bool parallelFrontend)
+{
+    Configuration config;
+    config.parallelFrontend = parallelFrontend;
+    Module module(config);
+    std::ifstream input(fileName);
+    llvm2qasm::IRParser parser(input);
+    parser.parse(module);
+
+    std::stringstream output;
+    for(const auto& method : module)
+    {
+        output << method->name << '\n';
+        method->forAllInstructions([&output](const intermediate::IntermediateInstruction* inst) -> void
+        {
+            output << inst->to_string() << '\n';
+        });
+    }
+    return output.str();
+}
+
+void TestParser::testParallelFrontend()
+{
+    //mapping the methods in parallel must not change the front-end output
+    for(const std::string file : {"./example/fibonacci.ir", "./example/hello_world.ir", "./example/hello_world_vector.ir"})
+    {
+        const std::string serialOutput = parseLLVMIR(file, false);
+        TEST_ASSERT(!serialOutput.empty());
+        TEST_ASSERT_EQUALS(serialOutput, parseLLVMIR(file, true));
+    }
+}
@@ -21,6 +21,7 @@ public:
     void testGlobalData();
     void testStructDefinition();
     void testUnionDefinition();
+    void testParallelFrontend();
     
 private:
     vc4c::llvm2qasm::IRParser parser1;
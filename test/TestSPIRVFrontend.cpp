@@ -6,7 +6,13 @@
 
 #include "TestSPIRVFrontend.h"
 
+#include "Module.h"
+#include "intermediate/IntermediateInstruction.h"
 #include "spirv/SPIRVHelper.h"
+#include "spirv/SPIRVParser.h"
+
+#include <fstream>
+#include <sstream>
 #ifdef SPIRV_HEADER
 #include SPIRV_PARSER_HEADER
 
@@ -16,6 +22,7 @@ using namespace vc4c::spirv2qasm;
 TestSPIRVFrontend::TestSPIRVFrontend()
 {
 	TEST_ADD(TestSPIRVFrontend::testCapabilitiesSupport);
+	TEST_ADD(TestSPIRVFrontend::testParallelFrontend);
 }
 
 TestSPIRVFrontend::~TestSPIRVFrontend()
@@ -44,3 +51,33 @@ void TestSPIRVFrontend::testCapabilitiesSupport()
 	TEST_ASSERT_EQUALS(SPV_SUCCESS, checkCapability(SpvCapability::SpvCapabilityVector16));
 #endif
 }
+
+void TestSPIRVFrontend::testParallelFrontend()
+{
+#ifdef SPIRV_HEADER
+	//mapping the methods in parallel must not change the front-end output
+	std::string outputs[2];
+	for(const bool parallelFrontend : {false, true})
+	{
+		vc4c::Configuration config;
+		config.parallelFrontend = parallelFrontend;
+		vc4c::Module module(config);
+		std::ifstream input("./example/fibonacci.spt");
+		SPIRVParser parser(input, true);
+		parser.parse(module);
+
+		std::stringstream output;
+		for(const auto& method : module)
+		{
+			output << method->name << '\n';
+			method->forAllInstructions([&output](const vc4c::intermediate::IntermediateInstruction* inst) -> void
+			{
+				output << inst->to_string() << '\n';
+			});
+		}
+		outputs[parallelFrontend] = output.str();
+	}
+	TEST_ASSERT(!outputs[0].empty());
+	TEST_ASSERT_EQUALS(outputs[0], outputs[1]);
+#endif
+}
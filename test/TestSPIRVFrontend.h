@@ -16,6 +16,7 @@ public:
 	~TestSPIRVFrontend() override;
 
 	void testCapabilitiesSupport();
+	void testParallelFrontend();
 };
 
 #endif /* TEST_SPIRVFRONTEND_H */
@@ -18,6 +18,7 @@ TestScanner::TestScanner()
     TEST_ADD(TestScanner::testFloat);
     TEST_ADD(TestScanner::testString);
     TEST_ADD(TestScanner::testBool);
+    TEST_ADD(TestScanner::testBufferedInput);
 }
 
 TestScanner::~TestScanner()
@@ -107,3 +108,39 @@ void TestScanner::testBool()
     TEST_ASSERT_EQUALS(TokenType::BOOLEAN, s.peek().type);
     TEST_ASSERT_EQUALS(false, s.pop().flag);
 }
+
+void TestScanner::testBufferedInput()
+{
+    std::stringstream stream;
+    stream << "%call = tail call spir_func i32 @foo(i32 -17, float 1.5) #2 ; <label>:4\n"
+    		"store i8 %val, i8* getelementptr inbounds ([5 x i8], [5 x i8]* @.str, i32 0, i32 0), align 1\n"
+    		"@.str = private unnamed_addr constant [5 x i8] c\"abcd\\00\", align 1";
+    //the same input needs to produce the same tokens, whether read from the stream or from the buffered input
+    std::stringstream copy(stream.str());
+    Scanner streamed(stream);
+    Scanner buffered(copy, true);
+
+    std::size_t numTokens = 0;
+    while(streamed.hasInput())
+    {
+    	TEST_ASSERT(buffered.hasInput());
+    	const Token expected = streamed.pop();
+    	const Token token = buffered.pop();
+    	TEST_ASSERT_EQUALS(expected.type, token.type);
+    	TEST_ASSERT_EQUALS(expected.to_string(), token.to_string());
+    	++numTokens;
+    }
+    TEST_ASSERT(!buffered.hasInput());
+    TEST_ASSERT(numTokens > 40);
+
+    std::stringstream input("@global = c\"text\" true");
+    Scanner s(input, true);
+    //the tokens need to stay valid after more tokens are read
+    const Token name = s.pop();
+    s.pop();
+    const Token text = s.pop();
+    TEST_ASSERT_EQUALS(TokenType::BOOLEAN, s.pop().type);
+    TEST_ASSERT(name.hasValue("@global"));
+    TEST_ASSERT(text.hasValue("c\"text\""));
+    TEST_ASSERT(s.createToken("%0").hasValue("%0"));
+}
@@ -21,6 +21,7 @@ public:
     void testFloat();
     void testString();
     void testBool();
+    void testBufferedInput();
 private:
 
 };
@@ -9,9 +9,11 @@
 
 #include "cpptest.h"
 #include "cpptest-main.h"
+#include "TestBenchmarks.h"
 #include "TestEmulator.h"
 #include "TestInstructions.h"
 #include "TestOperators.h"
+#include "TestOptimizations.h"
 #include "TestParser.h"
 #include "TestScanner.h"
 #include "TestSPIRVFrontend.h"
@@ -57,6 +59,7 @@ int main(int argc, char** argv)
     Test::registerSuite(Test::newInstance<TestParser>, "test-parser", "Tests the LLVM IR parser");
     Test::registerSuite(Test::newInstance<TestInstructions>, "test-instructions", "Tests some common instruction handling");
     Test::registerSuite(Test::newInstance<TestSPIRVFrontend>, "test-spirv", "Tests the SPIR-V front-end");
+    Test::registerSuite(Test::newInstance<TestOptimizations>, "test-optimizations", "Tests single optimizations on manually constructed methods");
     Test::registerSuite(newLLVMCompilationTest<true>, "regressions-llvm", "Runs the regression-test using the LLVM-IR front-end", false);
     Test::registerSuite(newSPIRVCompiltionTest<true>, "regressions-spirv", "Runs the regression-test using the SPIR-V front-end", false);
     Test::registerSuite(newCompilationTest<true>, "regressions", "Runs the regression-test using the default front-end", false);
@@ -65,6 +68,7 @@ int main(int argc, char** argv)
     Test::registerSuite(newSPIRVCompiltionTest<false>, "test-compilation-spirv", "Runs all the compilation tests using the SPIR-V front-end", false);
     Test::registerSuite(newFastRegressionTest, "fast-regressions", "Runs regression test-cases marked as fast", false);
     Test::registerSuite(Test::newInstance<TestEmulator>, "test-emulator", "Runs selected code-samples through the emulator");
+    Test::registerSuite(Test::newInstance<TestBenchmarks>, "benchmarks", "Runs micro-benchmarks and measures the compilation time of large kernels", false);
 
     return Test::runSuites(argc, argv);
 }
@@ -0,0 +1,24 @@
+/*
+ * Keeps more vectors live across a loop than there are registers, so some of them need to be spilled.
+ * The fixed work-group size of 1 requires only a single copy of every spilled vector in the VPM.
+ */
+//the indices of the values are 10 to 89, to not have any octal literals
+#define FOR_10(M, n) M(n##0) M(n##1) M(n##2) M(n##3) M(n##4) M(n##5) M(n##6) M(n##7) M(n##8) M(n##9)
+#define FOR_ALL(M) FOR_10(M, 1) FOR_10(M, 2) FOR_10(M, 3) FOR_10(M, 4) FOR_10(M, 5) FOR_10(M, 6) FOR_10(M, 7) FOR_10(M, 8)
+
+#define READ(i) const uint16 v##i = vload16(i - 10, in) + (uint16)(i);
+#define ACCUMULATE(i) sum = sum * 3 + v##i;
+#define WRITE(i) vstore16(v##i ^ sum, i - 10, out);
+
+__kernel __attribute__((reqd_work_group_size(1, 1, 1))) void test_register_spilling(__global const uint* in, __global uint* out, const uint count)
+{
+	FOR_ALL(READ)
+
+	uint16 sum = 0;
+	for(uint k = 0; k < count; ++k)
+	{
+		FOR_ALL(ACCUMULATE)
+	}
+
+	FOR_ALL(WRITE)
+}
@@ -0,0 +1,22 @@
+/*
+ * Mixes SFU calculations, memory accesses and conditional execution with independent arithmetic,
+ * so the instruction scheduler moves instructions into the delays of the SFU results and between setting and using the flags
+ */
+__kernel void test_scheduling(__global const float16* in, __global float16* out, __global int16* diff)
+{
+	const float16 a = in[0];
+	const float16 b = in[1];
+
+	//the independent arithmetic can be executed while waiting for the SFU results
+	const float16 recip = native_recip(a);
+	const float16 sum = a * b + b;
+	const float16 exp = native_exp2(b);
+	const float16 prod = sum - a;
+	out[0] = recip + prod;
+	out[1] = exp * sum;
+
+	//the selection depends on the flags set by the comparison
+	const int16 x = convert_int16(a);
+	const int16 y = convert_int16(b);
+	diff[0] = x > y ? x - y : y - x;
+}